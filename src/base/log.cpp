@@ -4,8 +4,10 @@
 #include "system.h"
 
 #include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <memory>
+#include <thread>
 
 #if defined(CONF_FAMILY_WINDOWS)
 #include <fcntl.h>
@@ -550,6 +552,234 @@ void CFutureLogger::OnFilterChange()
 	}
 }
 
+thread_local bool in_threaded_logger_thread = false;
+
+class CThreadedLogger::CQueue
+{
+public:
+	enum
+	{
+		SIZE = 256,
+	};
+
+	struct CSlot
+	{
+		std::atomic<uint64_t> m_Sequence;
+		CLogMessage m_Message;
+	};
+
+	// bounded multi-producer queue, see
+	// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	CSlot m_aSlots[SIZE];
+	std::atomic<uint64_t> m_EnqueuePos{0};
+	// only accessed by the thread that passes on the messages
+	uint64_t m_DequeuePos = 0;
+	// the logger thread confirms flush requests after passing on everything
+	// that was queued when it saw them, including the dropped messages note
+	std::atomic<uint64_t> m_FlushRequests{0};
+	std::atomic<uint64_t> m_FlushesDone{0};
+
+	std::atomic<int64_t> m_PendingDropped{0};
+	std::atomic<int64_t> m_TotalDropped{0};
+
+	std::atomic<bool> m_Async{false};
+	std::atomic<bool> m_Stop{false};
+	std::atomic<bool> m_Finished{false};
+	SEMAPHORE m_Semaphore;
+	void *m_pThread = nullptr;
+
+	CQueue()
+	{
+		for(uint64_t i = 0; i < SIZE; i++)
+			m_aSlots[i].m_Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bool Push(const CLogMessage *pMessage)
+	{
+		uint64_t Pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		CSlot *pSlot;
+		while(true)
+		{
+			pSlot = &m_aSlots[Pos % SIZE];
+			const int64_t Diff = (int64_t)pSlot->m_Sequence.load(std::memory_order_acquire) - (int64_t)Pos;
+			if(Diff == 0)
+			{
+				if(m_EnqueuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if(Diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Pos = m_EnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		// only copy the used part of the line
+		CLogMessage &Message = pSlot->m_Message;
+		Message.m_Level = pMessage->m_Level;
+		Message.m_HaveColor = pMessage->m_HaveColor;
+		Message.m_Color = pMessage->m_Color;
+		str_copy(Message.m_aTimestamp, pMessage->m_aTimestamp);
+		str_copy(Message.m_aSystem, pMessage->m_aSystem);
+		mem_copy(Message.m_aLine, pMessage->m_aLine, pMessage->m_LineLength + 1);
+		Message.m_TimestampLength = pMessage->m_TimestampLength;
+		Message.m_SystemLength = pMessage->m_SystemLength;
+		Message.m_LineLength = pMessage->m_LineLength;
+		Message.m_LineMessageOffset = pMessage->m_LineMessageOffset;
+
+		pSlot->m_Sequence.store(Pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// must only be called by one thread at a time
+	void PassOn(ILogger *pLogger)
+	{
+		while(true)
+		{
+			CSlot *pSlot = &m_aSlots[m_DequeuePos % SIZE];
+			if(pSlot->m_Sequence.load(std::memory_order_acquire) != m_DequeuePos + 1)
+				break;
+			pLogger->Log(&pSlot->m_Message);
+			pSlot->m_Sequence.store(m_DequeuePos + SIZE, std::memory_order_release);
+			m_DequeuePos++;
+		}
+
+		const int64_t Dropped = m_PendingDropped.exchange(0, std::memory_order_relaxed);
+		if(Dropped > 0)
+		{
+			CLogMessage Msg;
+			Msg.m_Level = LEVEL_WARN;
+			Msg.m_HaveColor = false;
+			Msg.m_Color = LOG_COLOR{0, 0, 0};
+			str_timestamp_format(Msg.m_aTimestamp, sizeof(Msg.m_aTimestamp), FORMAT_SPACE);
+			Msg.m_TimestampLength = str_length(Msg.m_aTimestamp);
+			str_copy(Msg.m_aSystem, "logger");
+			Msg.m_SystemLength = str_length(Msg.m_aSystem);
+			str_format(Msg.m_aLine, sizeof(Msg.m_aLine), "%s W %s: ", Msg.m_aTimestamp, Msg.m_aSystem);
+			Msg.m_LineMessageOffset = str_length(Msg.m_aLine);
+			str_format(Msg.m_aLine + Msg.m_LineMessageOffset, sizeof(Msg.m_aLine) - Msg.m_LineMessageOffset,
+				"dropped %" PRId64 " log messages because the log output was too slow (%" PRId64 " in total)",
+				Dropped, m_TotalDropped.load(std::memory_order_relaxed));
+			Msg.m_LineLength = str_length(Msg.m_aLine);
+			pLogger->Log(&Msg);
+		}
+	}
+};
+
+void CThreadedLogger::ThreadFunc(void *pUser)
+{
+	CThreadedLogger *pThis = static_cast<CThreadedLogger *>(pUser);
+	CQueue &Queue = *pThis->m_pQueue;
+	in_threaded_logger_thread = true;
+	while(!Queue.m_Stop.load(std::memory_order_acquire))
+	{
+		sphore_wait(&Queue.m_Semaphore);
+		const uint64_t FlushRequests = Queue.m_FlushRequests.load(std::memory_order_acquire);
+		Queue.PassOn(pThis->m_pLogger.get());
+		Queue.m_FlushesDone.store(FlushRequests, std::memory_order_release);
+	}
+	Queue.PassOn(pThis->m_pLogger.get());
+}
+
+CThreadedLogger::CThreadedLogger(std::shared_ptr<ILogger> pLogger) :
+	m_pLogger(std::move(pLogger)),
+	m_pQueue(std::make_unique<CQueue>())
+{
+	m_Filter.m_MaxLevel.store(LEVEL_TRACE, std::memory_order_relaxed);
+	sphore_init(&m_pQueue->m_Semaphore);
+}
+
+CThreadedLogger::~CThreadedLogger()
+{
+	m_pQueue->m_Finished.store(true, std::memory_order_release);
+	StopThread();
+	sphore_destroy(&m_pQueue->m_Semaphore);
+}
+
+void CThreadedLogger::StopThread()
+{
+	// write out everything that was logged so far, also when called from
+	// the logger thread itself, e.g. because of a failed assertion
+	CQueue &Queue = *m_pQueue;
+	if(in_threaded_logger_thread)
+	{
+		Queue.PassOn(m_pLogger.get());
+	}
+	else if(Queue.m_pThread)
+	{
+		Queue.m_Stop.store(true, std::memory_order_release);
+		sphore_signal(&Queue.m_Semaphore);
+		thread_wait(Queue.m_pThread);
+		Queue.m_pThread = nullptr;
+	}
+}
+
+void CThreadedLogger::SetAsync(bool Async)
+{
+	if(m_pQueue->m_Finished.load(std::memory_order_acquire))
+		return;
+	if(Async && !m_pQueue->m_pThread)
+		m_pQueue->m_pThread = thread_init(ThreadFunc, this, "logger");
+	m_pQueue->m_Async.store(Async, std::memory_order_release);
+	if(!Async)
+		Flush();
+}
+
+void CThreadedLogger::Flush()
+{
+	CQueue &Queue = *m_pQueue;
+	if(!Queue.m_pThread || in_threaded_logger_thread)
+		return;
+	const uint64_t Request = Queue.m_FlushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+	sphore_signal(&Queue.m_Semaphore);
+	while(Queue.m_FlushesDone.load(std::memory_order_acquire) < Request && !Queue.m_Stop.load(std::memory_order_acquire))
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+int64_t CThreadedLogger::NumDropped() const
+{
+	return m_pQueue->m_TotalDropped.load(std::memory_order_relaxed);
+}
+
+void CThreadedLogger::Log(const CLogMessage *pMessage)
+{
+	if(m_Filter.Filters(pMessage))
+	{
+		return;
+	}
+	CQueue &Queue = *m_pQueue;
+	if(!Queue.m_Async.load(std::memory_order_acquire) || Queue.m_Finished.load(std::memory_order_acquire) || in_threaded_logger_thread)
+	{
+		m_pLogger->Log(pMessage);
+		return;
+	}
+	if(!Queue.Push(pMessage))
+	{
+		Queue.m_PendingDropped.fetch_add(1, std::memory_order_relaxed);
+		Queue.m_TotalDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+	sphore_signal(&Queue.m_Semaphore);
+}
+
+void CThreadedLogger::GlobalFinish()
+{
+	if(m_pQueue->m_Finished.exchange(true, std::memory_order_acq_rel))
+		return;
+	StopThread();
+	m_pLogger->GlobalFinish();
+}
+
+void CThreadedLogger::OnFilterChange()
+{
+	// the filter only keeps messages out of the queue, the wrapped loggers
+	// keep their own filters
+}
+
 void CMemoryLogger::Log(const CLogMessage *pMessage)
 {
 	if(m_pParentLogger)
@@ -248,6 +248,50 @@ public:
 	void OnFilterChange() override;
 };
 
+/**
+ * @ingroup Log
+ *
+ * Logger that passes the messages on to another logger from a separate
+ * thread, so that threads that log don't wait for slow outputs.
+ *
+ * Messages are copied into a fixed size lock-free queue. If the queue is
+ * full, messages are dropped and counted. The number of dropped messages is
+ * logged as soon as there is space again. Messages are passed on directly
+ * until `SetAsync(true)` is called.
+ *
+ * The filter of this logger is not passed on. It drops messages before they
+ * are queued, so it should be set to the highest level of the wrapped
+ * loggers. It passes on everything by default.
+ */
+class CThreadedLogger : public ILogger
+{
+	class CQueue;
+
+	std::shared_ptr<ILogger> m_pLogger;
+	std::unique_ptr<CQueue> m_pQueue;
+
+	static void ThreadFunc(void *pUser);
+	void StopThread();
+
+public:
+	CThreadedLogger(std::shared_ptr<ILogger> pLogger);
+	~CThreadedLogger() override;
+
+	void SetAsync(bool Async);
+	/**
+	 * Waits until all queued messages have been passed on.
+	 */
+	void Flush();
+	/**
+	 * Total number of messages dropped because the queue was full.
+	 */
+	int64_t NumDropped() const;
+
+	void Log(const CLogMessage *pMessage) override;
+	void GlobalFinish() override;
+	void OnFilterChange() override;
+};
+
 /**
  * @ingroup Log
  *
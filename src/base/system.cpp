@@ -496,6 +496,9 @@ struct ASYNCIO
 	SEMAPHORE sphore;
 	void *thread;
 
+	ASYNCIO_FILTER filter;
+	void *filter_user;
+
 	unsigned char *buffer;
 	unsigned int buffer_size;
 	unsigned int read_pos;
@@ -569,6 +572,12 @@ static void aio_thread(void *user)
 		{
 			if(aio->finish != ASYNCIO_RUNNING)
 			{
+				if(aio->filter)
+				{
+					aio->filter(nullptr, 0, true, aio->io, aio->filter_user);
+					io_flush(aio->io);
+					aio->error = io_error(aio->io);
+				}
 				if(aio->finish == ASYNCIO_CLOSE)
 				{
 					io_close(aio->io);
@@ -602,9 +611,14 @@ static void aio_thread(void *user)
 			}
 		}
 		aio->read_pos = (aio->read_pos + buffers.len1 + buffers.len2) % aio->buffer_size;
+		const ASYNCIO_FILTER filter = aio->filter;
+		void *filter_user = aio->filter_user;
 		aio->lock.unlock();
 
-		io_write(aio->io, local_buffer, local_buffer_len);
+		if(filter)
+			filter(local_buffer, local_buffer_len, false, aio->io, filter_user);
+		else
+			io_write(aio->io, local_buffer, local_buffer_len);
 		io_flush(aio->io);
 		result_io_error = io_error(aio->io);
 
@@ -623,6 +637,8 @@ ASYNCIO *aio_new(IOHANDLE io)
 	aio->io = io;
 	sphore_init(&aio->sphore);
 	aio->thread = 0;
+	aio->filter = nullptr;
+	aio->filter_user = nullptr;
 
 	aio->buffer = (unsigned char *)malloc(ASYNC_BUFSIZE);
 	if(!aio->buffer)
@@ -670,6 +686,13 @@ static unsigned int next_buffer_size(unsigned int cur_size, unsigned int need_si
 	return cur_size;
 }
 
+void aio_set_filter(ASYNCIO *aio, ASYNCIO_FILTER filter, void *user)
+{
+	CLockScope ls(aio->lock);
+	aio->filter = filter;
+	aio->filter_user = user;
+}
+
 void aio_lock(ASYNCIO *aio) ACQUIRE(aio->lock)
 {
 	aio->lock.lock();
@@ -502,6 +502,33 @@ typedef struct ASYNCIO ASYNCIO;
  */
 ASYNCIO *aio_new(IOHANDLE io);
 
+/**
+ * Transforms the data of an `ASYNCIO` on its thread, e.g. compresses it.
+ *
+ * @ingroup File-IO
+ *
+ * @param data The queued data.
+ * @param size Number of queued bytes.
+ * @param finish Set once after all data, before the file is closed.
+ * @param io Handle to the file, the filter writes the result into it.
+ * @param user Pointer passed to @link aio_set_filter @endlink.
+ */
+typedef void (*ASYNCIO_FILTER)(const void *data, unsigned size, bool finish, IOHANDLE io, void *user);
+
+/**
+ * Passes all queued data through a filter instead of writing it to the file
+ * directly. The filter runs on the thread of the `ASYNCIO`.
+ *
+ * @ingroup File-IO
+ *
+ * @param aio Handle to the file.
+ * @param filter The filter, called until @link aio_wait @endlink returns.
+ * @param user Pointer passed to the filter.
+ *
+ * @remark Must be called before anything is written.
+ */
+void aio_set_filter(ASYNCIO *aio, ASYNCIO_FILTER filter, void *user);
+
 /**
  * Locks the `ASYNCIO` structure so it can't be written into by
  * other threads.
@@ -31,6 +31,7 @@ enum
 
 typedef bool (*CLIENTFUNC_FILTER)(const void *pData, int DataSize, void *pUser);
 struct CChecksumData;
+class CTickProfiler;
 
 class IClient : public IInterface
 {
@@ -306,6 +307,8 @@ public:
 	virtual CChecksumData *ChecksumData() = 0;
 	virtual int UdpConnectivity(int NetType) = 0;
 
+	virtual CTickProfiler *FrameProfiler() = 0;
+
 	/**
 	 * Opens a link in the browser.
 	 *
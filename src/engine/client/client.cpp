@@ -33,6 +33,7 @@
 #include <engine/shared/fifo.h>
 #include <engine/shared/filecollection.h>
 #include <engine/shared/http.h>
+#include <engine/shared/jsonwriter.h>
 #include <engine/shared/masterserver.h>
 #include <engine/shared/network.h>
 #include <engine/shared/packer.h>
@@ -71,12 +72,14 @@
 #undef main
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <new>
 #include <stack>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -104,6 +107,10 @@ CClient::CClient() :
 		GameTime.Init(0);
 	m_PredictedTime.Init(0);
 
+	m_FramePhaseUpdate = m_FrameProfiler.RegisterPhase("update");
+	m_FramePhaseRender = m_FrameProfiler.RegisterPhase("render");
+	m_FramePhaseSwap = m_FrameProfiler.RegisterPhase("swap");
+
 	m_Sixup = false;
 }
 
@@ -969,6 +976,18 @@ void CClient::DebugRender()
 
 	str_format(aBuffer, sizeof(aBuffer), "pred: %d ms", GetPredictionTime());
 	Graphics()->QuadsText(2, 70, 16, aBuffer);
+
+	{
+		int Entries;
+		int64_t Hits, Misses;
+		TextRender()->LayoutCacheStats(&Entries, &Hits, &Misses);
+		str_format(aBuffer, sizeof(aBuffer), "text layouts: %d cached, %" PRId64 " hits, %" PRId64 " misses (%d%%)",
+			Entries, Hits, Misses, Hits + Misses > 0 ? (int)(Hits * 100 / (Hits + Misses)) : 0);
+		Graphics()->QuadsText(2, 82, 16, aBuffer);
+	}
+
+	if(m_FrameProfiler.Enabled())
+		RenderFrameProfile();
 	Graphics()->QuadsEnd();
 
 	// render graphs
@@ -1039,6 +1058,29 @@ const char *CClient::ErrorString() const
 	return m_aNetClient[CONN_MAIN].ErrorString();
 }
 
+void CClient::RenderFrameProfile()
+{
+	// the most expensive phases of the last frames
+	std::vector<std::pair<int, CTickProfiler::CStats>> vPhases;
+	for(int Phase = 0; Phase < m_FrameProfiler.NumPhases(); Phase++)
+		vPhases.emplace_back(Phase, m_FrameProfiler.Stats(Phase));
+	std::stable_sort(vPhases.begin(), vPhases.end(), [](const auto &Left, const auto &Right) {
+		return Left.second.m_P50 > Right.second.m_P50;
+	});
+
+	const float x = Graphics()->ScreenWidth() / 2.0f;
+	char aBuffer[128];
+	str_format(aBuffer, sizeof(aBuffer), "%32s %8s %8s %8s", "Phase (us)", "p50", "p99", "max");
+	Graphics()->QuadsText(x, 100, 16, aBuffer);
+	for(size_t i = 0; i < minimum<size_t>(vPhases.size(), 20); i++)
+	{
+		const CTickProfiler::CStats &Stats = vPhases[i].second;
+		str_format(aBuffer, sizeof(aBuffer), "%32s %8" PRId64 " %8" PRId64 " %8" PRId64,
+			m_FrameProfiler.PhaseName(vPhases[i].first), Stats.m_P50, Stats.m_P99, Stats.m_Max);
+		Graphics()->QuadsText(x, 100 + (i + 1) * 12, 16, aBuffer);
+	}
+}
+
 void CClient::Render()
 {
 	if(g_Config.m_ClOverlayEntities)
@@ -3277,7 +3319,11 @@ void CClient::Run()
 				m_EditorActive = false;
 			}
 
-			Update();
+			m_FrameProfiler.SetEnabled(g_Config.m_DbgFrameProfiler);
+			{
+				CTickProfiler::CScope Scope(&m_FrameProfiler, m_FramePhaseUpdate);
+				Update();
+			}
 			int64_t Now = time_get();
 
 			bool IsRenderActive = (g_Config.m_GfxBackgroundRender || m_pGraphics->WindowOpen());
@@ -3326,14 +3372,24 @@ void CClient::Run()
 				LastRenderTime = Now - AdditionalTime;
 				m_LastRenderTime = Now;
 
-				if(!m_EditorActive)
-					Render();
-				else
 				{
-					m_pEditor->OnRender();
-					DebugRender();
+					CTickProfiler::CScope Scope(&m_FrameProfiler, m_FramePhaseRender);
+					if(!m_EditorActive)
+						Render();
+					else
+					{
+						m_pEditor->OnRender();
+						DebugRender();
+					}
+				}
+				{
+					// kicks the command buffer and waits for the previous frame
+					CTickProfiler::CScope Scope(&m_FrameProfiler, m_FramePhaseSwap);
+					m_pGraphics->Swap();
 				}
-				m_pGraphics->Swap();
+				m_FrameProfiler.EndTick();
+				if(m_FrameProfiler.TraceFinished())
+					WriteFrameTrace();
 			}
 			else if(!IsRenderActive)
 			{
@@ -4137,6 +4193,58 @@ void CClient::Con_BenchmarkQuit(IConsole::IResult *pResult, void *pUserData)
 	pSelf->BenchmarkQuit(Seconds, pFilename);
 }
 
+void CClient::Con_FrameProfile(IConsole::IResult *pResult, void *pUserData)
+{
+	CClient *pSelf = (CClient *)pUserData;
+	if(!pSelf->m_FrameProfiler.Enabled())
+	{
+		log_info("frame_profiler", "the frame profiler is disabled, enable it with 'dbg_frame_profiler 1'");
+		return;
+	}
+	for(int Phase = 0; Phase < pSelf->m_FrameProfiler.NumPhases(); Phase++)
+	{
+		char aBuf[256];
+		pSelf->m_FrameProfiler.FormatStats(Phase, aBuf, sizeof(aBuf));
+		log_info("frame_profiler", "%s", aBuf);
+	}
+}
+
+void CClient::Con_FrameProfileTrace(IConsole::IResult *pResult, void *pUserData)
+{
+	CClient *pSelf = (CClient *)pUserData;
+	if(!pSelf->m_FrameProfiler.Enabled())
+	{
+		log_info("frame_profiler", "the frame profiler is disabled, enable it with 'dbg_frame_profiler 1'");
+		return;
+	}
+	const int NumFrames = pResult->NumArguments() ? pResult->GetInteger(0) : 300;
+	pSelf->m_FrameProfiler.StartTrace(NumFrames);
+	log_info("frame_profiler", "recording the next %d frames", NumFrames);
+}
+
+void CClient::WriteFrameTrace()
+{
+	char aTimestamp[20];
+	str_timestamp(aTimestamp, sizeof(aTimestamp));
+	char aFilename[IO_MAX_PATH_LENGTH];
+	str_format(aFilename, sizeof(aFilename), "dumps/frame_trace_%s.json", aTimestamp);
+
+	IOHANDLE File = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(File)
+	{
+		CJsonFileWriter Writer(File);
+		m_FrameProfiler.WriteChromeTrace(&Writer);
+		char aPath[IO_MAX_PATH_LENGTH];
+		Storage()->GetCompletePath(IStorage::TYPE_SAVE, aFilename, aPath, sizeof(aPath));
+		log_info("frame_profiler", "wrote %d scopes to '%s'", m_FrameProfiler.NumTraceEvents(), aPath);
+	}
+	else
+	{
+		log_error("frame_profiler", "failed to open '%s' for writing", aFilename);
+	}
+	m_FrameProfiler.ClearTrace();
+}
+
 void CClient::BenchmarkQuit(int Seconds, const char *pFilename)
 {
 	m_BenchmarkFile = Storage()->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_ABSOLUTE);
@@ -4486,6 +4594,8 @@ void CClient::RegisterCommands()
 	m_pConsole->Register("demo_speed", "f[speed]", CFGFLAG_CLIENT, Con_DemoSpeed, this, "Set current demo speed");
 
 	m_pConsole->Register("save_replay", "?i[length] ?r[filename]", CFGFLAG_CLIENT, Con_SaveReplay, this, "Save a replay of the last defined amount of seconds");
+	m_pConsole->Register("frame_profile", "", CFGFLAG_CLIENT, Con_FrameProfile, this, "Show how long the phases of the last frames took in microseconds (needs dbg_frame_profiler 1)");
+	m_pConsole->Register("frame_profile_trace", "?i[frames]", CFGFLAG_CLIENT, Con_FrameProfileTrace, this, "Record the next frames (default 300) and write them as Chrome trace to the dumps folder (needs dbg_frame_profiler 1)");
 	m_pConsole->Register("benchmark_quit", "i[seconds] r[file]", CFGFLAG_CLIENT | CFGFLAG_STORE, Con_BenchmarkQuit, this, "Benchmark frame times for number of seconds to file, then quit");
 
 	RustVersionRegister(*m_pConsole);
@@ -22,6 +22,7 @@
 #include <engine/shared/fifo.h>
 #include <engine/shared/http.h>
 #include <engine/shared/network.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/textrender.h>
 #include <engine/warning.h>
 
@@ -246,6 +247,13 @@ class CClient : public IClient, public CDemoPlayer::IListener
 	IOHANDLE m_BenchmarkFile = 0;
 	int64_t m_BenchmarkStopTime = 0;
 
+	CTickProfiler m_FrameProfiler;
+	int m_FramePhaseUpdate;
+	int m_FramePhaseRender;
+	int m_FramePhaseSwap;
+	void WriteFrameTrace();
+	void RenderFrameProfile();
+
 	CChecksum m_Checksum;
 	int64_t m_OwnExecutableSize = 0;
 	IOHANDLE m_OwnExecutable = 0;
@@ -433,6 +441,8 @@ public:
 	static void Con_StopRecord(IConsole::IResult *pResult, void *pUserData);
 	static void Con_AddDemoMarker(IConsole::IResult *pResult, void *pUserData);
 	static void Con_BenchmarkQuit(IConsole::IResult *pResult, void *pUserData);
+	static void Con_FrameProfile(IConsole::IResult *pResult, void *pUserData);
+	static void Con_FrameProfileTrace(IConsole::IResult *pResult, void *pUserData);
 	static void ConchainServerBrowserUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainFullscreen(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainWindowBordered(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -515,6 +525,8 @@ public:
 
 	void AddWarning(const SWarning &Warning) override;
 	std::optional<SWarning> CurrentWarning() override;
+
+	CTickProfiler *FrameProfiler() override { return &m_FrameProfiler; }
 	std::vector<SWarning> &&QuittingWarnings() { return std::move(m_vQuittingWarnings); }
 
 	CChecksumData *ChecksumData() override { return &m_Checksum.m_Data; }
@@ -0,0 +1,225 @@
+#include "demo_info_cache.h"
+
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/sqlite.h>
+
+#include <sqlite3.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CDemoInfoCache : public IDemoInfoCache
+{
+public:
+	CDemoInfoCache(IConsole *pConsole, IStorage *pStorage);
+	~CDemoInfoCache() override;
+
+	void Load() override;
+
+	int NumEntries() const override;
+	bool Get(const char *pPath, time_t Modified, CEntry *pEntry) const override;
+	void Store(const char *pPath, time_t Modified, const CEntry &Entry) override;
+	void RemoveMissing(const char *pFolderPath, const std::unordered_set<std::string> &ExistingPaths) override;
+	void Flush() override;
+
+private:
+	class CStoredEntry
+	{
+	public:
+		time_t m_Modified;
+		CEntry m_Entry;
+	};
+
+	IConsole *m_pConsole;
+
+	CSqlite m_pDisk;
+	CSqliteStmt m_pLoadStmt;
+	CSqliteStmt m_pStoreStmt;
+	CSqliteStmt m_pRemoveStmt;
+
+	std::unordered_map<std::string, CStoredEntry> m_Entries;
+	std::vector<std::string> m_vPendingPaths;
+	std::vector<std::string> m_vPendingRemovals;
+};
+
+CDemoInfoCache::CDemoInfoCache(IConsole *pConsole, IStorage *pStorage) :
+	m_pConsole(pConsole)
+{
+	m_pDisk = SqliteOpen(pConsole, pStorage, "ddnet-cache.sqlite3");
+	if(!m_pDisk)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_info_cache", "failed to open ddnet-cache.sqlite3");
+		return;
+	}
+	sqlite3 *pSqlite = m_pDisk.get();
+	static const char TABLE[] = "CREATE TABLE IF NOT EXISTS demo_infos (path TEXT PRIMARY KEY NOT NULL, modified INTEGER NOT NULL, valid INTEGER NOT NULL, header BLOB NOT NULL, timeline_markers BLOB NOT NULL, map_sha256 BLOB NOT NULL, map_crc INTEGER NOT NULL, map_size INTEGER NOT NULL)";
+	if(SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, TABLE, nullptr, nullptr, nullptr)))
+	{
+		m_pDisk = nullptr;
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_info_cache", "failed to create demo_infos table");
+		return;
+	}
+	m_pLoadStmt = SqlitePrepare(pConsole, pSqlite, "SELECT path, modified, valid, header, timeline_markers, map_sha256, map_crc, map_size FROM demo_infos");
+	m_pStoreStmt = SqlitePrepare(pConsole, pSqlite, "INSERT OR REPLACE INTO demo_infos (path, modified, valid, header, timeline_markers, map_sha256, map_crc, map_size) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+	m_pRemoveStmt = SqlitePrepare(pConsole, pSqlite, "DELETE FROM demo_infos WHERE path = ?");
+}
+
+CDemoInfoCache::~CDemoInfoCache()
+{
+	Flush();
+}
+
+void CDemoInfoCache::Load()
+{
+	if(!m_pDisk)
+		return;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	bool Error = !m_pLoadStmt || SQLITE_HANDLE_ERROR(sqlite3_reset(m_pLoadStmt.get())) != SQLITE_OK;
+	while(!Error)
+	{
+		const int StepResult = SQLITE_HANDLE_ERROR(sqlite3_step(m_pLoadStmt.get()));
+		if(StepResult == SQLITE_DONE)
+		{
+			break;
+		}
+		else if(StepResult != SQLITE_ROW)
+		{
+			Error = true;
+			break;
+		}
+
+		sqlite3_stmt *pStmt = m_pLoadStmt.get();
+		const char *pPath = (const char *)sqlite3_column_text(pStmt, 0);
+		if(pPath == nullptr ||
+			sqlite3_column_bytes(pStmt, 3) != sizeof(CDemoHeader) ||
+			sqlite3_column_bytes(pStmt, 4) != sizeof(CTimelineMarkers) ||
+			sqlite3_column_bytes(pStmt, 5) != sizeof(SHA256_DIGEST))
+		{
+			continue;
+		}
+
+		CStoredEntry Stored;
+		Stored.m_Modified = sqlite3_column_int64(pStmt, 1);
+		CEntry &Entry = Stored.m_Entry;
+		Entry.m_Valid = sqlite3_column_int(pStmt, 2) != 0;
+		mem_copy(&Entry.m_Info, sqlite3_column_blob(pStmt, 3), sizeof(CDemoHeader));
+		mem_copy(&Entry.m_TimelineMarkers, sqlite3_column_blob(pStmt, 4), sizeof(CTimelineMarkers));
+		if(Entry.m_Valid && !Entry.m_Info.Valid())
+			continue;
+		mem_zero(&Entry.m_MapInfo, sizeof(Entry.m_MapInfo));
+		str_copy(Entry.m_MapInfo.m_aName, Entry.m_Info.m_aMapName);
+		mem_copy(&Entry.m_MapInfo.m_Sha256, sqlite3_column_blob(pStmt, 5), sizeof(SHA256_DIGEST));
+		Entry.m_MapInfo.m_Crc = sqlite3_column_int64(pStmt, 6);
+		Entry.m_MapInfo.m_Size = sqlite3_column_int64(pStmt, 7);
+		m_Entries[pPath] = Stored;
+	}
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_info_cache", "failed to load demo info cache");
+	}
+}
+
+int CDemoInfoCache::NumEntries() const
+{
+	return m_Entries.size();
+}
+
+bool CDemoInfoCache::Get(const char *pPath, time_t Modified, CEntry *pEntry) const
+{
+	auto Stored = m_Entries.find(pPath);
+	if(Stored == m_Entries.end() || Stored->second.m_Modified != Modified)
+		return false;
+	*pEntry = Stored->second.m_Entry;
+	return true;
+}
+
+void CDemoInfoCache::Store(const char *pPath, time_t Modified, const CEntry &Entry)
+{
+	m_Entries[pPath] = CStoredEntry{Modified, Entry};
+	m_vPendingPaths.emplace_back(pPath);
+}
+
+void CDemoInfoCache::RemoveMissing(const char *pFolderPath, const std::unordered_set<std::string> &ExistingPaths)
+{
+	char aPrefix[IO_MAX_PATH_LENGTH];
+	str_format(aPrefix, sizeof(aPrefix), "%s/", pFolderPath);
+	for(auto It = m_Entries.begin(); It != m_Entries.end();)
+	{
+		const char *pName = str_startswith(It->first.c_str(), aPrefix);
+		// entries in subfolders are checked when these are listed
+		if(pName && !str_find(pName, "/") && !ExistingPaths.count(It->first))
+		{
+			m_vPendingRemovals.push_back(It->first);
+			It = m_Entries.erase(It);
+		}
+		else
+		{
+			++It;
+		}
+	}
+}
+
+void CDemoInfoCache::Flush()
+{
+	if(m_vPendingPaths.empty() && m_vPendingRemovals.empty())
+		return;
+	if(!m_pDisk || !m_pStoreStmt || !m_pRemoveStmt)
+	{
+		m_vPendingPaths.clear();
+		m_vPendingRemovals.clear();
+		return;
+	}
+
+	// a single transaction, committing every row separately is very slow
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	bool Error = SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, "BEGIN", nullptr, nullptr, nullptr)) != SQLITE_OK;
+	for(const std::string &Path : m_vPendingPaths)
+	{
+		if(Error)
+			break;
+		auto Stored = m_Entries.find(Path);
+		if(Stored == m_Entries.end())
+			continue;
+		const CEntry &Entry = Stored->second.m_Entry;
+		sqlite3_stmt *pStmt = m_pStoreStmt.get();
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, Path.c_str(), -1, SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 2, Stored->second.m_Modified)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int(pStmt, 3, Entry.m_Valid)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 4, &Entry.m_Info, sizeof(CDemoHeader), SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 5, &Entry.m_TimelineMarkers, sizeof(CTimelineMarkers), SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 6, &Entry.m_MapInfo.m_Sha256, sizeof(SHA256_DIGEST), SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 7, Entry.m_MapInfo.m_Crc)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 8, Entry.m_MapInfo.m_Size)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_DONE;
+	}
+	for(const std::string &Path : m_vPendingRemovals)
+	{
+		if(Error)
+			break;
+		// stored again after it was removed
+		if(m_Entries.count(Path))
+			continue;
+		sqlite3_stmt *pStmt = m_pRemoveStmt.get();
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, Path.c_str(), -1, SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_DONE;
+	}
+	Error = SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, Error ? "ROLLBACK" : "COMMIT", nullptr, nullptr, nullptr)) != SQLITE_OK || Error;
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_info_cache", "failed to store demo infos");
+	}
+	m_vPendingPaths.clear();
+	m_vPendingRemovals.clear();
+}
+
+IDemoInfoCache *CreateDemoInfoCache(IConsole *pConsole, IStorage *pStorage)
+{
+	return new CDemoInfoCache(pConsole, pStorage);
+}
@@ -0,0 +1,47 @@
+#ifndef ENGINE_CLIENT_DEMO_INFO_CACHE_H
+#define ENGINE_CLIENT_DEMO_INFO_CACHE_H
+#include <engine/demo.h>
+
+#include <ctime>
+#include <string>
+#include <unordered_set>
+
+class IConsole;
+class IStorage;
+
+/**
+ * Persistent index of the header, timeline markers and map info of demo
+ * files, so the demo browser does not have to open every file again.
+ *
+ * Entries are keyed by the complete path of the demo file and are only
+ * returned if the modification time of the file did not change.
+ */
+class IDemoInfoCache
+{
+public:
+	class CEntry
+	{
+	public:
+		bool m_Valid;
+		CDemoHeader m_Info;
+		CTimelineMarkers m_TimelineMarkers;
+		CMapInfo m_MapInfo;
+	};
+
+	virtual ~IDemoInfoCache() {}
+
+	virtual void Load() = 0;
+
+	virtual int NumEntries() const = 0;
+	// Returns false if the demo isn't cached or was modified since.
+	virtual bool Get(const char *pPath, time_t Modified, CEntry *pEntry) const = 0;
+	// Stored entries are written to disk with the next flush.
+	virtual void Store(const char *pPath, time_t Modified, const CEntry &Entry) = 0;
+	// Removes the entries of demos directly in the folder which are not in
+	// `ExistingPaths`, also from disk with the next flush.
+	virtual void RemoveMissing(const char *pFolderPath, const std::unordered_set<std::string> &ExistingPaths) = 0;
+	virtual void Flush() = 0;
+};
+
+IDemoInfoCache *CreateDemoInfoCache(IConsole *pConsole, IStorage *pStorage);
+#endif // ENGINE_CLIENT_DEMO_INFO_CACHE_H
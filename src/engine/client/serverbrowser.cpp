@@ -30,14 +30,28 @@
 
 class CSortWrap
 {
-	typedef bool (CServerBrowser::*SortFunc)(int, int) const;
-	SortFunc m_pfnSort;
-	CServerBrowser *m_pThis;
+	CServerBrowser::SortFunc m_pfnSort;
+	IServerBrowser::CServerEntry *const *m_ppServerlist;
+	bool m_Reverse;
+
+	bool Less(int a, int b) const { return m_Reverse ? m_pfnSort(m_ppServerlist[b], m_ppServerlist[a]) : m_pfnSort(m_ppServerlist[a], m_ppServerlist[b]); }
 
 public:
-	CSortWrap(CServerBrowser *pServer, SortFunc Func) :
-		m_pfnSort(Func), m_pThis(pServer) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
+	CSortWrap(IServerBrowser::CServerEntry *const *ppServerlist, CServerBrowser::SortFunc Func, bool Reverse) :
+		m_pfnSort(Func), m_ppServerlist(ppServerlist), m_Reverse(Reverse) {}
+	bool operator()(int a, int b) const
+	{
+		// servers that compare equal stay in the order of the server list,
+		// so that servers can be moved to their place one by one
+		if(m_pfnSort)
+		{
+			if(Less(a, b))
+				return true;
+			if(Less(b, a))
+				return false;
+		}
+		return a < b;
+	}
 };
 
 bool matchesPart(const char *a, const char *b)
@@ -343,54 +357,40 @@ int CServerBrowser::GetExtraToken(int Token)
 	return Token >> 8;
 }
 
-bool CServerBrowser::SortCompareName(int Index1, int Index2) const
+bool CServerBrowser::SortCompareName(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	//	make sure empty entries are listed last
 	return (pIndex1->m_GotInfo && pIndex2->m_GotInfo) || (!pIndex1->m_GotInfo && !pIndex2->m_GotInfo) ? str_comp(pIndex1->m_Info.m_aName, pIndex2->m_Info.m_aName) < 0 :
 													    pIndex1->m_GotInfo != 0;
 }
 
-bool CServerBrowser::SortCompareMap(int Index1, int Index2) const
+bool CServerBrowser::SortCompareMap(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	return str_comp(pIndex1->m_Info.m_aMap, pIndex2->m_Info.m_aMap) < 0;
 }
 
-bool CServerBrowser::SortComparePing(int Index1, int Index2) const
+bool CServerBrowser::SortComparePing(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	return pIndex1->m_Info.m_Latency < pIndex2->m_Info.m_Latency;
 }
 
-bool CServerBrowser::SortCompareGametype(int Index1, int Index2) const
+bool CServerBrowser::SortCompareGametype(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	return str_comp(pIndex1->m_Info.m_aGameType, pIndex2->m_Info.m_aGameType) < 0;
 }
 
-bool CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
+bool CServerBrowser::SortCompareNumPlayers(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
 }
 
-bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
+bool CServerBrowser::SortCompareNumClients(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 	return pIndex1->m_Info.m_NumClients > pIndex2->m_Info.m_NumClients;
 }
 
-bool CServerBrowser::SortCompareNumFriends(int Index1, int Index2) const
+bool CServerBrowser::SortCompareNumFriends(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 
 	if(pIndex1->m_Info.m_FriendNum == pIndex2->m_Info.m_FriendNum)
 		return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
@@ -398,10 +398,8 @@ bool CServerBrowser::SortCompareNumFriends(int Index1, int Index2) const
 		return pIndex1->m_Info.m_FriendNum > pIndex2->m_Info.m_FriendNum;
 }
 
-bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
+bool CServerBrowser::SortCompareNumPlayersAndPing(const CServerEntry *pIndex1, const CServerEntry *pIndex2)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
 
 	if(pIndex1->m_Info.m_NumFilteredPlayers == pIndex2->m_Info.m_NumFilteredPlayers)
 		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
@@ -411,184 +409,190 @@ bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
 		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
 }
 
-void CServerBrowser::Filter()
-{
-	m_NumSortedServers = 0;
-	m_NumSortedPlayers = 0;
-
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
-	{
-		free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
-	}
-
-	// filter the servers
-	for(int i = 0; i < m_NumServers; i++)
+bool CServerBrowser::IsFiltered(CServerInfo *pInfo) const
+{
+	CServerInfo &Info = *pInfo;
+	bool Filtered = false;
+
+	if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
+		Filtered = true;
+	else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
+		Filtered = true;
+	else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
+		Filtered = true;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = true;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
+		Filtered = true;
+	else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
+		Filtered = true;
+	else
 	{
-		CServerInfo &Info = m_ppServerlist[i]->m_Info;
-		bool Filtered = false;
-
-		if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
-			Filtered = true;
-		else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
-			Filtered = true;
-		else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
-			Filtered = true;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
-			Filtered = true;
-		else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
-			Filtered = true;
-		else
+		if(!Communities().empty())
 		{
-			if(!Communities().empty())
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
 			{
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
-				{
-					Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
-				}
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
-					(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
-				{
-					Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
-					Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
-				}
+				Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
 			}
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
+				(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
+			{
+				Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
+				Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
+			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterCountry)
+		if(!Filtered && g_Config.m_BrFilterCountry)
+		{
+			Filtered = true;
+			// match against player country
+			for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
 			{
-				Filtered = true;
-				// match against player country
-				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 				{
-					if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = false;
-						break;
-					}
+					Filtered = false;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+		if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+		{
+			Info.m_QuickSearchHit = 0;
+
+			const char *pStr = g_Config.m_BrFilterString;
+			char aFilterStr[sizeof(g_Config.m_BrFilterString)];
+			char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
+			while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
 			{
-				Info.m_QuickSearchHit = 0;
+				str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
+				str_utf8_trim_right(aFilterStrTrimmed);
 
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
+				if(aFilterStrTrimmed[0] == '\0')
 				{
-					str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
-					str_utf8_trim_right(aFilterStrTrimmed);
-
-					if(aFilterStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aFilterStrTrimmed);
-					if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
-					{
-						aFilterStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
+					continue;
+				}
+				auto MatchesFn = matchesPart;
+				const int FilterLen = str_length(aFilterStrTrimmed);
+				if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
+				{
+					aFilterStrTrimmed[FilterLen - 1] = '\0';
+					MatchesFn = matchesExactly;
+				}
 
-					// match against server name
-					if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-					}
+				// match against server name
+				if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
+				{
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+				}
 
-					// match against players
-					for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				// match against players
+				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				{
+					if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
+						MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
 					{
-						if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
-							MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
+						if(g_Config.m_BrFilterConnectingPlayers &&
+							str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
+							Info.m_aClients[p].m_aClan[0] == '\0')
 						{
-							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								Info.m_aClients[p].m_aClan[0] == '\0')
-							{
-								continue;
-							}
-							Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-							break;
+							continue;
 						}
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+						Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+						break;
 					}
 				}
 
-				if(!Info.m_QuickSearchHit)
-					Filtered = true;
+				// match against map
+				if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
+				{
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+				}
 			}
 
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
+			if(!Info.m_QuickSearchHit)
+				Filtered = true;
+		}
+
+		if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
+		{
+			const char *pStr = g_Config.m_BrExcludeString;
+			char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
+			char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
+			while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
 			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
-				{
-					str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
-					str_utf8_trim_right(aExcludeStrTrimmed);
+				str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
+				str_utf8_trim_right(aExcludeStrTrimmed);
 
-					if(aExcludeStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aExcludeStrTrimmed);
-					if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
-					{
-						aExcludeStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
+				if(aExcludeStrTrimmed[0] == '\0')
+				{
+					continue;
+				}
+				auto MatchesFn = matchesPart;
+				const int FilterLen = str_length(aExcludeStrTrimmed);
+				if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
+				{
+					aExcludeStrTrimmed[FilterLen - 1] = '\0';
+					MatchesFn = matchesExactly;
+				}
 
-					// match against server name
-					if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
+				// match against server name
+				if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
+				{
+					Filtered = true;
+					break;
+				}
 
-					// match against map
-					if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
+				// match against map
+				if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
+				{
+					Filtered = true;
+					break;
+				}
 
-					// match against gametype
-					if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
+				// match against gametype
+				if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
+				{
+					Filtered = true;
+					break;
 				}
 			}
 		}
+	}
 
-		if(!Filtered)
-		{
-			UpdateServerFriends(&Info);
+	if(!Filtered)
+	{
+		UpdateServerFriends(&Info);
+		Filtered = g_Config.m_BrFilterFriends && Info.m_FriendState == IFriends::FRIEND_NO;
+	}
+	return Filtered;
+}
 
-			if(!g_Config.m_BrFilterFriends || Info.m_FriendState != IFriends::FRIEND_NO)
-			{
-				m_NumSortedPlayers += Info.m_NumFilteredPlayers;
-				m_pSortedServerlist[m_NumSortedServers++] = i;
-			}
+void CServerBrowser::Filter()
+{
+	m_NumSortedServers = 0;
+	m_NumSortedPlayers = 0;
+
+	// allocate the sorted list
+	if(m_NumSortedServersCapacity < m_NumServers)
+	{
+		free(m_pSortedServerlist);
+		m_NumSortedServersCapacity = m_NumServers;
+		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+	}
+
+	// filter the servers
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		CServerInfo &Info = m_ppServerlist[i]->m_Info;
+		if(!IsFiltered(&Info))
+		{
+			m_NumSortedPlayers += Info.m_NumFilteredPlayers;
+			m_pSortedServerlist[m_NumSortedServers++] = i;
 		}
 	}
 }
@@ -610,6 +614,61 @@ int CServerBrowser::SortHash() const
 	return i;
 }
 
+CServerBrowser::SortFunc CServerBrowser::SortFunction(int Sort, int SortOrder)
+{
+	if(SortOrder == 2 && (Sort == IServerBrowser::SORT_NUMPLAYERS || Sort == IServerBrowser::SORT_PING))
+		return &CServerBrowser::SortCompareNumPlayersAndPing;
+	else if(Sort == IServerBrowser::SORT_NAME)
+		return &CServerBrowser::SortCompareName;
+	else if(Sort == IServerBrowser::SORT_PING)
+		return &CServerBrowser::SortComparePing;
+	else if(Sort == IServerBrowser::SORT_MAP)
+		return &CServerBrowser::SortCompareMap;
+	else if(Sort == IServerBrowser::SORT_NUMFRIENDS)
+		return &CServerBrowser::SortCompareNumFriends;
+	else if(Sort == IServerBrowser::SORT_NUMPLAYERS)
+		return &CServerBrowser::SortCompareNumPlayers;
+	else if(Sort == IServerBrowser::SORT_GAMETYPE)
+		return &CServerBrowser::SortCompareGametype;
+	return nullptr;
+}
+
+void CServerBrowser::SortServers(CServerEntry *const *ppServerlist, int *pSorted, int NumSorted, int Sort, int SortOrder)
+{
+	std::sort(pSorted, pSorted + NumSorted, CSortWrap(ppServerlist, SortFunction(Sort, SortOrder), SortOrder != 0));
+}
+
+int CServerBrowser::ResortServers(CServerEntry *const *ppServerlist, int *pSorted, int NumSorted, const std::vector<int> &vChanged, const std::function<bool(CServerEntry *)> &IsFiltered, int Sort, int SortOrder)
+{
+	// the other servers are still in order, only filter the changed servers
+	// again and move them to their new place
+	for(int Index : vChanged)
+	{
+		ppServerlist[Index]->m_NeedResort = true;
+	}
+	int *pEnd = std::remove_if(pSorted, pSorted + NumSorted, [&](int Index) {
+		return ppServerlist[Index]->m_NeedResort;
+	});
+	NumSorted = pEnd - pSorted;
+
+	const CSortWrap SortWrap(ppServerlist, SortFunction(Sort, SortOrder), SortOrder != 0);
+	for(int Index : vChanged)
+	{
+		CServerEntry *pEntry = ppServerlist[Index];
+		if(!pEntry->m_NeedResort)
+			continue; // listed twice
+		pEntry->m_NeedResort = false;
+		if(IsFiltered(pEntry))
+			continue;
+
+		int *pPos = std::upper_bound(pSorted, pSorted + NumSorted, Index, SortWrap);
+		std::move_backward(pPos, pSorted + NumSorted, pSorted + NumSorted + 1);
+		*pPos = Index;
+		NumSorted++;
+	}
+	return NumSorted;
+}
+
 void CServerBrowser::Sort()
 {
 	// update number of filtered players
@@ -622,22 +681,50 @@ void CServerBrowser::Sort()
 	Filter();
 
 	// sort
-	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareName));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortComparePing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareMap));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMFRIENDS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumFriends));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayers));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareGametype));
+	SortServers(m_ppServerlist, m_pSortedServerlist, m_NumSortedServers, g_Config.m_BrSort, g_Config.m_BrSortOrder);
 
 	m_Sorthash = SortHash();
+	for(int Index : m_vResortServers)
+	{
+		m_ppServerlist[Index]->m_NeedResort = false;
+	}
+	m_vResortServers.clear();
+}
+
+void CServerBrowser::SortChanged()
+{
+	if(m_NumSortedServersCapacity < m_NumServers)
+	{
+		int *pSortedServerlist = (int *)calloc(m_NumServers, sizeof(int));
+		if(m_NumSortedServers > 0)
+			mem_copy(pSortedServerlist, m_pSortedServerlist, m_NumSortedServers * sizeof(int));
+		free(m_pSortedServerlist);
+		m_pSortedServerlist = pSortedServerlist;
+		m_NumSortedServersCapacity = m_NumServers;
+	}
+
+	m_NumSortedServers = ResortServers(
+		m_ppServerlist, m_pSortedServerlist, m_NumSortedServers, m_vResortServers, [&](CServerEntry *pEntry) {
+			UpdateServerFilteredPlayers(&pEntry->m_Info);
+			return IsFiltered(&pEntry->m_Info);
+		},
+		g_Config.m_BrSort, g_Config.m_BrSortOrder);
+	m_vResortServers.clear();
+
+	m_NumSortedPlayers = 0;
+	for(int i = 0; i < m_NumSortedServers; i++)
+	{
+		m_NumSortedPlayers += m_ppServerlist[m_pSortedServerlist[i]]->m_Info.m_NumFilteredPlayers;
+	}
+}
+
+void CServerBrowser::RequestResort(CServerEntry *pEntry)
+{
+	if(!pEntry->m_NeedResort)
+	{
+		pEntry->m_NeedResort = true;
+		m_vResortServers.push_back(pEntry->m_Info.m_ServerIndex);
+	}
 }
 
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
@@ -827,6 +914,7 @@ void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
 		}
 		m_ppServerlist[i]->m_Info.m_Latency = Ping;
 		m_ppServerlist[i]->m_Info.m_LatencyIsEstimated = false;
+		RequestResort(m_ppServerlist[i]);
 	}
 }
 
@@ -946,7 +1034,7 @@ void CServerBrowser::OnServerInfoUpdate(const NETADDR &Addr, int Token, const CS
 		pEntry->m_RequestTime = -1; // Request has been answered
 	}
 	RemoveRequest(pEntry);
-	RequestResort();
+	RequestResort(pEntry);
 }
 
 void CServerBrowser::Refresh(int Type, bool Force)
@@ -1219,6 +1307,7 @@ void CServerBrowser::CleanUp()
 	m_NumServers = 0;
 	m_NumSortedServers = 0;
 	m_NumSortedPlayers = 0;
+	m_vResortServers.clear();
 	m_ByAddr.clear();
 	m_pFirstReqServer = nullptr;
 	m_pLastReqServer = nullptr;
@@ -1316,6 +1405,10 @@ void CServerBrowser::Update()
 		Sort();
 		m_NeedResort = false;
 	}
+	else if(!m_vResortServers.empty())
+	{
+		SortChanged();
+	}
 }
 
 const json_value *CServerBrowser::LoadDDNetInfo()
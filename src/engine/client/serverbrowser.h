@@ -251,6 +251,15 @@ public:
 	int NumSortedPlayers() const override { return m_NumSortedPlayers; }
 	const CServerInfo *SortedGet(int Index) const override;
 
+	// sorting of server list indices, independent of the browser state
+	typedef bool (*SortFunc)(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static SortFunc SortFunction(int Sort, int SortOrder);
+	static void SortServers(CServerEntry *const *ppServerlist, int *pSorted, int NumSorted, int Sort, int SortOrder);
+	// removes the changed servers from the sorted indices and inserts the ones
+	// that are not filtered at their new place, pSorted must have room for all
+	// of them, returns the new number of sorted servers
+	static int ResortServers(CServerEntry *const *ppServerlist, int *pSorted, int NumSorted, const std::vector<int> &vChanged, const std::function<bool(CServerEntry *)> &IsFiltered, int Sort, int SortOrder);
+
 	const json_value *LoadDDNetInfo();
 	void LoadDDNetInfoJson();
 	void LoadDDNetLocation();
@@ -340,6 +349,8 @@ private:
 
 	bool m_NeedResort;
 	int m_Sorthash;
+	// servers that have to be filtered and sorted again, if nothing else changed
+	std::vector<int> m_vResortServers;
 
 	// used instead of g_Config.br_max_requests to get more servers
 	int m_CurrentMaxRequests;
@@ -359,18 +370,21 @@ private:
 	static int GetExtraToken(int Token);
 
 	// sorting criteria
-	bool SortCompareName(int Index1, int Index2) const;
-	bool SortCompareMap(int Index1, int Index2) const;
-	bool SortComparePing(int Index1, int Index2) const;
-	bool SortCompareGametype(int Index1, int Index2) const;
-	bool SortCompareNumPlayers(int Index1, int Index2) const;
-	bool SortCompareNumClients(int Index1, int Index2) const;
-	bool SortCompareNumFriends(int Index1, int Index2) const;
-	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
+	static bool SortCompareName(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareMap(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortComparePing(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareGametype(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareNumPlayers(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareNumClients(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareNumFriends(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
+	static bool SortCompareNumPlayersAndPing(const CServerEntry *pEntry1, const CServerEntry *pEntry2);
 
 	//
+	bool IsFiltered(CServerInfo *pInfo) const;
 	void Filter();
 	void Sort();
+	void SortChanged();
+	void RequestResort(CServerEntry *pEntry);
 	int SortHash() const;
 
 	void CleanUp();
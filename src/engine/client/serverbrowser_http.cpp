@@ -326,22 +326,46 @@ private:
 		STATE_DONE,
 		STATE_WANTREFRESH,
 		STATE_REFRESHING,
+		STATE_PARSING,
 		STATE_NO_MASTER,
 	};
 
+	// Parses the server list and converts it to `CServerInfo`s in a worker
+	// thread, the list has thousands of servers.
+	class CParseJob : public IJob
+	{
+		void Run() override;
+
+	public:
+		CParseJob(std::shared_ptr<CHttpRequest> pGetServers) :
+			m_pGetServers(std::move(pGetServers))
+		{
+			Abortable(true);
+		}
+
+		// Constant after construction.
+		std::shared_ptr<CHttpRequest> m_pGetServers;
+		// Only accessed by the main thread once the job is done.
+		bool m_Success = false;
+		std::vector<CServerInfo> m_vServers;
+	};
+
 	static bool Validate(json_value *pJson);
-	static bool Parse(json_value *pJson, std::vector<CServerInfo> *pvServers);
+	void OnServerList(bool Success, const CHttpRequest *pGetServers);
 
+	IEngine *m_pEngine;
 	IHttp *m_pHttp;
 
 	int m_State = STATE_DONE;
 	std::shared_ptr<CHttpRequest> m_pGetServers;
+	std::shared_ptr<CParseJob> m_pParseJob;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
 	std::vector<CServerInfo> m_vServers;
 };
 
 CServerBrowserHttp::CServerBrowserHttp(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
+	m_pEngine(pEngine),
 	m_pHttp(pHttp),
 	m_pChooseMaster(new CChooseMaster(pEngine, pHttp, Validate, ppUrls, NumUrls, PreviousBestIndex))
 {
@@ -354,6 +378,18 @@ CServerBrowserHttp::~CServerBrowserHttp()
 	{
 		m_pGetServers->Abort();
 	}
+	if(m_pParseJob != nullptr)
+	{
+		m_pParseJob->Abort();
+	}
+}
+
+void CServerBrowserHttp::CParseJob::Run()
+{
+	unsigned char *pResult;
+	size_t ResultLength;
+	m_pGetServers->Result(&pResult, &ResultLength);
+	m_Success = !ServerbrowserParseServers(pResult, ResultLength, &m_vServers);
 }
 
 void CServerBrowserHttp::Update()
@@ -382,37 +418,60 @@ void CServerBrowserHttp::Update()
 		{
 			return;
 		}
-		m_State = STATE_DONE;
 		std::shared_ptr<CHttpRequest> pGetServers = nullptr;
 		std::swap(m_pGetServers, pGetServers);
+		if(pGetServers->State() != EHttpState::DONE)
+		{
+			m_State = STATE_DONE;
+			OnServerList(false, pGetServers.get());
+			return;
+		}
+		m_pParseJob = std::make_shared<CParseJob>(std::move(pGetServers));
+		m_pEngine->AddJob(m_pParseJob);
+		m_State = STATE_PARSING;
+	}
+	else if(m_State == STATE_PARSING)
+	{
+		if(!m_pParseJob->Done())
+		{
+			return;
+		}
+		m_State = STATE_DONE;
+		std::shared_ptr<CParseJob> pParseJob = nullptr;
+		std::swap(m_pParseJob, pParseJob);
 
-		bool Success = true;
-		json_value *pJson = pGetServers->State() == EHttpState::DONE ? pGetServers->ResultJson() : nullptr;
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_vServers);
-		json_value_free(pJson);
-		if(!Success)
+		const bool Success = pParseJob->State() == IJob::STATE_DONE && pParseJob->m_Success;
+		if(Success)
 		{
-			log_error("serverbrowser_http", "failed getting serverlist, trying to find best URL");
-			m_pChooseMaster->Reset();
-			m_pChooseMaster->Refresh();
+			m_vServers.swap(pParseJob->m_vServers);
 		}
-		else
+		OnServerList(Success, pParseJob->m_pGetServers.get());
+	}
+}
+
+void CServerBrowserHttp::OnServerList(bool Success, const CHttpRequest *pGetServers)
+{
+	if(!Success)
+	{
+		log_error("serverbrowser_http", "failed getting serverlist, trying to find best URL");
+		m_pChooseMaster->Reset();
+		m_pChooseMaster->Refresh();
+	}
+	else
+	{
+		// Try to find new master if the current one returns
+		// results that are 5 minutes old.
+		int Age = SanitizeAge(pGetServers->ResultAgeSeconds());
+		if(Age > 300)
 		{
-			// Try to find new master if the current one returns
-			// results that are 5 minutes old.
-			int Age = SanitizeAge(pGetServers->ResultAgeSeconds());
-			if(Age > 300)
-			{
-				log_info("serverbrowser_http", "got stale serverlist, age=%ds, trying to find best URL", Age);
-				m_pChooseMaster->Refresh();
-			}
+			log_info("serverbrowser_http", "got stale serverlist, age=%ds, trying to find best URL", Age);
+			m_pChooseMaster->Refresh();
 		}
 	}
 }
 void CServerBrowserHttp::Refresh()
 {
-	if(m_State == STATE_WANTREFRESH || m_State == STATE_REFRESHING || m_State == STATE_NO_MASTER)
+	if(m_State == STATE_WANTREFRESH || m_State == STATE_REFRESHING || m_State == STATE_PARSING || m_State == STATE_NO_MASTER)
 	{
 		if(m_State == STATE_NO_MASTER)
 			m_State = STATE_WANTREFRESH;
@@ -429,12 +488,7 @@ bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 		return true;
 	return false;
 }
-bool CServerBrowserHttp::Validate(json_value *pJson)
-{
-	std::vector<CServerInfo> vServers;
-	return Parse(pJson, &vServers);
-}
-bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvServers)
+static bool ParseServers(json_value *pJson, std::vector<CServerInfo> *pvServers)
 {
 	std::vector<CServerInfo> vServers;
 
@@ -444,6 +498,7 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 	{
 		return true;
 	}
+	vServers.reserve(Servers.u.array.length);
 	for(unsigned int i = 0; i < Servers.u.array.length; i++)
 	{
 		const json_value &Server = Servers[i];
@@ -516,9 +571,25 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 			vServers.push_back(SetInfo);
 		}
 	}
-	*pvServers = vServers;
+	*pvServers = std::move(vServers);
 	return false;
 }
+bool ServerbrowserParseServers(const unsigned char *pData, size_t DataSize, std::vector<CServerInfo> *pvServers)
+{
+	json_value *pJson = json_parse((const char *)pData, DataSize);
+	if(!pJson)
+	{
+		return true;
+	}
+	bool Failure = ParseServers(pJson, pvServers);
+	json_value_free(pJson);
+	return Failure;
+}
+bool CServerBrowserHttp::Validate(json_value *pJson)
+{
+	std::vector<CServerInfo> vServers;
+	return ParseServers(pJson, &vServers);
+}
 
 static const char *DEFAULT_SERVERLIST_URLS[] = {
 	"https://master1.ddnet.org/ddnet/15/servers.json",
@@ -2,6 +2,9 @@
 #define ENGINE_CLIENT_SERVERBROWSER_HTTP_H
 #include <base/types.h>
 
+#include <cstddef>
+#include <vector>
+
 class CServerInfo;
 class IEngine;
 class IStorage;
@@ -23,5 +26,12 @@ public:
 	virtual const CServerInfo &Server(int Index) const = 0;
 };
 
+/**
+ * Parses a server list in the JSON format of the masters.
+ *
+ * @return `true` on failure.
+ */
+bool ServerbrowserParseServers(const unsigned char *pData, size_t DataSize, std::vector<CServerInfo> *pvServers);
+
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IStorage *pStorage, IHttp *pHttp, const char *pPreviousBestUrl);
 #endif // ENGINE_CLIENT_SERVERBROWSER_HTTP_H
@@ -5,11 +5,13 @@
 #include <base/math.h>
 #include <base/system.h>
 
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
 #include <engine/storage.h>
 
 #include "sound.h"
+#include "sound_mix.h"
 
 #if defined(CONF_VIDEORECORDER)
 #include <engine/shared/video.h>
@@ -24,6 +26,51 @@ extern "C" {
 static constexpr int SAMPLE_INDEX_USED = -2;
 static constexpr int SAMPLE_INDEX_FULL = -1;
 
+// Opus samples that are longer than this, e.g. music of maps, are decoded in the background
+static constexpr int BACKGROUND_DECODE_MIN_FRAMES = 10 * 48000;
+
+class COpusDecoder : public ISampleDecoder
+{
+	void *m_pFileData;
+	OggOpusFile *m_pOpusFile;
+	int m_NumChannels;
+
+public:
+	// takes ownership of the file data, if given, which the decoder reads from until it is freed
+	COpusDecoder(void *pFileData, OggOpusFile *pOpusFile, int NumChannels) :
+		m_pFileData(pFileData),
+		m_pOpusFile(pOpusFile),
+		m_NumChannels(NumChannels)
+	{
+	}
+
+	~COpusDecoder() override
+	{
+		op_free(m_pOpusFile);
+		free(m_pFileData);
+	}
+
+	int Read(short *pOut, int NumFrames) override
+	{
+		return op_read(m_pOpusFile, pOut, NumFrames * m_NumChannels, nullptr);
+	}
+};
+
+static void FreeSampleData(CSample &Sample)
+{
+	if(Sample.m_pDecodeState)
+	{
+		// the data is freed once the decoding job is done with it
+		Sample.m_pDecodeState->m_Abort.store(true, std::memory_order_relaxed);
+		Sample.m_pDecodeState = nullptr;
+	}
+	else
+	{
+		free(Sample.m_pData);
+	}
+	Sample.m_pData = nullptr;
+}
+
 void CSound::Mix(short *pFinalOut, unsigned Frames)
 {
 	Frames = minimum(Frames, m_MaxFrames);
@@ -31,22 +78,23 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 
 	// acquire lock while we are mixing
 	m_SoundLock.lock();
+	ProcessVoiceCommands();
 
 	const int MasterVol = m_SoundVolume.load(std::memory_order_relaxed);
 
-	for(auto &Voice : m_aVoices)
+	for(int i = 0; i < m_NumActiveVoices; i++)
 	{
+		CVoice &Voice = m_aVoices[m_aActiveVoices[i]];
 		if(!Voice.m_pSample)
 			continue;
 
-		// mix voice
-		int *pOut = m_pMixBuffer;
-
-		const int Step = Voice.m_pSample->m_Channels; // setup input sources
-		short *pInL = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
-		short *pInR = &Voice.m_pSample->m_pData[Voice.m_Tick * Step + 1];
+		// wait for samples that are decoded in the background
+		const int DecodedFrames = Voice.m_pSample->DecodedFrames();
+		if(Voice.m_Tick >= DecodedFrames && DecodedFrames < Voice.m_pSample->m_NumFrames)
+			continue;
 
-		unsigned End = Voice.m_pSample->m_NumFrames - Voice.m_Tick;
+		// mix voice
+		unsigned End = DecodedFrames - Voice.m_Tick;
 
 		int VolumeR = round_truncate(Voice.m_pChannel->m_Vol * (Voice.m_Vol / 255.0f));
 		int VolumeL = VolumeR;
@@ -55,10 +103,6 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		if(Frames < End)
 			End = Frames;
 
-		// check if we have a mono sound
-		if(Voice.m_pSample->m_Channels == 1)
-			pInR = pInL;
-
 		// volume calculation
 		if(Voice.m_Flags & ISound::FLAG_POS && Voice.m_pChannel->m_Pan)
 		{
@@ -132,14 +176,9 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		}
 
 		// process all frames
-		for(unsigned s = 0; s < End; s++)
-		{
-			*pOut++ += (*pInL) * VolumeL;
-			*pOut++ += (*pInR) * VolumeR;
-			pInL += Step;
-			pInR += Step;
-			Voice.m_Tick++;
-		}
+		const int Channels = Voice.m_pSample->m_Channels;
+		SoundMixVoice(m_pMixBuffer, &Voice.m_pSample->m_pData[Voice.m_Tick * Channels], Channels, End, VolumeL, VolumeR);
+		Voice.m_Tick += End;
 
 		// free voice if not used any more
 		if(Voice.m_Tick == Voice.m_pSample->m_NumFrames)
@@ -154,11 +193,11 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		}
 	}
 
+	RemoveInactiveVoices();
 	m_SoundLock.unlock();
 
 	// clamp accumulated values
-	for(unsigned i = 0; i < Frames * 2; i++)
-		pFinalOut[i] = clamp<int>(((m_pMixBuffer[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+	SoundConvertMix(pFinalOut, m_pMixBuffer, Frames * 2, MasterVol);
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
 	swap_endian(pFinalOut, sizeof(short), Frames * 2);
@@ -186,6 +225,7 @@ static void SdlCallback(void *pUser, Uint8 *pStream, int Len)
 int CSound::Init()
 {
 	m_SoundEnabled = false;
+	m_pEngine = Kernel()->RequestInterface<IEngine>();
 	m_pGraphics = Kernel()->RequestInterface<IEngineGraphics>();
 	m_pStorage = Kernel()->RequestInterface<IStorage>();
 
@@ -268,10 +308,7 @@ void CSound::Shutdown()
 
 	const CLockScope LockScope(m_SoundLock);
 	for(auto &Sample : m_aSamples)
-	{
-		free(Sample.m_pData);
-		Sample.m_pData = nullptr;
-	}
+		FreeSampleData(Sample);
 
 	free(m_pMixBuffer);
 	m_pMixBuffer = nullptr;
@@ -355,26 +392,23 @@ bool CSound::DecodeOpus(CSample &Sample, const void *pData, unsigned DataSize) c
 			return false;
 		}
 
+		if(NumSamples >= BACKGROUND_DECODE_MIN_FRAMES && m_SoundEnabled && m_MixingRate == 48000)
+		{
+			op_free(pOpusFile);
+			return DecodeOpusInBackground(Sample, pData, DataSize, NumSamples, NumChannels);
+		}
+
 		short *pSampleData = (short *)calloc((size_t)NumSamples * NumChannels, sizeof(short));
 
-		int Pos = 0;
-		while(Pos < NumSamples)
+		COpusDecoder Decoder(nullptr, pOpusFile, NumChannels);
+		const int Pos = SoundDecode(&Decoder, pSampleData, NumSamples, NumChannels);
+		if(Pos < 0)
 		{
-			const int Read = op_read(pOpusFile, pSampleData + Pos * NumChannels, (NumSamples - Pos) * NumChannels, nullptr);
-			if(Read < 0)
-			{
-				free(pSampleData);
-				op_free(pOpusFile);
-				dbg_msg("sound/opus", "op_read error %d at %d", Read, Pos);
-				return false;
-			}
-			else if(Read == 0) // EOF
-				break;
-			Pos += Read;
+			free(pSampleData);
+			dbg_msg("sound/opus", "op_read error %d", Pos);
+			return false;
 		}
 
-		op_free(pOpusFile);
-
 		Sample.m_pData = pSampleData;
 		Sample.m_NumFrames = Pos;
 		Sample.m_Rate = 48000;
@@ -392,6 +426,36 @@ bool CSound::DecodeOpus(CSample &Sample, const void *pData, unsigned DataSize) c
 	return true;
 }
 
+bool CSound::DecodeOpusInBackground(CSample &Sample, const void *pData, unsigned DataSize, int NumFrames, int NumChannels) const
+{
+	// the decoder reads from the file data until it is done
+	void *pFileData = malloc(DataSize);
+	mem_copy(pFileData, pData, DataSize);
+	int OpusError = 0;
+	OggOpusFile *pOpusFile = op_open_memory((const unsigned char *)pFileData, DataSize, &OpusError);
+	if(!pOpusFile)
+	{
+		free(pFileData);
+		dbg_msg("sound/opus", "failed to decode sample, error %d", OpusError);
+		return false;
+	}
+
+	std::shared_ptr<CSampleDecodeState> pState = std::make_shared<CSampleDecodeState>();
+	pState->m_pData = (short *)calloc((size_t)NumFrames * NumChannels, sizeof(short));
+
+	Sample.m_pDecodeState = pState;
+	Sample.m_pData = pState->m_pData;
+	Sample.m_NumFrames = NumFrames;
+	Sample.m_Rate = 48000;
+	Sample.m_Channels = NumChannels;
+	Sample.m_LoopStart = -1;
+	Sample.m_LoopEnd = -1;
+	Sample.m_PausedAt = 0;
+
+	SoundDecodeInBackground(m_pEngine, std::move(pState), std::make_unique<COpusDecoder>(pFileData, pOpusFile, NumChannels), NumFrames, NumChannels);
+	return true;
+}
+
 // TODO: Update WavPack to get rid of these global variables
 static const void *s_pWVBuffer = nullptr;
 static int s_WVBufferPosition = 0;
@@ -639,6 +703,7 @@ void CSound::UnloadSample(int SampleId)
 
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	CSample &Sample = m_aSamples[SampleId];
 
 	if(Sample.IsLoaded())
@@ -653,8 +718,7 @@ void CSound::UnloadSample(int SampleId)
 		}
 
 		// Free data
-		free(Sample.m_pData);
-		Sample.m_pData = nullptr;
+		FreeSampleData(Sample);
 	}
 
 	// Free slot
@@ -679,6 +743,7 @@ float CSound::GetSampleCurrentTime(int SampleId)
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
 
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	CSample *pSample = &m_aSamples[SampleId];
 	for(auto &Voice : m_aVoices)
@@ -697,6 +762,7 @@ void CSound::SetSampleCurrentTime(int SampleId, float Time)
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
 
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	CSample *pSample = &m_aSamples[SampleId];
 	for(auto &Voice : m_aVoices)
@@ -731,14 +797,7 @@ void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	Volume = clamp(Volume, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Vol = (int)(Volume * 255.0f);
+	QueueVoiceCommand({CVoiceCommand::SET_VOLUME, Voice.Id(), Voice.Age(), {Volume, 0.0f}});
 }
 
 void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
@@ -746,14 +805,7 @@ void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	Falloff = clamp(Falloff, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Falloff = Falloff;
+	QueueVoiceCommand({CVoiceCommand::SET_FALLOFF, Voice.Id(), Voice.Age(), {Falloff, 0.0f}});
 }
 
 void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
@@ -761,13 +813,7 @@ void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_Position = Position;
+	QueueVoiceCommand({CVoiceCommand::SET_POSITION, Voice.Id(), Voice.Age(), {Position.x, Position.y}});
 }
 
 void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
@@ -775,69 +821,120 @@ void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
+	QueueVoiceCommand({CVoiceCommand::SET_TIME_OFFSET, Voice.Id(), Voice.Age(), {TimeOffset, 0.0f}});
+}
 
-	if(!m_aVoices[VoiceId].m_pSample)
+void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
+{
+	if(!Voice.IsValid())
 		return;
 
-	int Tick = 0;
-	bool IsLooping = m_aVoices[VoiceId].m_Flags & ISound::FLAG_LOOP;
-	uint64_t TickOffset = m_aVoices[VoiceId].m_pSample->m_Rate * TimeOffset;
-	if(m_aVoices[VoiceId].m_pSample->m_NumFrames > 0 && IsLooping)
-		Tick = TickOffset % m_aVoices[VoiceId].m_pSample->m_NumFrames;
-	else
-		Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)m_aVoices[VoiceId].m_pSample->m_NumFrames);
-
-	// at least 200msec off, else depend on buffer size
-	float Threshold = maximum(0.2f * m_aVoices[VoiceId].m_pSample->m_Rate, (float)m_MaxFrames);
-	if(absolute(m_aVoices[VoiceId].m_Tick - Tick) > Threshold)
-	{
-		// take care of looping (modulo!)
-		if(!(IsLooping && (minimum(m_aVoices[VoiceId].m_Tick, Tick) + m_aVoices[VoiceId].m_pSample->m_NumFrames - maximum(m_aVoices[VoiceId].m_Tick, Tick)) <= Threshold))
-		{
-			m_aVoices[VoiceId].m_Tick = Tick;
-		}
-	}
+	QueueVoiceCommand({CVoiceCommand::SET_CIRCLE, Voice.Id(), Voice.Age(), {Radius, 0.0f}});
 }
 
-void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
+void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
 {
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
+	QueueVoiceCommand({CVoiceCommand::SET_RECTANGLE, Voice.Id(), Voice.Age(), {Width, Height}});
+}
 
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+void CSound::QueueVoiceCommand(const CVoiceCommand &Command)
+{
+	if(m_VoiceCommands.Push(Command))
 		return;
 
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = maximum(0.0f, Radius);
+	// the mixer is not keeping up (or not running), apply everything here
+	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
+	ApplyVoiceCommand(Command);
 }
 
-void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
+void CSound::ProcessVoiceCommands()
 {
-	if(!Voice.IsValid())
+	CVoiceCommand Command;
+	while(m_VoiceCommands.Pop(&Command))
+		ApplyVoiceCommand(Command);
+}
+
+void CSound::ApplyVoiceCommand(const CVoiceCommand &Command)
+{
+	CVoice &Voice = m_aVoices[Command.m_VoiceId];
+	if(Voice.m_Age != Command.m_Age)
 		return;
 
-	int VoiceId = Voice.Id();
+	switch(Command.m_Type)
+	{
+	case CVoiceCommand::SET_VOLUME:
+		Voice.m_Vol = (int)(clamp(Command.m_aValues[0], 0.0f, 1.0f) * 255.0f);
+		break;
 
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
+	case CVoiceCommand::SET_FALLOFF:
+		Voice.m_Falloff = clamp(Command.m_aValues[0], 0.0f, 1.0f);
+		break;
+
+	case CVoiceCommand::SET_POSITION:
+		Voice.m_Position = vec2(Command.m_aValues[0], Command.m_aValues[1]);
+		break;
+
+	case CVoiceCommand::SET_TIME_OFFSET:
+	{
+		if(!Voice.m_pSample)
+			break;
 
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_RECTANGLE;
-	m_aVoices[VoiceId].m_Rectangle.m_Width = maximum(0.0f, Width);
-	m_aVoices[VoiceId].m_Rectangle.m_Height = maximum(0.0f, Height);
+		int Tick = 0;
+		bool IsLooping = Voice.m_Flags & ISound::FLAG_LOOP;
+		uint64_t TickOffset = Voice.m_pSample->m_Rate * Command.m_aValues[0];
+		if(Voice.m_pSample->m_NumFrames > 0 && IsLooping)
+			Tick = TickOffset % Voice.m_pSample->m_NumFrames;
+		else
+			Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)Voice.m_pSample->m_NumFrames);
+
+		// at least 200msec off, else depend on buffer size
+		float Threshold = maximum(0.2f * Voice.m_pSample->m_Rate, (float)m_MaxFrames);
+		if(absolute(Voice.m_Tick - Tick) > Threshold)
+		{
+			// take care of looping (modulo!)
+			if(!(IsLooping && (minimum(Voice.m_Tick, Tick) + Voice.m_pSample->m_NumFrames - maximum(Voice.m_Tick, Tick)) <= Threshold))
+			{
+				Voice.m_Tick = Tick;
+			}
+		}
+		break;
+	}
+
+	case CVoiceCommand::SET_CIRCLE:
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = maximum(0.0f, Command.m_aValues[0]);
+		break;
+
+	case CVoiceCommand::SET_RECTANGLE:
+		Voice.m_Shape = ISound::SHAPE_RECTANGLE;
+		Voice.m_Rectangle.m_Width = maximum(0.0f, Command.m_aValues[0]);
+		Voice.m_Rectangle.m_Height = maximum(0.0f, Command.m_aValues[1]);
+		break;
+	}
+}
+
+void CSound::RemoveInactiveVoices()
+{
+	int NumActiveVoices = 0;
+	for(int i = 0; i < m_NumActiveVoices; i++)
+	{
+		CVoice &Voice = m_aVoices[m_aActiveVoices[i]];
+		if(Voice.m_pSample)
+			m_aActiveVoices[NumActiveVoices++] = m_aActiveVoices[i];
+		else
+			Voice.m_Active = false;
+	}
+	m_NumActiveVoices = NumActiveVoices;
 }
 
 ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
 {
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 
 	// search for voice
 	int VoiceId = -1;
@@ -857,6 +954,11 @@ ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float
 	}
 
 	// voice found, use it
+	if(!m_aVoices[VoiceId].m_Active)
+	{
+		m_aVoices[VoiceId].m_Active = true;
+		m_aActiveVoices[m_NumActiveVoices++] = VoiceId;
+	}
 	m_aVoices[VoiceId].m_pSample = &m_aSamples[SampleId];
 	m_aVoices[VoiceId].m_pChannel = &m_aChannels[ChannelId];
 	if(Flags & FLAG_LOOP)
@@ -897,6 +999,7 @@ void CSound::Pause(int SampleId)
 
 	// TODO: a nice fade out
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	CSample *pSample = &m_aSamples[SampleId];
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	for(auto &Voice : m_aVoices)
@@ -915,6 +1018,7 @@ void CSound::Stop(int SampleId)
 
 	// TODO: a nice fade out
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	CSample *pSample = &m_aSamples[SampleId];
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	for(auto &Voice : m_aVoices)
@@ -934,6 +1038,7 @@ void CSound::StopAll()
 {
 	// TODO: a nice fade out
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	for(auto &Voice : m_aVoices)
 	{
 		if(Voice.m_pSample)
@@ -955,6 +1060,7 @@ void CSound::StopVoice(CVoiceHandle Voice)
 	int VoiceId = Voice.Id();
 
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	if(m_aVoices[VoiceId].m_Age != Voice.Age())
 		return;
 
@@ -966,6 +1072,7 @@ bool CSound::IsPlaying(int SampleId)
 {
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
 	const CLockScope LockScope(m_SoundLock);
+	ProcessVoiceCommands();
 	const CSample *pSample = &m_aSamples[SampleId];
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	return std::any_of(std::begin(m_aVoices), std::end(m_aVoices), [pSample](const auto &Voice) { return Voice.m_pSample == pSample; });
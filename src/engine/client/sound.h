@@ -5,11 +5,15 @@
 
 #include <base/lock.h>
 
+#include <engine/shared/spsc_queue.h>
 #include <engine/sound.h>
 
+#include "sound_decode.h"
+
 #include <SDL_audio.h>
 
 #include <atomic>
+#include <memory>
 
 struct CSample
 {
@@ -24,11 +28,19 @@ struct CSample
 	int m_LoopEnd;
 	int m_PausedAt;
 
+	// set while the sample is decoded in the background, owns the data then
+	std::shared_ptr<CSampleDecodeState> m_pDecodeState;
+
 	float TotalTime() const
 	{
 		return m_NumFrames / (float)m_Rate;
 	}
 
+	int DecodedFrames() const
+	{
+		return m_pDecodeState ? m_pDecodeState->m_NumDecodedFrames.load(std::memory_order_acquire) : m_NumFrames;
+	}
+
 	bool IsLoaded() const
 	{
 		return m_pData != nullptr;
@@ -58,6 +70,27 @@ struct CVoice
 		ISound::CVoiceShapeCircle m_Circle;
 		ISound::CVoiceShapeRectangle m_Rectangle;
 	};
+
+	bool m_Active; // in the list of active voices
+};
+
+// Changes of a playing voice, sent from the game thread to the mixer
+struct CVoiceCommand
+{
+	enum
+	{
+		SET_VOLUME,
+		SET_FALLOFF,
+		SET_POSITION,
+		SET_TIME_OFFSET,
+		SET_CIRCLE,
+		SET_RECTANGLE,
+	};
+
+	int m_Type;
+	int m_VoiceId;
+	int m_Age;
+	float m_aValues[2];
 };
 
 class CSound : public IEngineSound
@@ -67,6 +100,7 @@ class CSound : public IEngineSound
 		NUM_SAMPLES = 512,
 		NUM_VOICES = 256,
 		NUM_CHANNELS = 16,
+		NUM_VOICE_COMMANDS = 1024,
 	};
 
 	bool m_SoundEnabled = false;
@@ -77,6 +111,11 @@ class CSound : public IEngineSound
 	int m_FirstFreeSampleIndex GUARDED_BY(m_SoundLock) = 0;
 
 	CVoice m_aVoices[NUM_VOICES] GUARDED_BY(m_SoundLock) = {{0}};
+	// indices of the voices that might be playing, so the mixer does not have to check every voice
+	int m_aActiveVoices[NUM_VOICES] GUARDED_BY(m_SoundLock);
+	int m_NumActiveVoices GUARDED_BY(m_SoundLock) = 0;
+	// pushed by the game thread without locking, popped by whoever holds the sound lock
+	CSpscQueue<CVoiceCommand, NUM_VOICE_COMMANDS> m_VoiceCommands;
 	CChannel m_aChannels[NUM_CHANNELS] GUARDED_BY(m_SoundLock) = {{255, 0}};
 	int m_NextVoice GUARDED_BY(m_SoundLock) = 0;
 	uint32_t m_MaxFrames = 0;
@@ -88,6 +127,7 @@ class CSound : public IEngineSound
 	std::atomic<int> m_SoundVolume = 100;
 	int m_MixingRate = 48000;
 
+	class IEngine *m_pEngine = nullptr;
 	class IEngineGraphics *m_pGraphics = nullptr;
 	IStorage *m_pStorage = nullptr;
 
@@ -97,10 +137,16 @@ class CSound : public IEngineSound
 	void RateConvert(CSample &Sample) const;
 
 	bool DecodeOpus(CSample &Sample, const void *pData, unsigned DataSize) const;
+	bool DecodeOpusInBackground(CSample &Sample, const void *pData, unsigned DataSize, int NumFrames, int NumChannels) const;
 	bool DecodeWV(CSample &Sample, const void *pData, unsigned DataSize) const;
 
 	void UpdateVolume();
 
+	void QueueVoiceCommand(const CVoiceCommand &Command) REQUIRES(!m_SoundLock);
+	void ProcessVoiceCommands() REQUIRES(m_SoundLock);
+	void ApplyVoiceCommand(const CVoiceCommand &Command) REQUIRES(m_SoundLock);
+	void RemoveInactiveVoices() REQUIRES(m_SoundLock);
+
 public:
 	int Init() override REQUIRES(!m_SoundLock);
 	int Update() override;
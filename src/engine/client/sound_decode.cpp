@@ -0,0 +1,74 @@
+#include "sound_decode.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/engine.h>
+#include <engine/shared/jobs.h>
+
+static int DecodeFrames(ISampleDecoder *pDecoder, short *pOut, int Pos, int End, int NumChannels)
+{
+	while(Pos < End)
+	{
+		const int Read = pDecoder->Read(pOut + (size_t)Pos * NumChannels, End - Pos);
+		if(Read < 0)
+			return Read;
+		else if(Read == 0) // EOF
+			break;
+		Pos += Read;
+	}
+	return Pos;
+}
+
+int SoundDecode(ISampleDecoder *pDecoder, short *pOut, int NumFrames, int NumChannels)
+{
+	return DecodeFrames(pDecoder, pOut, 0, NumFrames, NumChannels);
+}
+
+class CDecodeChunkJob : public IJob
+{
+	IEngine *m_pEngine;
+	std::shared_ptr<CSampleDecodeState> m_pState;
+	std::unique_ptr<ISampleDecoder> m_pDecoder;
+	int m_Pos;
+	int m_NumFrames;
+	int m_NumChannels;
+
+	void Run() override
+	{
+		if(m_pState->m_Abort.load(std::memory_order_relaxed))
+			return;
+
+		const int End = minimum(m_Pos + SOUND_DECODE_CHUNK_FRAMES, m_NumFrames);
+		const int Pos = DecodeFrames(m_pDecoder.get(), m_pState->m_pData, m_Pos, End, m_NumChannels);
+		if(Pos < 0)
+		{
+			dbg_msg("sound/decode", "decoder error %d after %d frames", Pos, m_Pos);
+		}
+		else if(Pos == End && End < m_NumFrames)
+		{
+			m_pState->m_NumDecodedFrames.store(Pos, std::memory_order_release);
+			m_pEngine->AddJob(std::make_shared<CDecodeChunkJob>(m_pEngine, std::move(m_pState), std::move(m_pDecoder), Pos, m_NumFrames, m_NumChannels));
+			return;
+		}
+
+		// the rest of the sample stays silent
+		m_pState->m_NumDecodedFrames.store(m_NumFrames, std::memory_order_release);
+	}
+
+public:
+	CDecodeChunkJob(IEngine *pEngine, std::shared_ptr<CSampleDecodeState> pState, std::unique_ptr<ISampleDecoder> pDecoder, int Pos, int NumFrames, int NumChannels) :
+		m_pEngine(pEngine),
+		m_pState(std::move(pState)),
+		m_pDecoder(std::move(pDecoder)),
+		m_Pos(Pos),
+		m_NumFrames(NumFrames),
+		m_NumChannels(NumChannels)
+	{
+	}
+};
+
+void SoundDecodeInBackground(IEngine *pEngine, std::shared_ptr<CSampleDecodeState> pState, std::unique_ptr<ISampleDecoder> pDecoder, int NumFrames, int NumChannels)
+{
+	pEngine->AddJob(std::make_shared<CDecodeChunkJob>(pEngine, std::move(pState), std::move(pDecoder), 0, NumFrames, NumChannels));
+}
@@ -0,0 +1,55 @@
+#ifndef ENGINE_CLIENT_SOUND_DECODE_H
+#define ENGINE_CLIENT_SOUND_DECODE_H
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+
+class IEngine;
+
+// Progress of a sample that is decoded in the background. It is shared with
+// the decoding jobs, which keep writing to the data while the sample plays.
+struct CSampleDecodeState
+{
+	short *m_pData = nullptr;
+	std::atomic<int> m_NumDecodedFrames = 0;
+	std::atomic<bool> m_Abort = false;
+
+	~CSampleDecodeState() { free(m_pData); }
+};
+
+class ISampleDecoder
+{
+public:
+	virtual ~ISampleDecoder() = default;
+
+	/**
+	 * Decodes up to `NumFrames` interleaved frames to `pOut`. Returns the
+	 * number of decoded frames, 0 at the end of the data or a negative error
+	 * code.
+	 */
+	virtual int Read(short *pOut, int NumFrames) = 0;
+};
+
+/**
+ * Number of frames that one background decoding job decodes, one second at
+ * 48 kHz.
+ */
+static constexpr int SOUND_DECODE_CHUNK_FRAMES = 48000;
+
+/**
+ * Decodes `NumFrames` frames with `NumChannels` channels to `pOut`. Returns
+ * the number of decoded frames, which is less than `NumFrames` if the data
+ * ends early, or the error code of the decoder.
+ */
+int SoundDecode(ISampleDecoder *pDecoder, short *pOut, int NumFrames, int NumChannels);
+
+/**
+ * Decodes `NumFrames` frames with `NumChannels` channels to the data of
+ * `pState` in the background. Each job decodes one chunk and adds a job for
+ * the next one, so that a long sample doesn't keep a worker of the job pool
+ * busy. The part of the sample after a decoding error stays silent.
+ */
+void SoundDecodeInBackground(IEngine *pEngine, std::shared_ptr<CSampleDecodeState> pState, std::unique_ptr<ISampleDecoder> pDecoder, int NumFrames, int NumChannels);
+
+#endif
@@ -0,0 +1,107 @@
+#include "sound_mix.h"
+
+#include <base/detect.h>
+#include <base/math.h>
+
+#include <limits>
+
+// SSE2 is always available on x86-64
+#if defined(CONF_ARCH_AMD64) || defined(__SSE2__)
+#define SOUND_MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const short *pInL = pIn;
+	const short *pInR = Channels == 1 ? pIn : pIn + 1;
+	for(unsigned s = 0; s < Frames; s++)
+	{
+		*pOut++ += (*pInL) * VolumeL;
+		*pOut++ += (*pInR) * VolumeR;
+		pInL += Channels;
+		pInR += Channels;
+	}
+}
+
+void SoundConvertMixScalar(short *pOut, const int *pIn, unsigned NumSamples, int MasterVol)
+{
+	for(unsigned i = 0; i < NumSamples; i++)
+		pOut[i] = clamp<int>(((pIn[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+}
+
+#if defined(SOUND_MIX_SSE2)
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	// the products are calculated with 16 bit factors
+	if(VolumeL < std::numeric_limits<short>::min() || VolumeL > std::numeric_limits<short>::max() ||
+		VolumeR < std::numeric_limits<short>::min() || VolumeR > std::numeric_limits<short>::max())
+	{
+		SoundMixVoiceScalar(pOut, pIn, Channels, Frames, VolumeL, VolumeR);
+		return;
+	}
+
+	// multiplying (sample, 0) pairs with (volume, 0) pairs gives the exact 32 bit products
+	const __m128i Volume = _mm_set_epi16(0, VolumeR, 0, VolumeL, 0, VolumeR, 0, VolumeL);
+	const __m128i Zero = _mm_setzero_si128();
+	unsigned Frame = 0;
+	if(Channels == 1)
+	{
+		for(; Frame + 8 <= Frames; Frame += 8)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)(pIn + Frame));
+			const __m128i Lo = _mm_unpacklo_epi16(In, In);
+			const __m128i Hi = _mm_unpackhi_epi16(In, In);
+			__m128i *pDst = (__m128i *)(pOut + Frame * 2);
+			_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_madd_epi16(_mm_unpacklo_epi16(Lo, Zero), Volume)));
+			_mm_storeu_si128(pDst + 1, _mm_add_epi32(_mm_loadu_si128(pDst + 1), _mm_madd_epi16(_mm_unpackhi_epi16(Lo, Zero), Volume)));
+			_mm_storeu_si128(pDst + 2, _mm_add_epi32(_mm_loadu_si128(pDst + 2), _mm_madd_epi16(_mm_unpacklo_epi16(Hi, Zero), Volume)));
+			_mm_storeu_si128(pDst + 3, _mm_add_epi32(_mm_loadu_si128(pDst + 3), _mm_madd_epi16(_mm_unpackhi_epi16(Hi, Zero), Volume)));
+		}
+	}
+	else
+	{
+		for(; Frame + 4 <= Frames; Frame += 4)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)(pIn + Frame * 2));
+			__m128i *pDst = (__m128i *)(pOut + Frame * 2);
+			_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_madd_epi16(_mm_unpacklo_epi16(In, Zero), Volume)));
+			_mm_storeu_si128(pDst + 1, _mm_add_epi32(_mm_loadu_si128(pDst + 1), _mm_madd_epi16(_mm_unpackhi_epi16(In, Zero), Volume)));
+		}
+	}
+	SoundMixVoiceScalar(pOut + Frame * 2, pIn + Frame * Channels, Channels, Frames - Frame, VolumeL, VolumeR);
+}
+
+static __m128i ApplyMasterVolume(__m128i In, __m128d MasterVol, __m128d Divisor)
+{
+	// doubles hold the products exactly, so truncating the quotient matches the integer division
+	const __m128d Lo = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(In), MasterVol), Divisor);
+	const __m128d Hi = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(In, _MM_SHUFFLE(1, 0, 3, 2))), MasterVol), Divisor);
+	return _mm_srai_epi32(_mm_unpacklo_epi64(_mm_cvttpd_epi32(Lo), _mm_cvttpd_epi32(Hi)), 8);
+}
+
+void SoundConvertMix(short *pOut, const int *pIn, unsigned NumSamples, int MasterVol)
+{
+	const __m128d MasterVolume = _mm_set1_pd(MasterVol);
+	const __m128d Divisor = _mm_set1_pd(101.0);
+	unsigned i = 0;
+	for(; i + 8 <= NumSamples; i += 8)
+	{
+		const __m128i Lo = ApplyMasterVolume(_mm_loadu_si128((const __m128i *)(pIn + i)), MasterVolume, Divisor);
+		const __m128i Hi = ApplyMasterVolume(_mm_loadu_si128((const __m128i *)(pIn + i + 4)), MasterVolume, Divisor);
+		// saturating pack
+		_mm_storeu_si128((__m128i *)(pOut + i), _mm_packs_epi32(Lo, Hi));
+	}
+	SoundConvertMixScalar(pOut + i, pIn + i, NumSamples - i, MasterVol);
+}
+#else
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	SoundMixVoiceScalar(pOut, pIn, Channels, Frames, VolumeL, VolumeR);
+}
+
+void SoundConvertMix(short *pOut, const int *pIn, unsigned NumSamples, int MasterVol)
+{
+	SoundConvertMixScalar(pOut, pIn, NumSamples, MasterVol);
+}
+#endif
@@ -0,0 +1,19 @@
+#ifndef ENGINE_CLIENT_SOUND_MIX_H
+#define ENGINE_CLIENT_SOUND_MIX_H
+
+/**
+ * Adds `Frames` frames of sample data multiplied by the volume to the
+ * interleaved stereo mix buffer `pOut`. `Channels` is the number of channels
+ * of the sample data, mono samples are added to both channels.
+ */
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+
+/**
+ * Applies the master volume (0-100) to `NumSamples` values of the mix buffer
+ * and converts them to 16 bit samples, clamping them to the range of `short`.
+ */
+void SoundConvertMix(short *pOut, const int *pIn, unsigned NumSamples, int MasterVol);
+void SoundConvertMixScalar(short *pOut, const int *pIn, unsigned NumSamples, int MasterVol);
+
+#endif
@@ -4,6 +4,8 @@
 #include <base/math.h>
 #include <base/system.h>
 
+#include "text_layout_cache.h"
+
 #include <engine/console.h>
 #include <engine/graphics.h>
 #include <engine/shared/json.h>
@@ -342,6 +344,9 @@ private:
 	std::vector<FT_Face> m_vFallbackFaces;
 	std::vector<FT_Face> m_vFtFaces;
 
+	// Incremented whenever the faces or the atlas change, to invalidate cached layouts
+	unsigned m_Generation = 0;
+
 	FT_Face GetFaceByName(const char *pFamilyName)
 	{
 		if(pFamilyName == nullptr || pFamilyName[0] == '\0')
@@ -403,6 +408,7 @@ private:
 		m_TextureAtlas.IncreaseDimension(NewTextureDimension);
 
 		m_TextureDimension = NewTextureDimension;
+		m_Generation++;
 
 		UploadTextures();
 		return true;
@@ -470,24 +476,41 @@ private:
 
 	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
 	{
+		// The weight of a neighbour only depends on its offset, so compute the
+		// weights once and leave out the neighbours outside of the outline.
+		struct SNeighbour
+		{
+			int m_X;
+			int m_Y;
+			float m_Mask;
+		};
+		std::vector<SNeighbour> vNeighbours;
+		vNeighbours.reserve((2 * OutlineCount + 1) * (2 * OutlineCount + 1));
+		for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+		{
+			for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+			{
+				float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
+				if(Mask > 0.f)
+					vNeighbours.push_back({sx, sy, Mask});
+			}
+		}
+
 		for(int y = 0; y < h; y++)
 		{
 			for(int x = 0; x < w; x++)
 			{
 				int c = pIn[y * w + x];
 
-				for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+				for(const SNeighbour &Neighbour : vNeighbours)
 				{
-					for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+					if(c == 255)
+						break;
+					int GetX = x + Neighbour.m_X;
+					int GetY = y + Neighbour.m_Y;
+					if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
 					{
-						int GetX = x + sx;
-						int GetY = y + sy;
-						if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
-						{
-							int Index = GetY * w + GetX;
-							float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
-							c = maximum(c, int(pIn[Index] * Mask));
-						}
+						c = maximum(c, int(pIn[GetY * w + GetX] * Neighbour.m_Mask));
 					}
 				}
 
@@ -639,13 +662,25 @@ public:
 		return m_IconFace;
 	}
 
+	FT_Face SelectedFace() const
+	{
+		return m_SelectedFace;
+	}
+
+	unsigned Generation() const
+	{
+		return m_Generation;
+	}
+
 	void AddFace(FT_Face Face)
 	{
 		m_vFtFaces.push_back(Face);
+		m_Generation++;
 	}
 
 	bool SetDefaultFaceByName(const char *pFamilyName)
 	{
+		m_Generation++;
 		m_DefaultFace = GetFaceByName(pFamilyName);
 		if(!m_DefaultFace)
 		{
@@ -661,6 +696,7 @@ public:
 
 	bool SetIconFaceByName(const char *pFamilyName)
 	{
+		m_Generation++;
 		m_IconFace = GetFaceByName(pFamilyName);
 		if(!m_IconFace)
 		{
@@ -684,6 +720,7 @@ public:
 			return true;
 		}
 		m_vFallbackFaces.push_back(Face);
+		m_Generation++;
 		return true;
 	}
 
@@ -726,6 +763,7 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		m_Glyphs.clear();
+		m_Generation++;
 	}
 
 	const SGlyph *GetGlyph(int Chr, int FontSize)
@@ -772,6 +810,14 @@ public:
 		return nullptr;
 	}
 
+	void PrewarmGlyphs(int FontSize)
+	{
+		for(int Chr = ' '; Chr <= '~'; ++Chr)
+		{
+			GetGlyph(Chr, FontSize);
+		}
+	}
+
 	vec2 Kerning(const SGlyph *pLeft, const SGlyph *pRight) const
 	{
 		if(pLeft != nullptr && pRight != nullptr && pLeft->m_Face == pRight->m_Face && pLeft->m_FontSize == pRight->m_FontSize)
@@ -966,6 +1012,9 @@ class CTextRender : public IEngineTextRender
 	CGlyphMap *m_pGlyphMap;
 	std::vector<void *> m_vpFontData;
 
+	CTextLayoutCache m_LayoutCache;
+	unsigned m_LayoutCacheGeneration = 0;
+
 	std::vector<SFontLanguageVariant> m_vVariants;
 
 	unsigned m_RenderFlags;
@@ -1440,6 +1489,17 @@ public:
 		m_pGlyphMap->SetVariantFaceByName(nullptr);
 	}
 
+	void PrewarmGlyphs(const float *pFontSizes, size_t NumFontSizes) override
+	{
+		float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+		Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+		const float FakeToScreenY = Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0);
+		for(size_t i = 0; i < NumFontSizes; ++i)
+		{
+			m_pGlyphMap->PrewarmGlyphs(round_truncate(pFontSizes[i] * FakeToScreenY));
+		}
+	}
+
 	void SetCursor(CTextCursor *pCursor, float x, float y, float FontSize, int Flags) const override
 	{
 		pCursor->m_Flags = Flags;
@@ -1497,31 +1557,68 @@ public:
 		TextEx(&Cursor, pText, -1);
 	}
 
-	float TextWidth(float Size, const char *pText, int StrLength = -1, float LineWidth = -1.0f, int Flags = 0, const STextSizeProperties &TextSizeProps = {}) override
+	// Lays out text at the origin without rendering it, measurements of repeated
+	// inputs are served from the layout cache.
+	CTextLayoutCache::SLayout MeasureText(float Size, const char *pText, int StrLength, float LineWidth, float LineSpacing, int Flags)
 	{
+		const int Length = StrLength < 0 ? -1 : minimum(StrLength, str_length(pText));
+		const bool Cacheable = (Flags & TEXTFLAG_RENDER) == 0;
+
+		CTextLayoutCache::SKey Key;
+		if(Cacheable)
+		{
+			if(m_LayoutCacheGeneration != m_pGlyphMap->Generation())
+			{
+				m_LayoutCache.Clear();
+				m_LayoutCacheGeneration = m_pGlyphMap->Generation();
+			}
+
+			float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+			Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+			Key = {pText, Length, Size, LineWidth, LineSpacing, Flags, m_RenderFlags, m_pGlyphMap->SelectedFace(),
+				Graphics()->ScreenWidth() / (ScreenX1 - ScreenX0), Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0)};
+			if(const CTextLayoutCache::SLayout *pLayout = m_LayoutCache.Find(Key))
+				return *pLayout;
+		}
+
 		CTextCursor Cursor;
 		SetCursor(&Cursor, 0, 0, Size, Flags);
 		Cursor.m_LineWidth = LineWidth;
-		TextEx(&Cursor, pText, StrLength);
+		Cursor.m_LineSpacing = LineSpacing;
+		TextEx(&Cursor, pText, Length);
+		const CTextLayoutCache::SLayout Layout = {Cursor.m_LongestLineWidth, Cursor.Height(), Cursor.m_AlignedFontSize, Cursor.m_MaxCharacterHeight, Cursor.m_LineCount};
+
+		// laying out the text might have grown the atlas
+		if(Cacheable && m_LayoutCacheGeneration == m_pGlyphMap->Generation())
+			m_LayoutCache.Add(Key, Layout);
+		return Layout;
+	}
+
+	float TextWidth(float Size, const char *pText, int StrLength = -1, float LineWidth = -1.0f, int Flags = 0, const STextSizeProperties &TextSizeProps = {}) override
+	{
+		const CTextLayoutCache::SLayout Layout = MeasureText(Size, pText, StrLength, LineWidth, 0.0f, Flags);
 		if(TextSizeProps.m_pHeight != nullptr)
-			*TextSizeProps.m_pHeight = Cursor.Height();
+			*TextSizeProps.m_pHeight = Layout.m_Height;
 		if(TextSizeProps.m_pAlignedFontSize != nullptr)
-			*TextSizeProps.m_pAlignedFontSize = Cursor.m_AlignedFontSize;
+			*TextSizeProps.m_pAlignedFontSize = Layout.m_AlignedFontSize;
 		if(TextSizeProps.m_pMaxCharacterHeightInLine != nullptr)
-			*TextSizeProps.m_pMaxCharacterHeightInLine = Cursor.m_MaxCharacterHeight;
+			*TextSizeProps.m_pMaxCharacterHeightInLine = Layout.m_MaxCharacterHeight;
 		if(TextSizeProps.m_pLineCount != nullptr)
-			*TextSizeProps.m_pLineCount = Cursor.m_LineCount;
-		return Cursor.m_LongestLineWidth;
+			*TextSizeProps.m_pLineCount = Layout.m_LineCount;
+		return Layout.m_LongestLineWidth;
 	}
 
 	STextBoundingBox TextBoundingBox(float Size, const char *pText, int StrLength = -1, float LineWidth = -1.0f, float LineSpacing = 0.0f, int Flags = 0) override
 	{
-		CTextCursor Cursor;
-		SetCursor(&Cursor, 0, 0, Size, Flags);
-		Cursor.m_LineWidth = LineWidth;
-		Cursor.m_LineSpacing = LineSpacing;
-		TextEx(&Cursor, pText, StrLength);
-		return Cursor.BoundingBox();
+		const CTextLayoutCache::SLayout Layout = MeasureText(Size, pText, StrLength, LineWidth, LineSpacing, Flags);
+		return {0.0f, 0.0f, Layout.m_LongestLineWidth, Layout.m_Height};
+	}
+
+	void LayoutCacheStats(int *pEntries, int64_t *pHits, int64_t *pMisses) const override
+	{
+		*pEntries = m_LayoutCache.Size();
+		*pHits = m_LayoutCache.Hits();
+		*pMisses = m_LayoutCache.Misses();
 	}
 
 	void TextColor(float r, float g, float b, float a) override
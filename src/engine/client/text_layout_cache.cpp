@@ -0,0 +1,83 @@
+#include "text_layout_cache.h"
+
+#include <functional>
+
+bool CTextLayoutCache::SKey::operator==(const SKey &Other) const
+{
+	return m_Length == Other.m_Length &&
+	       m_FontSize == Other.m_FontSize &&
+	       m_LineWidth == Other.m_LineWidth &&
+	       m_LineSpacing == Other.m_LineSpacing &&
+	       m_Flags == Other.m_Flags &&
+	       m_RenderFlags == Other.m_RenderFlags &&
+	       m_pFace == Other.m_pFace &&
+	       m_ScaleX == Other.m_ScaleX &&
+	       m_ScaleY == Other.m_ScaleY &&
+	       m_Text == Other.m_Text;
+}
+
+size_t CTextLayoutCache::SKeyHash::operator()(const SKey &Key) const
+{
+	size_t Hash = std::hash<std::string>()(Key.m_Text);
+	const auto &&Combine = [&](size_t Value) {
+		Hash ^= Value + 0x9e3779b9 + (Hash << 6) + (Hash >> 2);
+	};
+	Combine(std::hash<int>()(Key.m_Length));
+	Combine(std::hash<float>()(Key.m_FontSize));
+	Combine(std::hash<float>()(Key.m_LineWidth));
+	Combine(std::hash<float>()(Key.m_LineSpacing));
+	Combine(std::hash<int>()(Key.m_Flags));
+	Combine(std::hash<unsigned>()(Key.m_RenderFlags));
+	Combine(std::hash<const void *>()(Key.m_pFace));
+	Combine(std::hash<float>()(Key.m_ScaleX));
+	Combine(std::hash<float>()(Key.m_ScaleY));
+	return Hash;
+}
+
+CTextLayoutCache::CTextLayoutCache(size_t MaxEntries) :
+	m_MaxEntries(MaxEntries),
+	m_Hits(0),
+	m_Misses(0)
+{
+}
+
+const CTextLayoutCache::SLayout *CTextLayoutCache::Find(const SKey &Key)
+{
+	auto It = m_Map.find(Key);
+	if(It == m_Map.end())
+	{
+		m_Misses++;
+		return nullptr;
+	}
+	m_Hits++;
+	m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+	return &It->second->second;
+}
+
+void CTextLayoutCache::Add(const SKey &Key, const SLayout &Layout)
+{
+	if(m_MaxEntries == 0)
+		return;
+
+	auto It = m_Map.find(Key);
+	if(It != m_Map.end())
+	{
+		It->second->second = Layout;
+		m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+		return;
+	}
+
+	if(m_Map.size() >= m_MaxEntries)
+	{
+		m_Map.erase(m_Entries.back().first);
+		m_Entries.pop_back();
+	}
+	m_Entries.emplace_front(Key, Layout);
+	m_Map.emplace(Key, m_Entries.begin());
+}
+
+void CTextLayoutCache::Clear()
+{
+	m_Map.clear();
+	m_Entries.clear();
+}
@@ -0,0 +1,84 @@
+#ifndef ENGINE_CLIENT_TEXT_LAYOUT_CACHE_H
+#define ENGINE_CLIENT_TEXT_LAYOUT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Least recently used cache of text measurements, so that UI code measuring
+ * the same strings every frame does not have to lay them out again.
+ *
+ * The key has to contain everything the layout depends on. The cache must be
+ * cleared when the fonts or the glyph atlas change.
+ */
+class CTextLayoutCache
+{
+public:
+	struct SKey
+	{
+		// the whole string, because the ellipsis depends on its full width
+		std::string m_Text;
+		int m_Length;
+		float m_FontSize;
+		float m_LineWidth;
+		float m_LineSpacing;
+		int m_Flags;
+		unsigned m_RenderFlags;
+		const void *m_pFace;
+		float m_ScaleX;
+		float m_ScaleY;
+
+		bool operator==(const SKey &Other) const;
+	};
+
+	struct SLayout
+	{
+		float m_LongestLineWidth;
+		float m_Height;
+		float m_AlignedFontSize;
+		float m_MaxCharacterHeight;
+		int m_LineCount;
+	};
+
+	enum
+	{
+		DEFAULT_MAX_ENTRIES = 2048,
+	};
+
+	CTextLayoutCache(size_t MaxEntries = DEFAULT_MAX_ENTRIES);
+
+	/**
+	 * Returns the cached layout and marks it as recently used, or `nullptr`
+	 * if the key is not cached.
+	 */
+	const SLayout *Find(const SKey &Key);
+	/**
+	 * Adds a layout, evicting the least recently used one if the cache is full.
+	 */
+	void Add(const SKey &Key, const SLayout &Layout);
+	void Clear();
+
+	size_t Size() const { return m_Map.size(); }
+	int64_t Hits() const { return m_Hits; }
+	int64_t Misses() const { return m_Misses; }
+
+private:
+	struct SKeyHash
+	{
+		size_t operator()(const SKey &Key) const;
+	};
+
+	typedef std::list<std::pair<SKey, SLayout>> TEntries;
+
+	size_t m_MaxEntries;
+	// most recently used first
+	TEntries m_Entries;
+	std::unordered_map<SKey, TEntries::iterator, SKeyHash> m_Map;
+	int64_t m_Hits;
+	int64_t m_Misses;
+};
+
+#endif
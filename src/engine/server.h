@@ -19,6 +19,7 @@
 #include <game/generated/protocolglue.h>
 
 struct CAntibotRoundData;
+class CTickProfiler;
 
 // When recording a demo on the server, the ClientId -1 is used
 enum
@@ -289,6 +290,8 @@ public:
 	virtual const char *GetMapName() const = 0;
 
 	virtual bool IsSixup(int ClientId) const = 0;
+
+	virtual CTickProfiler *TickProfiler() = 0;
 };
 
 class IGameServer : public IInterface
@@ -338,6 +341,18 @@ public:
 	virtual bool IsClientReady(int ClientId) const = 0;
 	virtual bool IsClientPlayer(int ClientId) const = 0;
 
+	enum
+	{
+		// clients with lower priorities get fewer snapshots first when the
+		// server is under load, see `sv_adaptive_snap_rate`
+		SNAP_PRIORITY_SPECTATOR,
+		SNAP_PRIORITY_AFK,
+		SNAP_PRIORITY_FAR,
+		SNAP_PRIORITY_NORMAL,
+		NUM_SNAP_PRIORITIES,
+	};
+	virtual int ClientSnapPriority(int ClientId) const = 0;
+
 	virtual int PersistentDataSize() const = 0;
 	virtual int PersistentClientDataSize() const = 0;
 
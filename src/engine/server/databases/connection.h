@@ -76,6 +76,14 @@ public:
 	// returns true on failure
 	virtual bool ExecuteUpdate(int *pNumUpdated, char *pError, int ErrorSize) = 0;
 
+	// the statements between begin and commit or rollback are executed in one
+	// transaction, connection has to be established
+	//
+	// returns true on failure
+	virtual bool BeginTransaction(char *pError, int ErrorSize) = 0;
+	virtual bool CommitTransaction(char *pError, int ErrorSize) = 0;
+	virtual bool RollbackTransaction(char *pError, int ErrorSize) = 0;
+
 	virtual bool IsNull(int Col) = 0;
 	virtual float GetFloat(int Col) = 0;
 	virtual int GetInt(int Col) = 0;
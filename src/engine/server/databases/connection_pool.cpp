@@ -2,6 +2,7 @@
 #include "connection.h"
 #include <engine/shared/config.h>
 
+#include <base/math.h>
 #include <base/system.h>
 #include <cstring>
 #include <engine/console.h>
@@ -65,6 +66,8 @@ struct CSqlExecData
 
 	std::unique_ptr<const ISqlData> m_pThreadData;
 	const char *m_pName;
+	std::chrono::nanoseconds m_EnqueueTime = time_get_nanoseconds();
+	int m_JobNum = 0;
 };
 
 CSqlExecData::CSqlExecData(
@@ -118,25 +121,73 @@ CSqlExecData::CSqlExecData(IConsole *pConsole, CDbConnectionPool::Mode m) :
 	m_Ptr.m_Print.m_Mode = m;
 }
 
-void CDbConnectionPool::Print(IConsole *pConsole, Mode DatabaseMode)
+void CDbConnectionPool::Enqueue(std::unique_ptr<CSqlExecData> pData)
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pConsole, DatabaseMode);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
+	if(pData->m_Mode == CSqlExecData::READ_ACCESS || pData->m_Mode == CSqlExecData::WRITE_ACCESS)
+	{
+		const bool Write = pData->m_Mode == CSqlExecData::WRITE_ACCESS;
+		m_pShared->m_aQueued[Write].fetch_add(1);
+		const int Depth = m_pShared->m_aQueued[0] + m_pShared->m_aQueued[1] - m_pShared->m_aCompleted[0] - m_pShared->m_aCompleted[1];
+		if(Depth > m_pShared->m_MaxQueueDepth)
+			m_pShared->m_MaxQueueDepth.store(Depth);
+	}
+	{
+		CLockScope LockScope(m_pShared->m_QueueLock);
+		m_pShared->m_BackupQueue.push_back(std::move(pData));
+	}
 	m_pShared->m_NumBackup.Signal();
 }
 
+void CDbConnectionPool::Print(IConsole *pConsole, Mode DatabaseMode)
+{
+	Enqueue(std::make_unique<CSqlExecData>(pConsole, DatabaseMode));
+}
+
+CDbConnectionPool::CStats CDbConnectionPool::Stats() const
+{
+	CStats Stats;
+	for(int Write = 0; Write < 2; Write++)
+	{
+		Stats.m_aQueued[Write] = m_pShared->m_aQueued[Write];
+		Stats.m_aCompleted[Write] = m_pShared->m_aCompleted[Write];
+		Stats.m_aFailed[Write] = m_pShared->m_aFailed[Write];
+		Stats.m_aTotalLatency[Write] = m_pShared->m_aTotalLatency[Write];
+		Stats.m_aMaxLatency[Write] = m_pShared->m_aMaxLatency[Write];
+	}
+	Stats.m_MaxQueueDepth = m_pShared->m_MaxQueueDepth;
+	Stats.m_Batches = m_pShared->m_Batches;
+	Stats.m_BatchedWrites = m_pShared->m_BatchedWrites;
+	return Stats;
+}
+
+void CDbConnectionPool::PrintStats(IConsole *pConsole) const
+{
+	const CStats Stats = this->Stats();
+	char aBuf[256];
+	for(int Write = 0; Write < 2; Write++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s queries: queued=%" PRId64 " completed=%" PRId64 " failed=%" PRId64 " depth=%" PRId64 " avg_latency=%" PRId64 "us max_latency=%" PRId64 "us",
+			Write ? "write" : "read", Stats.m_aQueued[Write], Stats.m_aCompleted[Write], Stats.m_aFailed[Write], Stats.QueueDepth(Write), Stats.AverageLatency(Write), Stats.m_aMaxLatency[Write]);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+	}
+	str_format(aBuf, sizeof(aBuf), "max_depth=%d read_workers=%d batches=%" PRId64 " batched_writes=%" PRId64,
+		Stats.m_MaxQueueDepth, m_pShared->m_NumReadWorkers.load(), Stats.m_Batches, Stats.m_BatchedWrites);
+	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+}
+
+void CDbConnectionPool::SetWriteBatchSize(int BatchSize)
+{
+	m_pShared->m_WriteBatchSize.store(maximum(BatchSize, 1));
+}
+
 void CDbConnectionPool::RegisterSqliteDatabase(Mode DatabaseMode, const char aFileName[64])
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(DatabaseMode, aFileName);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
-	m_pShared->m_NumBackup.Signal();
+	Enqueue(std::make_unique<CSqlExecData>(DatabaseMode, aFileName));
 }
 
 void CDbConnectionPool::RegisterMysqlDatabase(Mode DatabaseMode, const CMysqlConfig *pMysqlConfig)
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(DatabaseMode, pMysqlConfig);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
-	m_pShared->m_NumBackup.Signal();
+	Enqueue(std::make_unique<CSqlExecData>(DatabaseMode, pMysqlConfig));
 }
 
 void CDbConnectionPool::Execute(
@@ -144,9 +195,7 @@ void CDbConnectionPool::Execute(
 	std::unique_ptr<const ISqlData> pSqlRequestData,
 	const char *pName)
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
-	m_pShared->m_NumBackup.Signal();
+	Enqueue(std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName));
 }
 
 void CDbConnectionPool::ExecuteWrite(
@@ -154,9 +203,29 @@ void CDbConnectionPool::ExecuteWrite(
 	std::unique_ptr<const ISqlData> pSqlRequestData,
 	const char *pName)
 {
-	m_pShared->m_aQueries[m_InsertIdx++] = std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName);
-	m_InsertIdx %= std::size(m_pShared->m_aQueries);
-	m_pShared->m_NumBackup.Signal();
+	Enqueue(std::make_unique<CSqlExecData>(pFunc, std::move(pSqlRequestData), pName));
+}
+
+void CDbConnectionPool::CSharedData::Complete(CSqlExecData *pData, bool Success)
+{
+	if(pData->m_Mode == CSqlExecData::READ_ACCESS || pData->m_Mode == CSqlExecData::WRITE_ACCESS)
+	{
+		const bool Write = pData->m_Mode == CSqlExecData::WRITE_ACCESS;
+		const int64_t Latency = (time_get_nanoseconds() - pData->m_EnqueueTime).count() / 1000;
+		m_aTotalLatency[Write].fetch_add(Latency);
+		int64_t MaxLatency = m_aMaxLatency[Write].load();
+		while(Latency > MaxLatency && !m_aMaxLatency[Write].compare_exchange_weak(MaxLatency, Latency))
+		{
+		}
+		if(!Success)
+			m_aFailed[Write].fetch_add(1);
+		m_aCompleted[Write].fetch_add(1);
+	}
+	if(pData->m_pThreadData != nullptr && pData->m_pThreadData->m_pResult != nullptr)
+	{
+		pData->m_pThreadData->m_pResult->m_Success = Success;
+		pData->m_pThreadData->m_pResult->m_Completed.store(true);
+	}
 }
 
 void CDbConnectionPool::OnShutdown()
@@ -165,6 +234,10 @@ void CDbConnectionPool::OnShutdown()
 		return;
 	m_Shutdown = true;
 	m_pShared->m_Shutdown.store(true);
+	{
+		CLockScope LockScope(m_pShared->m_QueueLock);
+		m_pShared->m_BackupQueue.push_back(nullptr);
+	}
 	m_pShared->m_NumBackup.Signal();
 	int i = 0;
 	while(m_pShared->m_Shutdown.load())
@@ -195,6 +268,7 @@ private:
 	bool m_DebugSql;
 
 	void ProcessQueries();
+	void PassOn(std::unique_ptr<CSqlExecData> pThreadData);
 
 	std::unique_ptr<IDbConnection> m_pWriteBackup;
 
@@ -214,12 +288,17 @@ void CBackup::ProcessQueries()
 	for(int JobNum = 0;; JobNum++)
 	{
 		m_pShared->m_NumBackup.Wait();
-		CSqlExecData *pThreadData = m_pShared->m_aQueries[JobNum % std::size(m_pShared->m_aQueries)].get();
+		std::unique_ptr<CSqlExecData> pThreadData;
+		{
+			CLockScope LockScope(m_pShared->m_QueueLock);
+			pThreadData = std::move(m_pShared->m_BackupQueue.front());
+			m_pShared->m_BackupQueue.pop_front();
+		}
 
 		// work through all database jobs after OnShutdown is called before exiting the thread
 		if(pThreadData == nullptr)
 		{
-			m_pShared->m_NumWorker.Signal();
+			PassOn(nullptr);
 			return;
 		}
 
@@ -230,12 +309,50 @@ void CBackup::ProcessQueries()
 		}
 		else if(pThreadData->m_Mode == CSqlExecData::WRITE_ACCESS && m_pWriteBackup.get())
 		{
-			bool Success = CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData, Write::BACKUP_FIRST);
+			bool Success = CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData.get(), Write::BACKUP_FIRST);
 			if(m_DebugSql || !Success)
 				dbg_msg("sql", "[%i] %s done on write backup database, Success=%i", JobNum, pThreadData->m_pName, Success);
 		}
-		m_pShared->m_NumWorker.Signal();
+		PassOn(std::move(pThreadData));
+	}
+}
+
+void CBackup::PassOn(std::unique_ptr<CSqlExecData> pThreadData)
+{
+	{
+		CLockScope LockScope(m_pShared->m_QueueLock);
+		m_pShared->m_WorkerQueue.push_back(std::move(pThreadData));
+	}
+	m_pShared->m_NumWorker.Signal();
+}
+
+// Executes a read query on the first working read server, starting with the
+// last working one. Returns true on success.
+/* static */
+bool CDbConnectionPool::ExecReadAccess(const std::vector<std::unique_ptr<IDbConnection>> &vpReadConnections, int &ReadServer, CSqlExecData *pThreadData, bool Shutdown, bool FailMode, bool DebugSql)
+{
+	for(size_t i = 0; i < vpReadConnections.size(); i++)
+	{
+		if(Shutdown)
+		{
+			dbg_msg("sql", "[%i] %s dismissed read request during shutdown", pThreadData->m_JobNum, pThreadData->m_pName);
+			return false;
+		}
+		if(FailMode)
+		{
+			dbg_msg("sql", "[%i] %s dismissed read request during FailMode", pThreadData->m_JobNum, pThreadData->m_pName);
+			return false;
+		}
+		int CurServer = (ReadServer + i) % (int)vpReadConnections.size();
+		if(CDbConnectionPool::ExecSqlFunc(vpReadConnections[CurServer].get(), pThreadData, Write::NORMAL))
+		{
+			ReadServer = CurServer;
+			if(DebugSql)
+				dbg_msg("sql", "[%i] %s done on read database %d", pThreadData->m_JobNum, pThreadData->m_pName, CurServer);
+			return true;
+		}
 	}
+	return false;
 }
 
 // the worker threads executes queries on mysql or sqlite. If we write on
@@ -252,6 +369,10 @@ public:
 
 private:
 	void Print(IConsole *pConsole, CDbConnectionPool::Mode DatabaseMode);
+	std::unique_ptr<CSqlExecData> PopQuery();
+	// executes consecutive write queries, in one transaction if possible
+	void ProcessWrites(std::vector<std::unique_ptr<CSqlExecData>> &vpWrites, bool &FailMode);
+	void Complete(CSqlExecData *pThreadData, bool Success);
 
 	bool m_DebugSql;
 
@@ -278,6 +399,15 @@ void CWorker::Start(void *pUser)
 	delete pThis;
 }
 
+std::unique_ptr<CSqlExecData> CWorker::PopQuery()
+{
+	m_pShared->m_NumWorker.Wait();
+	CLockScope LockScope(m_pShared->m_QueueLock);
+	std::unique_ptr<CSqlExecData> pThreadData = std::move(m_pShared->m_WorkerQueue.front());
+	m_pShared->m_WorkerQueue.pop_front();
+	return pThreadData;
+}
+
 void CWorker::ProcessQueries()
 {
 	// remember last working server and try to connect to it first
@@ -291,41 +421,40 @@ void CWorker::ProcessQueries()
 		{
 			FailMode = false;
 		}
-		m_pShared->m_NumWorker.Wait();
-		auto pThreadData = std::move(m_pShared->m_aQueries[JobNum % std::size(m_pShared->m_aQueries)]);
+		auto pThreadData = PopQuery();
 		// work through all database jobs after OnShutdown is called before exiting the thread
 		if(pThreadData == nullptr)
 		{
+			const int NumReadWorkers = m_pShared->m_NumReadWorkers.load();
+			for(int i = 0; i < NumReadWorkers; i++)
+			{
+				{
+					CLockScope LockScope(m_pShared->m_QueueLock);
+					m_pShared->m_ReadQueue.push_back(nullptr);
+				}
+				m_pShared->m_NumRead.Signal();
+			}
+			for(int i = 0; i < NumReadWorkers; i++)
+				m_pShared->m_NumReadWorkersDone.Wait();
 			m_pShared->m_Shutdown.store(false);
 			return;
 		}
+		pThreadData->m_JobNum = JobNum;
 		bool Success = false;
 		switch(pThreadData->m_Mode)
 		{
 		case CSqlExecData::READ_ACCESS:
 		{
-			for(size_t i = 0; i < m_vpReadConnections.size(); i++)
+			if(m_pShared->m_NumReadWorkers > 0)
 			{
-				if(m_pShared->m_Shutdown)
 				{
-					dbg_msg("sql", "[%i] %s dismissed read request during shutdown", JobNum, pThreadData->m_pName);
-					break;
-				}
-				if(FailMode)
-				{
-					dbg_msg("sql", "[%i] %s dismissed read request during FailMode", JobNum, pThreadData->m_pName);
-					break;
-				}
-				int CurServer = (ReadServer + i) % (int)m_vpReadConnections.size();
-				if(CDbConnectionPool::ExecSqlFunc(m_vpReadConnections[CurServer].get(), pThreadData.get(), Write::NORMAL))
-				{
-					ReadServer = CurServer;
-					if(m_DebugSql)
-						dbg_msg("sql", "[%i] %s done on read database %d", JobNum, pThreadData->m_pName, CurServer);
-					Success = true;
-					break;
+					CLockScope LockScope(m_pShared->m_QueueLock);
+					m_pShared->m_ReadQueue.push_back(std::move(pThreadData));
 				}
+				m_pShared->m_NumRead.Signal();
+				continue;
 			}
+			Success = CDbConnectionPool::ExecReadAccess(m_vpReadConnections, ReadServer, pThreadData.get(), m_pShared->m_Shutdown, FailMode, m_DebugSql);
 			if(!Success)
 			{
 				FailMode = true;
@@ -334,64 +463,49 @@ void CWorker::ProcessQueries()
 		break;
 		case CSqlExecData::WRITE_ACCESS:
 		{
-			if(m_pShared->m_Shutdown && m_pWriteBackup != nullptr)
+			std::vector<std::unique_ptr<CSqlExecData>> vpWrites;
+			vpWrites.push_back(std::move(pThreadData));
+			// take the directly following write queries, this thread is the
+			// only one waiting on the semaphore, so they can't be taken away
+			const int BatchSize = m_pShared->m_WriteBatchSize.load();
+			while((int)vpWrites.size() < BatchSize && !m_pShared->m_Shutdown && !FailMode && m_pShared->m_NumWorker.GetApproximateValue() > 0)
 			{
-				dbg_msg("sql", "[%i] %s skipped to backup database during shutdown", JobNum, pThreadData->m_pName);
-			}
-			else if(FailMode && m_pWriteBackup != nullptr)
-			{
-				dbg_msg("sql", "[%i] %s skipped to backup database during FailMode", JobNum, pThreadData->m_pName);
-			}
-			else if(CDbConnectionPool::ExecSqlFunc(m_pWriteConnection.get(), pThreadData.get(), Write::NORMAL))
-			{
-				if(m_DebugSql)
-					dbg_msg("sql", "[%i] %s done on write database", JobNum, pThreadData->m_pName);
-				Success = true;
-			}
-			// enter fail mode if not successful
-			FailMode = FailMode || !Success;
-			const Write w = Success ? Write::NORMAL_SUCCEEDED : Write::NORMAL_FAILED;
-			if(m_pWriteBackup && CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData.get(), w))
-			{
-				if(m_DebugSql)
-					dbg_msg("sql", "[%i] %s done move write on backup database to non-backup table", JobNum, pThreadData->m_pName);
-				Success = true;
+				{
+					CLockScope LockScope(m_pShared->m_QueueLock);
+					const CSqlExecData *pNext = m_pShared->m_WorkerQueue.front().get();
+					if(pNext == nullptr || pNext->m_Mode != CSqlExecData::WRITE_ACCESS)
+						break;
+				}
+				vpWrites.push_back(PopQuery());
+				vpWrites.back()->m_JobNum = ++JobNum;
 			}
+			ProcessWrites(vpWrites, FailMode);
+			continue;
 		}
-		break;
 		case CSqlExecData::ADD_MYSQL:
-		{
-			auto pMysql = CreateMysqlConnection(pThreadData->m_Ptr.m_Mysql.m_Config);
-			switch(pThreadData->m_Ptr.m_Mysql.m_Mode)
-			{
-			case CDbConnectionPool::Mode::READ:
-				m_vpReadConnections.push_back(std::move(pMysql));
-				break;
-			case CDbConnectionPool::Mode::WRITE:
-				m_pWriteConnection = std::move(pMysql);
-				break;
-			case CDbConnectionPool::Mode::WRITE_BACKUP:
-				m_pWriteBackup = std::move(pMysql);
-				break;
-			case CDbConnectionPool::Mode::NUM_MODES:
-				break;
-			}
-			Success = true;
-			break;
-		}
 		case CSqlExecData::ADD_SQLITE:
 		{
-			auto pSqlite = CreateSqliteConnection(pThreadData->m_Ptr.m_Sqlite.m_FileName, true);
-			switch(pThreadData->m_Ptr.m_Sqlite.m_Mode)
+			const bool Mysql = pThreadData->m_Mode == CSqlExecData::ADD_MYSQL;
+			const CDbConnectionPool::Mode Mode = Mysql ? pThreadData->m_Ptr.m_Mysql.m_Mode : pThreadData->m_Ptr.m_Sqlite.m_Mode;
+			auto pConnection = CDbConnectionPool::CreateConnection(pThreadData.get());
+			switch(Mode)
 			{
 			case CDbConnectionPool::Mode::READ:
-				m_vpReadConnections.push_back(std::move(pSqlite));
+			{
+				m_vpReadConnections.push_back(std::move(pConnection));
+				// the read workers create their own connections
+				CLockScope LockScope(m_pShared->m_QueueLock);
+				if(Mysql)
+					m_pShared->m_vpReadServers.push_back(std::make_unique<CSqlExecData>(Mode, &pThreadData->m_Ptr.m_Mysql.m_Config));
+				else
+					m_pShared->m_vpReadServers.push_back(std::make_unique<CSqlExecData>(Mode, pThreadData->m_Ptr.m_Sqlite.m_FileName));
 				break;
+			}
 			case CDbConnectionPool::Mode::WRITE:
-				m_pWriteConnection = std::move(pSqlite);
+				m_pWriteConnection = std::move(pConnection);
 				break;
 			case CDbConnectionPool::Mode::WRITE_BACKUP:
-				m_pWriteBackup = std::move(pSqlite);
+				m_pWriteBackup = std::move(pConnection);
 				break;
 			case CDbConnectionPool::Mode::NUM_MODES:
 				break;
@@ -404,13 +518,127 @@ void CWorker::ProcessQueries()
 			Success = true;
 			break;
 		}
+		Complete(pThreadData.get(), Success);
+	}
+}
+
+void CWorker::ProcessWrites(std::vector<std::unique_ptr<CSqlExecData>> &vpWrites, bool &FailMode)
+{
+	bool BatchSuccess = false;
+	if(vpWrites.size() > 1)
+	{
+		BatchSuccess = CDbConnectionPool::ExecSqlFuncs(m_pWriteConnection.get(), vpWrites.data(), vpWrites.size());
+		if(BatchSuccess)
+		{
+			m_pShared->m_Batches.fetch_add(1);
+			m_pShared->m_BatchedWrites.fetch_add(vpWrites.size());
+			if(m_DebugSql)
+				dbg_msg("sql", "[%i-%i] %d writes done in one transaction on write database", vpWrites.front()->m_JobNum, vpWrites.back()->m_JobNum, (int)vpWrites.size());
+		}
+		else
+		{
+			dbg_msg("sql", "[%i-%i] transaction failed, executing the writes one by one", vpWrites.front()->m_JobNum, vpWrites.back()->m_JobNum);
+		}
+	}
+
+	for(auto &pThreadData : vpWrites)
+	{
+		const int JobNum = pThreadData->m_JobNum;
+		bool Success = BatchSuccess;
+		if(!BatchSuccess)
+		{
+			if(m_pShared->m_Shutdown && m_pWriteBackup != nullptr)
+			{
+				dbg_msg("sql", "[%i] %s skipped to backup database during shutdown", JobNum, pThreadData->m_pName);
+			}
+			else if(FailMode && m_pWriteBackup != nullptr)
+			{
+				dbg_msg("sql", "[%i] %s skipped to backup database during FailMode", JobNum, pThreadData->m_pName);
+			}
+			else if(CDbConnectionPool::ExecSqlFunc(m_pWriteConnection.get(), pThreadData.get(), Write::NORMAL))
+			{
+				if(m_DebugSql)
+					dbg_msg("sql", "[%i] %s done on write database", JobNum, pThreadData->m_pName);
+				Success = true;
+			}
+			// enter fail mode if not successful
+			FailMode = FailMode || !Success;
+		}
+		const Write w = Success ? Write::NORMAL_SUCCEEDED : Write::NORMAL_FAILED;
+		if(m_pWriteBackup && CDbConnectionPool::ExecSqlFunc(m_pWriteBackup.get(), pThreadData.get(), w))
+		{
+			if(m_DebugSql)
+				dbg_msg("sql", "[%i] %s done move write on backup database to non-backup table", JobNum, pThreadData->m_pName);
+			Success = true;
+		}
+		Complete(pThreadData.get(), Success);
+	}
+}
+
+void CWorker::Complete(CSqlExecData *pThreadData, bool Success)
+{
+	if(!Success)
+		dbg_msg("sql", "[%i] %s failed on all databases", pThreadData->m_JobNum, pThreadData->m_pName);
+	m_pShared->Complete(pThreadData, Success);
+}
+
+// Read workers execute read queries on their own connections to the read
+// servers, so slow reads don't hold up each other or the write queries.
+class CReadWorker
+{
+public:
+	CReadWorker(std::shared_ptr<CDbConnectionPool::CSharedData> pShared, int DebugSql) :
+		m_DebugSql(DebugSql), m_pShared(std::move(pShared)) {}
+	static void Start(void *pUser);
+
+private:
+	void ProcessQueries();
+
+	bool m_DebugSql;
+	std::vector<std::unique_ptr<IDbConnection>> m_vpReadConnections;
+	std::shared_ptr<CDbConnectionPool::CSharedData> m_pShared;
+};
+
+/* static */
+void CReadWorker::Start(void *pUser)
+{
+	CReadWorker *pThis = (CReadWorker *)pUser;
+	pThis->ProcessQueries();
+	delete pThis;
+}
+
+void CReadWorker::ProcessQueries()
+{
+	int ReadServer = 0;
+	bool FailMode = false;
+	while(true)
+	{
+		if(FailMode && m_pShared->m_NumRead.GetApproximateValue() == 0)
+		{
+			FailMode = false;
+		}
+		m_pShared->m_NumRead.Wait();
+		std::unique_ptr<CSqlExecData> pThreadData;
+		{
+			CLockScope LockScope(m_pShared->m_QueueLock);
+			pThreadData = std::move(m_pShared->m_ReadQueue.front());
+			m_pShared->m_ReadQueue.pop_front();
+			// connect to the read servers added since the last query
+			for(size_t i = m_vpReadConnections.size(); i < m_pShared->m_vpReadServers.size(); i++)
+				m_vpReadConnections.push_back(CDbConnectionPool::CreateConnection(m_pShared->m_vpReadServers[i].get()));
+		}
+		if(pThreadData == nullptr)
+		{
+			m_pShared->m_NumReadWorkersDone.Signal();
+			return;
+		}
+		bool Success = CDbConnectionPool::ExecReadAccess(m_vpReadConnections, ReadServer, pThreadData.get(), m_pShared->m_Shutdown, FailMode, m_DebugSql);
 		if(!Success)
-			dbg_msg("sql", "[%i] %s failed on all databases", JobNum, pThreadData->m_pName);
-		if(pThreadData->m_pThreadData != nullptr && pThreadData->m_pThreadData->m_pResult != nullptr)
 		{
-			pThreadData->m_pThreadData->m_pResult->m_Success = Success;
-			pThreadData->m_pThreadData->m_pResult->m_Completed.store(true);
+			FailMode = true;
+			dbg_msg("sql", "[%i] %s failed on all databases", pThreadData->m_JobNum, pThreadData->m_pName);
 		}
+		m_pShared->Complete(pThreadData.get(), Success);
 	}
 }
 
@@ -473,6 +701,51 @@ bool CDbConnectionPool::ExecSqlFunc(IDbConnection *pConnection, CSqlExecData *pD
 	return Success;
 }
 
+/* static */
+bool CDbConnectionPool::ExecSqlFuncs(IDbConnection *pConnection, std::unique_ptr<CSqlExecData> *ppData, int NumData)
+{
+	if(pConnection == nullptr)
+	{
+		dbg_msg("sql", "No database given");
+		return false;
+	}
+	char aError[256] = "unknown error";
+	if(pConnection->Connect(aError, sizeof(aError)))
+	{
+		dbg_msg("sql", "failed connecting to db: %s", aError);
+		return false;
+	}
+	bool Success = !pConnection->BeginTransaction(aError, sizeof(aError));
+	for(int i = 0; i < NumData && Success; i++)
+	{
+		dbg_assert(ppData[i]->m_Mode == CSqlExecData::WRITE_ACCESS, "only write queries can be batched");
+		Success = !ppData[i]->m_Ptr.m_pWriteFunc(pConnection, ppData[i]->m_pThreadData.get(), Write::NORMAL, aError, sizeof(aError));
+		if(!Success)
+			dbg_msg("sql", "%s failed: %s", ppData[i]->m_pName, aError);
+	}
+	if(Success)
+	{
+		Success = !pConnection->CommitTransaction(aError, sizeof(aError));
+		if(!Success)
+			dbg_msg("sql", "commit failed: %s", aError);
+	}
+	if(!Success && pConnection->RollbackTransaction(aError, sizeof(aError)))
+	{
+		dbg_msg("sql", "rollback failed: %s", aError);
+	}
+	pConnection->Disconnect();
+	return Success;
+}
+
+/* static */
+std::unique_ptr<IDbConnection> CDbConnectionPool::CreateConnection(const CSqlExecData *pData)
+{
+	if(pData->m_Mode == CSqlExecData::ADD_MYSQL)
+		return CreateMysqlConnection(pData->m_Ptr.m_Mysql.m_Config);
+	dbg_assert(pData->m_Mode == CSqlExecData::ADD_SQLITE, "no database to add");
+	return CreateSqliteConnection(pData->m_Ptr.m_Sqlite.m_FileName, true);
+}
+
 CDbConnectionPool::CDbConnectionPool()
 {
 	m_pShared = std::make_shared<CSharedData>();
@@ -480,6 +753,15 @@ CDbConnectionPool::CDbConnectionPool()
 	m_pBackupThread = thread_init(CBackup::Start, new CBackup(m_pShared, g_Config.m_DbgSql), "database backup worker thread");
 }
 
+void CDbConnectionPool::SetNumReadWorkers(int NumWorkers)
+{
+	if(!m_vpReadWorkerThreads.empty() || m_Shutdown)
+		return;
+	for(int i = 0; i < NumWorkers; i++)
+		m_vpReadWorkerThreads.push_back(thread_init(CReadWorker::Start, new CReadWorker(m_pShared, g_Config.m_DbgSql), "database read worker thread"));
+	m_pShared->m_NumReadWorkers.store(NumWorkers);
+}
+
 CDbConnectionPool::~CDbConnectionPool()
 {
 	OnShutdown();
@@ -487,4 +769,6 @@ CDbConnectionPool::~CDbConnectionPool()
 		thread_wait(m_pWorkerThread);
 	if(m_pBackupThread)
 		thread_wait(m_pBackupThread);
+	for(void *pThread : m_vpReadWorkerThreads)
+		thread_wait(pThread);
 }
@@ -2,7 +2,9 @@
 #define ENGINE_SERVER_DATABASES_CONNECTION_POOL_H
 
 #include <atomic>
+#include <base/lock.h>
 #include <base/tl/threading.h>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -76,7 +78,36 @@ public:
 		NUM_MODES,
 	};
 
+	// Queue statistics since the creation of the pool, latencies are measured
+	// from adding the query to the queue until its completion in microseconds.
+	struct CStats
+	{
+		int64_t m_aQueued[2];
+		int64_t m_aCompleted[2];
+		int64_t m_aFailed[2];
+		int64_t m_aTotalLatency[2];
+		int64_t m_aMaxLatency[2];
+		int m_MaxQueueDepth;
+		// number of transactions with more than one write and the writes in them
+		int64_t m_Batches;
+		int64_t m_BatchedWrites;
+
+		int64_t QueueDepth(bool Write) const { return m_aQueued[Write] - m_aCompleted[Write]; }
+		int64_t AverageLatency(bool Write) const { return m_aCompleted[Write] ? m_aTotalLatency[Write] / m_aCompleted[Write] : 0; }
+	};
+
 	void Print(IConsole *pConsole, Mode DatabaseMode);
+	CStats Stats() const;
+	void PrintStats(IConsole *pConsole) const;
+
+	// Runs read queries on `NumWorkers` separate threads with their own
+	// connections to the read servers instead of the write worker thread.
+	// Read queries may then complete before earlier write queries. Can
+	// only be set once, before the first query.
+	void SetNumReadWorkers(int NumWorkers);
+	// Maximum number of queued write queries that are executed in one
+	// transaction on the write server.
+	void SetWriteBatchSize(int BatchSize);
 
 	void RegisterSqliteDatabase(Mode DatabaseMode, const char FileName[64]);
 	void RegisterMysqlDatabase(Mode DatabaseMode, const CMysqlConfig *pMysqlConfig);
@@ -96,13 +127,15 @@ public:
 
 	friend class CWorker;
 	friend class CBackup;
+	friend class CReadWorker;
 
 private:
 	static bool ExecSqlFunc(IDbConnection *pConnection, struct CSqlExecData *pData, Write w);
+	static bool ExecReadAccess(const std::vector<std::unique_ptr<IDbConnection>> &vpReadConnections, int &ReadServer, struct CSqlExecData *pData, bool Shutdown, bool FailMode, bool DebugSql);
+	static bool ExecSqlFuncs(IDbConnection *pConnection, std::unique_ptr<struct CSqlExecData> *ppData, int NumData);
+	static std::unique_ptr<IDbConnection> CreateConnection(const struct CSqlExecData *pData);
 
-	// Only the main thread accesses this variable. It points to the index,
-	// where the next query is added to the queue.
-	int m_InsertIdx = 0;
+	void Enqueue(std::unique_ptr<struct CSqlExecData> pData);
 
 	bool m_Shutdown = false;
 
@@ -120,14 +153,43 @@ private:
 		// When the backup thread processed the query, it signals the main
 		// thread with this semaphore about the new query
 		CSemaphore m_NumWorker;
-
-		// spsc queue with additional backup worker to look at queries first.
-		std::unique_ptr<struct CSqlExecData> m_aQueries[512];
+		// The worker thread passes read queries on to the read workers, if
+		// there are any.
+		CSemaphore m_NumRead;
+		// Read workers signal that they exited after receiving the shutdown.
+		CSemaphore m_NumReadWorkersDone;
+
+		// Queries pass from the main thread through the backup thread to the
+		// worker thread and possibly a read worker. A nullptr signals the
+		// shutdown.
+		CLock m_QueueLock;
+		std::deque<std::unique_ptr<struct CSqlExecData>> m_BackupQueue GUARDED_BY(m_QueueLock);
+		std::deque<std::unique_ptr<struct CSqlExecData>> m_WorkerQueue GUARDED_BY(m_QueueLock);
+		std::deque<std::unique_ptr<struct CSqlExecData>> m_ReadQueue GUARDED_BY(m_QueueLock);
+		// Read servers the read workers connect to. Read workers compare their
+		// number with the number of connections they already have.
+		std::vector<std::unique_ptr<struct CSqlExecData>> m_vpReadServers GUARDED_BY(m_QueueLock);
+
+		std::atomic_int m_NumReadWorkers{0};
+		std::atomic_int m_WriteBatchSize{1};
+
+		// index 0 for read queries and 1 for write queries
+		std::atomic<int64_t> m_aQueued[2] = {0, 0};
+		std::atomic<int64_t> m_aCompleted[2] = {0, 0};
+		std::atomic<int64_t> m_aFailed[2] = {0, 0};
+		std::atomic<int64_t> m_aTotalLatency[2] = {0, 0};
+		std::atomic<int64_t> m_aMaxLatency[2] = {0, 0};
+		std::atomic_int m_MaxQueueDepth{0};
+		std::atomic<int64_t> m_Batches{0};
+		std::atomic<int64_t> m_BatchedWrites{0};
+
+		void Complete(struct CSqlExecData *pData, bool Success);
 	};
 
 	std::shared_ptr<CSharedData> m_pShared;
 	void *m_pWorkerThread = nullptr;
 	void *m_pBackupThread = nullptr;
+	std::vector<void *> m_vpReadWorkerThreads;
 };
 
 #endif // ENGINE_SERVER_DATABASES_CONNECTION_POOL_H
@@ -95,6 +95,10 @@ public:
 	bool Step(bool *pEnd, char *pError, int ErrorSize) override;
 	bool ExecuteUpdate(int *pNumUpdated, char *pError, int ErrorSize) override;
 
+	bool BeginTransaction(char *pError, int ErrorSize) override;
+	bool CommitTransaction(char *pError, int ErrorSize) override;
+	bool RollbackTransaction(char *pError, int ErrorSize) override;
+
 	bool IsNull(int Col) override;
 	float GetFloat(int Col) override;
 	int GetInt(int Col) override;
@@ -496,6 +500,53 @@ bool CMysqlConnection::ExecuteUpdate(int *pNumUpdated, char *pError, int ErrorSi
 	return true;
 }
 
+bool CMysqlConnection::BeginTransaction(char *pError, int ErrorSize)
+{
+	if(mysql_autocommit(&m_Mysql, false))
+	{
+		StoreErrorMysql("autocommit");
+		str_copy(pError, m_aErrorDetail, ErrorSize);
+		return true;
+	}
+	return false;
+}
+
+bool CMysqlConnection::CommitTransaction(char *pError, int ErrorSize)
+{
+	if(mysql_commit(&m_Mysql))
+	{
+		StoreErrorMysql("commit");
+		str_copy(pError, m_aErrorDetail, ErrorSize);
+		return true;
+	}
+	if(mysql_autocommit(&m_Mysql, true))
+	{
+		StoreErrorMysql("autocommit");
+		str_copy(pError, m_aErrorDetail, ErrorSize);
+		return true;
+	}
+	return false;
+}
+
+bool CMysqlConnection::RollbackTransaction(char *pError, int ErrorSize)
+{
+	bool Failed = false;
+	if(mysql_rollback(&m_Mysql))
+	{
+		StoreErrorMysql("rollback");
+		str_copy(pError, m_aErrorDetail, ErrorSize);
+		Failed = true;
+	}
+	// always leave the connection in autocommit mode for the next user
+	if(mysql_autocommit(&m_Mysql, true) && !Failed)
+	{
+		StoreErrorMysql("autocommit");
+		str_copy(pError, m_aErrorDetail, ErrorSize);
+		Failed = true;
+	}
+	return Failed;
+}
+
 bool CMysqlConnection::IsNull(int Col)
 {
 	Col -= 1;
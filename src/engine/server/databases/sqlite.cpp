@@ -6,6 +6,8 @@
 #include <engine/console.h>
 
 #include <atomic>
+#include <string>
+#include <unordered_map>
 
 class CSqliteConnection : public IDbConnection
 {
@@ -43,6 +45,10 @@ public:
 	bool Step(bool *pEnd, char *pError, int ErrorSize) override;
 	bool ExecuteUpdate(int *pNumUpdated, char *pError, int ErrorSize) override;
 
+	bool BeginTransaction(char *pError, int ErrorSize) override;
+	bool CommitTransaction(char *pError, int ErrorSize) override;
+	bool RollbackTransaction(char *pError, int ErrorSize) override;
+
 	bool IsNull(int Col) override;
 	float GetFloat(int Col) override;
 	int GetInt(int Col) override;
@@ -61,9 +67,19 @@ private:
 	char m_aFilename[IO_MAX_PATH_LENGTH];
 	bool m_Setup;
 
+	enum
+	{
+		MAX_CACHED_STATEMENTS = 128,
+	};
+
 	sqlite3 *m_pDb;
+	// points into the statement cache
 	sqlite3_stmt *m_pStmt;
+	// prepared statements by their sql text, reset and reused when the same
+	// statement is prepared again
+	std::unordered_map<std::string, sqlite3_stmt *> m_StatementCache;
 	bool m_Done; // no more rows available for Step
+	void ClearStatementCache();
 	// returns false, if the query succeeded
 	bool Execute(const char *pQuery, char *pError, int ErrorSize);
 	// returns true on failure
@@ -89,12 +105,19 @@ CSqliteConnection::CSqliteConnection(const char *pFilename, bool Setup) :
 
 CSqliteConnection::~CSqliteConnection()
 {
-	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
+	ClearStatementCache();
 	sqlite3_close(m_pDb);
 	m_pDb = nullptr;
 }
 
+void CSqliteConnection::ClearStatementCache()
+{
+	for(auto &[Stmt, pStmt] : m_StatementCache)
+		sqlite3_finalize(pStmt);
+	m_StatementCache.clear();
+	m_pStmt = nullptr;
+}
+
 void CSqliteConnection::Print(IConsole *pConsole, const char *pMode)
 {
 	char aBuf[512];
@@ -182,8 +205,9 @@ bool CSqliteConnection::ConnectImpl(char *pError, int ErrorSize)
 
 void CSqliteConnection::Disconnect()
 {
+	// resetting releases the locks held by an unfinished statement
 	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
+		sqlite3_reset(m_pStmt);
 	m_pStmt = nullptr;
 	m_InUse.store(false);
 }
@@ -191,18 +215,34 @@ void CSqliteConnection::Disconnect()
 bool CSqliteConnection::PrepareStatement(const char *pStmt, char *pError, int ErrorSize)
 {
 	if(m_pStmt != nullptr)
-		sqlite3_finalize(m_pStmt);
+		sqlite3_reset(m_pStmt);
 	m_pStmt = nullptr;
+
+	auto Cached = m_StatementCache.find(pStmt);
+	if(Cached != m_StatementCache.end())
+	{
+		m_pStmt = Cached->second;
+		sqlite3_clear_bindings(m_pStmt);
+		m_Done = false;
+		return false;
+	}
+
+	if(m_StatementCache.size() >= MAX_CACHED_STATEMENTS)
+		ClearStatementCache();
+	sqlite3_stmt *pNewStmt = nullptr;
 	int Result = sqlite3_prepare_v2(
 		m_pDb,
 		pStmt,
 		-1, // pStmt can be any length
-		&m_pStmt,
+		&pNewStmt,
 		NULL);
 	if(FormatError(Result, pError, ErrorSize))
 	{
+		sqlite3_finalize(pNewStmt);
 		return true;
 	}
+	m_StatementCache.emplace(pStmt, pNewStmt);
+	m_pStmt = pNewStmt;
 	m_Done = false;
 	return false;
 }
@@ -310,6 +350,26 @@ bool CSqliteConnection::ExecuteUpdate(int *pNumUpdated, char *pError, int ErrorS
 	return false;
 }
 
+bool CSqliteConnection::BeginTransaction(char *pError, int ErrorSize)
+{
+	// take the write lock right away instead of failing to upgrade a read lock later
+	return Execute("BEGIN IMMEDIATE", pError, ErrorSize);
+}
+
+bool CSqliteConnection::CommitTransaction(char *pError, int ErrorSize)
+{
+	if(m_pStmt != nullptr)
+		sqlite3_reset(m_pStmt);
+	return Execute("COMMIT", pError, ErrorSize);
+}
+
+bool CSqliteConnection::RollbackTransaction(char *pError, int ErrorSize)
+{
+	if(m_pStmt != nullptr)
+		sqlite3_reset(m_pStmt);
+	return Execute("ROLLBACK", pError, ErrorSize);
+}
+
 bool CSqliteConnection::IsNull(int Col)
 {
 	return sqlite3_column_type(m_pStmt, Col - 1) == SQLITE_NULL;
@@ -70,6 +70,9 @@ int main(int argc, const char **argv)
 	CWindowsComLifecycle WindowsComLifecycle(false);
 #endif
 
+	// stdout and the log file can be written from a separate thread, the
+	// other loggers need to stay on the threads that log
+	std::vector<std::shared_ptr<ILogger>> vpIoLoggers;
 	std::vector<std::shared_ptr<ILogger>> vpLoggers;
 	std::shared_ptr<ILogger> pStdoutLogger;
 #if defined(CONF_PLATFORM_ANDROID)
@@ -82,10 +85,12 @@ int main(int argc, const char **argv)
 #endif
 	if(pStdoutLogger)
 	{
-		vpLoggers.push_back(pStdoutLogger);
+		vpIoLoggers.push_back(pStdoutLogger);
 	}
 	std::shared_ptr<CFutureLogger> pFutureFileLogger = std::make_shared<CFutureLogger>();
-	vpLoggers.push_back(pFutureFileLogger);
+	vpIoLoggers.push_back(pFutureFileLogger);
+	std::shared_ptr<CThreadedLogger> pThreadedLogger = std::make_shared<CThreadedLogger>(log_logger_collection(std::move(vpIoLoggers)));
+	vpLoggers.push_back(pThreadedLogger);
 	std::shared_ptr<CFutureLogger> pFutureConsoleLogger = std::make_shared<CFutureLogger>();
 	vpLoggers.push_back(pFutureConsoleLogger);
 	std::shared_ptr<CFutureLogger> pFutureAssertionLogger = std::make_shared<CFutureLogger>();
@@ -111,7 +116,7 @@ int main(int argc, const char **argv)
 #endif
 
 	CServer *pServer = CreateServer();
-	pServer->SetLoggers(pFutureFileLogger, std::move(pStdoutLogger));
+	pServer->SetLoggers(pFutureFileLogger, std::move(pStdoutLogger), std::move(pThreadedLogger));
 
 	IKernel *pKernel = IKernel::Create();
 	pKernel->RegisterInterface(pServer);
@@ -269,6 +269,18 @@ CServer::CServer()
 
 	m_aErrorShutdownReason[0] = 0;
 
+	m_TickPhaseTotal = m_TickProfiler.RegisterPhase("total");
+	m_TickPhaseNetwork = m_TickProfiler.RegisterPhase("network");
+	m_TickPhaseGame = m_TickProfiler.RegisterPhase("game");
+	m_TickPhaseSnapshot = m_TickProfiler.RegisterPhase("snapshot");
+	m_TickPhaseSnapshotBuild = m_TickProfiler.RegisterPhase("snapshot_build");
+	m_TickPhaseSnapshotDelta = m_TickProfiler.RegisterPhase("snapshot_delta");
+	m_TickPhaseSnapshotCompress = m_TickProfiler.RegisterPhase("snapshot_compress");
+	m_TickPhaseSnapshotSend = m_TickProfiler.RegisterPhase("snapshot_send");
+	m_LastTickProfilerReport = 0;
+	m_LastSnapshotStatsReport = 0;
+	std::fill(std::begin(m_aAdaptiveSnapPriorities), std::end(m_aAdaptiveSnapPriorities), (int)IGameServer::SNAP_PRIORITY_NORMAL);
+
 	Init();
 }
 
@@ -931,15 +943,25 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
-		{
-			m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
-
-			GameServer()->OnSnap(i);
+		if(SkipAdaptiveSnapshot(i))
+			continue;
 
-			// finish snapshot
+		{
 			char aData[CSnapshot::MAX_SIZE];
 			CSnapshot *pData = (CSnapshot *)aData; // Fix compiler warning for strict-aliasing
-			int SnapshotSize = m_SnapshotBuilder.Finish(pData);
+			int SnapshotSize;
+			{
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshotBuild);
+				m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
+
+				GameServer()->OnSnap(i);
+
+				// finish snapshot
+				SnapshotSize = m_SnapshotBuilder.Finish(pData);
+			}
+
+			if(Config()->m_SvSnapshotStats)
+				m_SnapshotStats.AddSnapshot(i, m_aClients[i].m_Sixup, pData, SnapshotSize);
 
 			if(m_aDemoRecorder[i].IsRecording())
 			{
@@ -975,7 +997,11 @@ void CServer::DoSnapshot()
 			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
 			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
 			char aDeltaData[CSnapshot::MAX_SIZE];
-			int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+			int DeltaSize;
+			{
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshotDelta);
+				DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+			}
 
 			if(DeltaSize)
 			{
@@ -983,9 +1009,16 @@ void CServer::DoSnapshot()
 				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
 
 				char aCompData[CSnapshot::MAX_SIZE];
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshotCompress);
+					SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
+				}
 				int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+				if(Config()->m_SvSnapshotStats)
+					m_SnapshotStats.AddDelta(i, DeltaSize, SnapshotSize, NumPackets);
+				m_AdaptiveSnapRate.AddSnapshotBytes(SnapshotSize);
 
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshotSend);
 				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
 				{
 					int Chunk = Left < MaxSize ? Left : MaxSize;
@@ -1017,6 +1050,9 @@ void CServer::DoSnapshot()
 			}
 			else
 			{
+				if(Config()->m_SvSnapshotStats)
+					m_SnapshotStats.AddDelta(i, 0, 0, 1);
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshotSend);
 				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
 				Msg.AddInt(m_CurrentGameTick);
 				Msg.AddInt(m_CurrentGameTick - DeltaTick);
@@ -1189,6 +1225,7 @@ int CServer::DelClientCallback(int ClientId, const char *pReason, void *pUser)
 	pThis->m_aClients[ClientId].m_Snapshots.PurgeAll();
 	pThis->m_aClients[ClientId].m_Sixup = false;
 	pThis->m_aClients[ClientId].m_RedirectDropTime = 0;
+	pThis->m_SnapshotStats.ResetClient(ClientId);
 
 	pThis->GameServer()->TeehistorianRecordPlayerDrop(ClientId, pReason);
 	pThis->Antibot()->OnEngineClientDrop(ClientId, pReason);
@@ -2732,6 +2769,8 @@ int CServer::Run()
 		return -1;
 	}
 
+	DbPool()->SetNumReadWorkers(Config()->m_SvSqlReadWorkers);
+	DbPool()->SetWriteBatchSize(Config()->m_SvSqlWriteBatch);
 	if(Config()->m_SvSqliteFile[0] != '\0')
 	{
 		char aFullPath[IO_MAX_PATH_LENGTH];
@@ -2833,8 +2872,14 @@ int CServer::Run()
 		UpdateServerInfo();
 		while(m_RunServer < STOPPING)
 		{
+			m_TickProfiler.SetEnabled(Config()->m_SvTickProfiler);
+			const std::chrono::nanoseconds WorkStartTime = m_TickProfiler.Enabled() ? time_get_nanoseconds() : std::chrono::nanoseconds(0);
+
 			if(NonActive)
+			{
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseNetwork);
 				PumpNetwork(PacketWaiting);
+			}
 
 			set_new_tick();
 
@@ -2910,6 +2955,7 @@ int CServer::Run()
 				}
 			}
 
+			const std::chrono::nanoseconds TickWorkStartTime = time_get_nanoseconds();
 			while(t > TickStartTime(m_CurrentGameTick + 1))
 			{
 				GameServer()->OnPreTickTeehistorian();
@@ -2957,7 +3003,10 @@ int CServer::Run()
 						GameServer()->OnClientPredictedInput(c, nullptr);
 				}
 
-				GameServer()->OnTick();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseGame);
+					GameServer()->OnTick();
+				}
 				if(ErrorShutdown())
 				{
 					break;
@@ -2968,7 +3017,11 @@ int CServer::Run()
 			if(NewTicks)
 			{
 				if(Config()->m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0)
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseSnapshot);
 					DoSnapshot();
+				}
+				UpdateAdaptiveSnapRate(NewTicks, time_get_nanoseconds() - TickWorkStartTime);
 
 				UpdateClientRconCommands();
 
@@ -3050,7 +3103,31 @@ int CServer::Run()
 			}
 
 			if(!NonActive)
+			{
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_TickPhaseNetwork);
 				PumpNetwork(PacketWaiting);
+			}
+
+			if(m_TickProfiler.Enabled())
+			{
+				// idle iterations without a tick are added to the next tick
+				m_TickProfiler.Add(m_TickPhaseTotal, time_get_nanoseconds() - WorkStartTime);
+				if(NewTicks)
+					m_TickProfiler.EndTick();
+				if(Config()->m_SvTickProfilerInterval && time_get() > m_LastTickProfilerReport + Config()->m_SvTickProfilerInterval * time_freq())
+				{
+					SendTickProfilerReport();
+					m_LastTickProfilerReport = time_get();
+				}
+			}
+
+			if(Config()->m_SvSnapshotStats && Config()->m_SvSnapshotStatsInterval && time_get() > m_LastSnapshotStatsReport + Config()->m_SvSnapshotStatsInterval * time_freq())
+			{
+				if(m_LastSnapshotStatsReport)
+					LogSnapshotStats();
+				m_SnapshotStats.Reset();
+				m_LastSnapshotStatsReport = time_get();
+			}
 
 			NonActive = true;
 			for(const auto &Client : m_aClients)
@@ -3448,7 +3525,8 @@ void CServer::DemoRecorder_HandleAutoStart()
 			m_apCurrentMapData[MAP_TYPE_SIX],
 			nullptr,
 			nullptr,
-			nullptr);
+			nullptr,
+			Config()->m_SvDemoWriterThread ? &m_DemoWriter : nullptr);
 
 		if(Config()->m_SvAutoDemoMax)
 		{
@@ -3488,7 +3566,8 @@ void CServer::StartRecord(int ClientId)
 			m_apCurrentMapData[MAP_TYPE_SIX],
 			nullptr,
 			nullptr,
-			nullptr);
+			nullptr,
+			Config()->m_SvDemoWriterThread ? &m_DemoWriter : nullptr);
 	}
 }
 
@@ -3550,7 +3629,8 @@ void CServer::ConRecord(IConsole::IResult *pResult, void *pUser)
 		pServer->m_apCurrentMapData[MAP_TYPE_SIX],
 		nullptr,
 		nullptr,
-		nullptr);
+		nullptr,
+		pServer->Config()->m_SvDemoWriterThread ? &pServer->m_DemoWriter : nullptr);
 }
 
 void CServer::ConStopRecord(IConsole::IResult *pResult, void *pUser)
@@ -3663,12 +3743,142 @@ void CServer::ConDumpSqlServers(IConsole::IResult *pResult, void *pUserData)
 	}
 }
 
+void CServer::ConSqlStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CServer *pSelf = (CServer *)pUserData;
+	pSelf->DbPool()->PrintStats(pSelf->Console());
+}
+
 void CServer::ConReloadAnnouncement(IConsole::IResult *pResult, void *pUserData)
 {
 	CServer *pThis = static_cast<CServer *>(pUserData);
 	pThis->ReadAnnouncementsFile();
 }
 
+bool CServer::SkipAdaptiveSnapshot(int ClientId) const
+{
+	if(m_AdaptiveSnapRate.Level() == 0 || m_aClients[ClientId].m_SnapRate != CClient::SNAPRATE_FULL || m_aDemoRecorder[ClientId].IsRecording())
+		return false;
+
+	// each pressure level halves the snapshot rate of the clients below it,
+	// starting with spectators
+	const int Reduction = m_AdaptiveSnapRate.Level() - m_aAdaptiveSnapPriorities[ClientId];
+	if(Reduction <= 0)
+		return false;
+	const int Interval = 1 << Reduction;
+	// count snapshots instead of ticks and spread clients over them
+	const int Snapshot = Config()->m_SvHighBandwidth ? Tick() : Tick() / 2;
+	return (Snapshot + ClientId) % Interval != 0;
+}
+
+void CServer::UpdateAdaptiveSnapRate(int NewTicks, std::chrono::nanoseconds Work)
+{
+	if(!Config()->m_SvAdaptiveSnapRate)
+	{
+		// also drop what was counted while it was disabled
+		m_AdaptiveSnapRate.Reset();
+		return;
+	}
+
+	const int OldLevel = m_AdaptiveSnapRate.Level();
+	if(!m_AdaptiveSnapRate.Update(NewTicks, Work, TickSpeed(), IGameServer::NUM_SNAP_PRIORITIES - 1, Config()->m_SvAdaptiveSnapRateLoad, Config()->m_SvAdaptiveSnapRateBandwidth))
+		return;
+
+	const int Level = m_AdaptiveSnapRate.Level();
+	if(Level != OldLevel)
+		log_info("server", "adaptive snapshot rate level %d -> %d (load=%d%% bandwidth=%dKiB/s)", OldLevel, Level, (int)m_AdaptiveSnapRate.Load(), (int)m_AdaptiveSnapRate.Bandwidth());
+
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+	{
+		if(Level && m_aClients[ClientId].m_State == CClient::STATE_INGAME)
+			m_aAdaptiveSnapPriorities[ClientId] = GameServer()->ClientSnapPriority(ClientId);
+		else
+			m_aAdaptiveSnapPriorities[ClientId] = IGameServer::SNAP_PRIORITY_NORMAL;
+	}
+}
+
+void CServer::ConTickProfile(IConsole::IResult *pResult, void *pUserData)
+{
+	CServer *pThis = static_cast<CServer *>(pUserData);
+	if(!pThis->m_TickProfiler.Enabled())
+	{
+		log_info("tick_profiler", "the tick profiler is disabled, enable it with 'sv_tick_profiler 1'");
+		return;
+	}
+	for(int Phase = 0; Phase < pThis->m_TickProfiler.NumPhases(); Phase++)
+	{
+		char aBuf[256];
+		pThis->m_TickProfiler.FormatStats(Phase, aBuf, sizeof(aBuf));
+		log_info("tick_profiler", "%s", aBuf);
+	}
+}
+
+static const char *SnapshotItemTypeName(int Type, bool Sixup)
+{
+	static const CNetObjHandler s_NetObjHandler;
+	static const protocol7::CNetObjHandler s_NetObjHandler7;
+	if(Sixup && Type < CSnapshot::OFFSET_UUID_TYPE)
+		return s_NetObjHandler7.GetObjName(Type);
+	return s_NetObjHandler.GetObjName(Type);
+}
+
+void CServer::ConSnapshotStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CServer *pThis = static_cast<CServer *>(pUserData);
+	if(!pThis->Config()->m_SvSnapshotStats)
+	{
+		log_info("snapshot_stats", "the snapshot statistics are disabled, enable them with 'sv_snapshot_stats 1'");
+		return;
+	}
+
+	const int ClientId = pResult->NumArguments() ? pResult->GetInteger(0) : -1;
+	if(ClientId != -1 && !pThis->ClientIngame(ClientId))
+	{
+		log_info("snapshot_stats", "invalid client id");
+		return;
+	}
+
+	const CSnapshotStats &Stats = pThis->m_SnapshotStats;
+	for(int Id = 0; Id < MAX_CLIENTS; Id++)
+	{
+		if((ClientId != -1 && Id != ClientId) || Stats.Client(Id).m_Snapshots == 0)
+			continue;
+		const CSnapshotStats::CCounters &Counters = Stats.Client(Id);
+		log_info("snapshot_stats", "cid=%d name='%s' snapshots=%" PRId64 " items=%" PRId64 " raw=%" PRId64 " delta=%" PRId64 " compressed=%" PRId64 " packets=%" PRId64,
+			Id, pThis->ClientName(Id), Counters.m_Snapshots, Counters.m_Items, Counters.m_RawBytes, Counters.m_DeltaBytes, Counters.m_CompressedBytes, Counters.m_Packets);
+	}
+	for(const CSnapshotStats::CType &Type : Stats.TopTypes(ClientId, 16))
+	{
+		log_info("snapshot_stats", "type=%d name=%s sixup=%d items=%" PRId64 " raw=%" PRId64,
+			Type.m_Type, SnapshotItemTypeName(Type.m_Type, Type.m_Sixup), Type.m_Sixup, Type.m_Counters.m_Items, Type.m_Counters.m_RawBytes);
+	}
+}
+
+void CServer::LogSnapshotStats()
+{
+	// one JSON object per line, the totals first
+	log_info("snapshot_stats", "%s", m_SnapshotStats.FormatJson(-1, 16, SnapshotItemTypeName).c_str());
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+	{
+		if(m_SnapshotStats.Client(ClientId).m_Snapshots)
+			log_info("snapshot_stats", "%s", m_SnapshotStats.FormatJson(ClientId, 8, SnapshotItemTypeName).c_str());
+	}
+}
+
+void CServer::SendTickProfilerReport()
+{
+	// sent directly instead of logged, so that monitoring can parse the lines
+	// regardless of ec_output_level and without flooding the other log outputs
+	for(int Phase = 0; Phase < m_TickProfiler.NumPhases(); Phase++)
+	{
+		char aStats[256];
+		m_TickProfiler.FormatStats(Phase, aStats, sizeof(aStats));
+		char aLine[320];
+		str_format(aLine, sizeof(aLine), "tick_profiler tick=%d %s", Tick(), aStats);
+		m_Econ.Send(-1, aLine);
+	}
+}
+
 void CServer::ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -3840,6 +4050,7 @@ void CServer::ConchainLoglevel(IConsole::IResult *pResult, void *pUserData, ICon
 	if(pResult->NumArguments())
 	{
 		pSelf->m_pFileLogger->SetFilter(CLogFilter{IConsole::ToLogLevelFilter(g_Config.m_Loglevel)});
+		pSelf->UpdateThreadedLoggerFilter();
 	}
 }
 
@@ -3850,6 +4061,39 @@ void CServer::ConchainStdoutOutputLevel(IConsole::IResult *pResult, void *pUserD
 	if(pResult->NumArguments() && pSelf->m_pStdoutLogger)
 	{
 		pSelf->m_pStdoutLogger->SetFilter(CLogFilter{IConsole::ToLogLevelFilter(g_Config.m_StdoutOutputLevel)});
+		pSelf->UpdateThreadedLoggerFilter();
+	}
+}
+
+void CServer::UpdateThreadedLoggerFilter()
+{
+	if(!m_pThreadedLogger)
+		return;
+
+	// don't queue messages that all of the file and stdout loggers drop
+	int MaxLevel = IConsole::ToLogLevelFilter(g_Config.m_Loglevel);
+	if(m_pStdoutLogger)
+		MaxLevel = maximum(MaxLevel, IConsole::ToLogLevelFilter(g_Config.m_StdoutOutputLevel));
+	m_pThreadedLogger->SetFilter(CLogFilter{MaxLevel});
+}
+
+void CServer::ConchainLogthread(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
+{
+	CServer *pSelf = (CServer *)pUserData;
+	pfnCallback(pResult, pCallbackUserData);
+	if(pResult->NumArguments() && pSelf->m_pThreadedLogger)
+	{
+		pSelf->m_pThreadedLogger->SetAsync(g_Config.m_Logthread);
+	}
+}
+
+void CServer::ConchainSqlWriteBatch(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
+{
+	CServer *pSelf = (CServer *)pUserData;
+	pfnCallback(pResult, pCallbackUserData);
+	if(pResult->NumArguments())
+	{
+		pSelf->DbPool()->SetWriteBatchSize(g_Config.m_SvSqlWriteBatch);
 	}
 }
 
@@ -3916,6 +4160,7 @@ void CServer::RegisterCommands()
 
 	Console()->Register("add_sqlserver", "s['r'|'w'] s[Database] s[Prefix] s[User] s[Password] s[IP] i[Port] ?i[SetUpDatabase ?]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAddSqlServer, this, "add a sqlserver");
 	Console()->Register("dump_sqlservers", "s['r'|'w']", CFGFLAG_SERVER, ConDumpSqlServers, this, "dumps all sqlservers readservers = r, writeservers = w");
+	Console()->Register("sql_stats", "", CFGFLAG_SERVER, ConSqlStats, this, "Show the number, queue depth and latency of database queries");
 
 	Console()->Register("auth_add", "s[ident] s[level] r[pw]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAuthAdd, this, "Add a rcon key");
 	Console()->Register("auth_add_p", "s[ident] s[level] s[hash] s[salt]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAuthAddHashed, this, "Add a prehashed rcon key");
@@ -3925,6 +4170,8 @@ void CServer::RegisterCommands()
 	Console()->Register("auth_list", "", CFGFLAG_SERVER, ConAuthList, this, "List all rcon keys");
 
 	Console()->Register("reload_announcement", "", CFGFLAG_SERVER, ConReloadAnnouncement, this, "Reload the announcements");
+	Console()->Register("tick_profile", "", CFGFLAG_SERVER, ConTickProfile, this, "Show how long the phases of the last server ticks took in microseconds (needs sv_tick_profiler 1)");
+	Console()->Register("snapshot_stats", "?i[id]", CFGFLAG_SERVER, ConSnapshotStats, this, "Show the snapshot sizes per client and item type (needs sv_snapshot_stats 1)");
 
 	RustVersionRegister(*Console());
 
@@ -3943,6 +4190,9 @@ void CServer::RegisterCommands()
 
 	Console()->Chain("loglevel", ConchainLoglevel, this);
 	Console()->Chain("stdout_output_level", ConchainStdoutOutputLevel, this);
+	Console()->Chain("logthread", ConchainLogthread, this);
+	Console()->Chain("sv_sql_write_batch", ConchainSqlWriteBatch, this);
+	UpdateThreadedLoggerFilter();
 
 	Console()->Chain("sv_announcement_filename", ConchainAnnouncementFileName, this);
 
@@ -4071,8 +4321,9 @@ void CServer::SetErrorShutdown(const char *pReason)
 	str_copy(m_aErrorShutdownReason, pReason);
 }
 
-void CServer::SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger)
+void CServer::SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger, std::shared_ptr<CThreadedLogger> &&pThreadedLogger)
 {
 	m_pFileLogger = pFileLogger;
 	m_pStdoutLogger = pStdoutLogger;
+	m_pThreadedLogger = pThreadedLogger;
 }
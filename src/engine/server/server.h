@@ -8,6 +8,7 @@
 #include <engine/console.h>
 #include <engine/server.h>
 
+#include <engine/shared/adaptive_snap_rate.h>
 #include <engine/shared/demo.h>
 #include <engine/shared/econ.h>
 #include <engine/shared/fifo.h>
@@ -16,6 +17,8 @@
 #include <engine/shared/network.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
+#include <engine/shared/snapshot_stats.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/shared/uuid_manager.h>
 
 #include <list>
@@ -37,6 +40,7 @@ class CHostLookup;
 class CLogMessage;
 class CMsgPacker;
 class CPacker;
+class CThreadedLogger;
 class IEngine;
 class IEngineMap;
 class ILogger;
@@ -204,6 +208,24 @@ public:
 	CServerBan m_ServerBan;
 	CHttp m_Http;
 
+	CTickProfiler m_TickProfiler;
+	int m_TickPhaseTotal;
+	int m_TickPhaseNetwork;
+	int m_TickPhaseGame;
+	int m_TickPhaseSnapshot;
+	int m_TickPhaseSnapshotBuild;
+	int m_TickPhaseSnapshotDelta;
+	int m_TickPhaseSnapshotCompress;
+	int m_TickPhaseSnapshotSend;
+	int64_t m_LastTickProfilerReport;
+
+	CSnapshotStats m_SnapshotStats;
+	int64_t m_LastSnapshotStatsReport;
+
+	// adaptive snapshot rate, see `UpdateAdaptiveSnapRate`
+	CAdaptiveSnapRate m_AdaptiveSnapRate;
+	int m_aAdaptiveSnapPriorities[MAX_CLIENTS];
+
 	IEngineMap *m_pMap;
 
 	int64_t m_GameStartTime;
@@ -249,6 +271,8 @@ public:
 	unsigned int m_aCurrentMapSize[NUM_MAP_TYPES];
 	char m_aMapDownloadUrl[256];
 
+	// shared by all recorders
+	CDemoWriter m_DemoWriter;
 	CDemoRecorder m_aDemoRecorder[NUM_RECORDERS];
 	CAuthManager m_AuthManager;
 
@@ -264,6 +288,7 @@ public:
 
 	std::shared_ptr<ILogger> m_pFileLogger = nullptr;
 	std::shared_ptr<ILogger> m_pStdoutLogger = nullptr;
+	std::shared_ptr<CThreadedLogger> m_pThreadedLogger = nullptr;
 
 	CServer();
 	~CServer();
@@ -315,6 +340,10 @@ public:
 	int SendMsg(CMsgPacker *pMsg, int Flags, int ClientId) override;
 
 	void DoSnapshot();
+	bool SkipAdaptiveSnapshot(int ClientId) const;
+	void UpdateAdaptiveSnapRate(int NewTicks, std::chrono::nanoseconds Work);
+	void SendTickProfilerReport();
+	void LogSnapshotStats();
 
 	static int NewClientCallback(int ClientId, void *pUser, bool Sixup);
 	static int NewClientNoAuthCallback(int ClientId, void *pUser);
@@ -412,8 +441,11 @@ public:
 	// console commands for sqlmasters
 	static void ConAddSqlServer(IConsole::IResult *pResult, void *pUserData);
 	static void ConDumpSqlServers(IConsole::IResult *pResult, void *pUserData);
+	static void ConSqlStats(IConsole::IResult *pResult, void *pUserData);
 
 	static void ConReloadAnnouncement(IConsole::IResult *pResult, void *pUserData);
+	static void ConTickProfile(IConsole::IResult *pResult, void *pUserData);
+	static void ConSnapshotStats(IConsole::IResult *pResult, void *pUserData);
 
 	static void ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -429,6 +461,8 @@ public:
 	static void ConchainMapUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainSixupUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainLoglevel(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
+	static void ConchainLogthread(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
+	static void ConchainSqlWriteBatch(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainStdoutOutputLevel(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainAnnouncementFileName(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 
@@ -437,6 +471,7 @@ public:
 #endif
 
 	void RegisterCommands();
+	void UpdateThreadedLoggerFilter();
 
 	int SnapNewId() override;
 	void SnapFreeId(int Id) override;
@@ -481,7 +516,9 @@ public:
 
 	bool IsSixup(int ClientId) const override { return ClientId != SERVER_DEMO_CLIENT && m_aClients[ClientId].m_Sixup; }
 
-	void SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger);
+	CTickProfiler *TickProfiler() override { return &m_TickProfiler; }
+
+	void SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger, std::shared_ptr<CThreadedLogger> &&pThreadedLogger);
 
 #ifdef CONF_FAMILY_UNIX
 	enum CONN_LOGGING_CMD
@@ -304,6 +304,8 @@ public:
 		int64_t m_RequestTime;
 		bool m_RequestIgnoreInfo;
 		int m_GotInfo;
+		// info changed since the servers were last sorted
+		bool m_NeedResort;
 		CServerInfo m_Info;
 
 		CServerEntry *m_pPrevReq; // request list
@@ -0,0 +1,32 @@
+#include "adaptive_snap_rate.h"
+
+bool CAdaptiveSnapRate::Update(int NewTicks, std::chrono::nanoseconds Work, int TickSpeed, int MaxLevel, int LoadLimit, int BandwidthLimit)
+{
+	m_Ticks += NewTicks;
+	m_Work += Work;
+	if(m_Ticks < TickSpeed)
+		return false;
+
+	m_Load = m_Work.count() * TickSpeed * 100 / (m_Ticks * std::chrono::nanoseconds(std::chrono::seconds(1)).count());
+	m_Bandwidth = m_Bytes * TickSpeed / m_Ticks / 1024;
+	const bool Overloaded = m_Load > LoadLimit || (BandwidthLimit && m_Bandwidth > BandwidthLimit);
+	// some hysteresis so the level doesn't flip every second
+	const bool Relaxed = m_Load < LoadLimit * 3 / 4 && (!BandwidthLimit || m_Bandwidth < BandwidthLimit * 3 / 4);
+	if(Overloaded && m_Level < MaxLevel)
+		m_Level++;
+	else if(Relaxed && m_Level > 0)
+		m_Level--;
+
+	m_Ticks = 0;
+	m_Work = std::chrono::nanoseconds(0);
+	m_Bytes = 0;
+	return true;
+}
+
+void CAdaptiveSnapRate::Reset()
+{
+	m_Level = 0;
+	m_Ticks = 0;
+	m_Work = std::chrono::nanoseconds(0);
+	m_Bytes = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef ENGINE_SHARED_ADAPTIVE_SNAP_RATE_H
+#define ENGINE_SHARED_ADAPTIVE_SNAP_RATE_H
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Decides how far the snapshot rate is reduced, from the share of the tick
+ * time used by the server and from the sent snapshot bytes. Both are measured
+ * over one second. The level rises by one while the server is overloaded and
+ * only falls again once both are below three quarters of their limits.
+ */
+class CAdaptiveSnapRate
+{
+	int m_Level = 0;
+	int m_Ticks = 0;
+	std::chrono::nanoseconds m_Work = std::chrono::nanoseconds(0);
+	int64_t m_Bytes = 0;
+
+	int64_t m_Load = 0;
+	int64_t m_Bandwidth = 0;
+
+public:
+	int Level() const { return m_Level; }
+	// load in percent of the available tick time, bandwidth in KiB/s, of the last second
+	int64_t Load() const { return m_Load; }
+	int64_t Bandwidth() const { return m_Bandwidth; }
+
+	void AddSnapshotBytes(int Bytes) { m_Bytes += Bytes; }
+
+	/**
+	 * Adds the work done for `NewTicks` ticks. Returns true if a second has
+	 * passed and the level was updated. A `BandwidthLimit` of 0 ignores the
+	 * bandwidth.
+	 */
+	bool Update(int NewTicks, std::chrono::nanoseconds Work, int TickSpeed, int MaxLevel, int LoadLimit, int BandwidthLimit);
+
+	// sets the level to 0 and starts a new measurement
+	void Reset();
+};
+
+#endif
@@ -1,11 +1,17 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/detect.h>
 #include <base/system.h>
 
 #include "compression.h"
 
 #include <iterator> // std::size
 
+#if defined(CONF_ARCH_AMD64) || defined(__SSE2__)
+#define COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
 // Format: ESDDDDDD EDDDDDDD EDD... Extended, Data, Sign
 unsigned char *CVariableInt::Pack(unsigned char *pDst, int i, int DstSize)
 {
@@ -65,6 +71,93 @@ const unsigned char *CVariableInt::Unpack(const unsigned char *pSrc, int *pInOut
 	return pSrc;
 }
 
+// Snapshot deltas mostly consist of small values that fit into a single
+// byte. The bulk functions handle blocks of such values without the per-int
+// bounds checks and branches. SSE2 is always available on x86-64, elsewhere
+// the loops are written so that the compiler can vectorize them.
+#if defined(COMPRESSION_SSE2)
+static constexpr int BULK_BLOCK_SIZE = 16;
+
+// returns false if the block contains extended ints
+static bool DecompressBlock(const unsigned char *pSrc, int *pDst)
+{
+	const __m128i In = _mm_loadu_si128((const __m128i *)pSrc);
+	if(_mm_movemask_epi8(In))
+		return false;
+	// the single byte ints as signed bytes: the data, inverted if the sign bit is set
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i Sign = _mm_cmpgt_epi8(_mm_and_si128(In, _mm_set1_epi8(0x40)), Zero);
+	const __m128i Bytes = _mm_xor_si128(_mm_and_si128(In, _mm_set1_epi8(0x3F)), Sign);
+	// sign extend to 32 bit
+	const __m128i Lo = _mm_srai_epi16(_mm_unpacklo_epi8(Bytes, Bytes), 8);
+	const __m128i Hi = _mm_srai_epi16(_mm_unpackhi_epi8(Bytes, Bytes), 8);
+	_mm_storeu_si128((__m128i *)pDst, _mm_srai_epi32(_mm_unpacklo_epi16(Lo, Lo), 16));
+	_mm_storeu_si128((__m128i *)(pDst + 4), _mm_srai_epi32(_mm_unpackhi_epi16(Lo, Lo), 16));
+	_mm_storeu_si128((__m128i *)(pDst + 8), _mm_srai_epi32(_mm_unpacklo_epi16(Hi, Hi), 16));
+	_mm_storeu_si128((__m128i *)(pDst + 12), _mm_srai_epi32(_mm_unpackhi_epi16(Hi, Hi), 16));
+	return true;
+}
+
+// returns false if the block contains ints that need more than one byte
+static bool CompressBlock(const int *pSrc, unsigned char *pDst)
+{
+	// same transformation as in Pack: the sign goes into bit 6, the data is inverted for negative ints
+	__m128i aOut[4];
+	__m128i Extended = _mm_setzero_si128();
+	for(int i = 0; i < 4; i++)
+	{
+		const __m128i In = _mm_loadu_si128((const __m128i *)(pSrc + i * 4));
+		const __m128i Sign = _mm_srai_epi32(In, 31);
+		const __m128i Data = _mm_xor_si128(In, Sign);
+		Extended = _mm_or_si128(Extended, _mm_andnot_si128(_mm_set1_epi32(0x3F), Data));
+		aOut[i] = _mm_or_si128(Data, _mm_and_si128(Sign, _mm_set1_epi32(0x40)));
+	}
+	if(_mm_movemask_epi8(_mm_cmpeq_epi32(Extended, _mm_setzero_si128())) != 0xFFFF)
+		return false;
+	// all values are below 128, so the saturating packs keep them
+	const __m128i Words = _mm_packs_epi32(aOut[0], aOut[1]);
+	const __m128i Words2 = _mm_packs_epi32(aOut[2], aOut[3]);
+	_mm_storeu_si128((__m128i *)pDst, _mm_packus_epi16(Words, Words2));
+	return true;
+}
+#else
+static constexpr int BULK_BLOCK_SIZE = 8;
+
+static bool DecompressBlock(const unsigned char *pSrc, int *pDst)
+{
+	uint64_t Block;
+	static_assert(sizeof(Block) == BULK_BLOCK_SIZE);
+	mem_copy(&Block, pSrc, sizeof(Block));
+	if(Block & 0x8080808080808080ull)
+		return false;
+	for(int i = 0; i < BULK_BLOCK_SIZE; i++)
+	{
+		const int Sign = (pSrc[i] >> 6) & 1;
+		pDst[i] = (pSrc[i] & 0x3F) ^ -Sign;
+	}
+	return true;
+}
+
+static bool CompressBlock(const int *pSrc, unsigned char *pDst)
+{
+	// same transformation as in Pack: the sign goes into bit 6, the data is inverted for negative ints
+	int aSign[BULK_BLOCK_SIZE];
+	int aData[BULK_BLOCK_SIZE];
+	int Extended = 0;
+	for(int i = 0; i < BULK_BLOCK_SIZE; i++)
+	{
+		aSign[i] = pSrc[i] >> 31;
+		aData[i] = pSrc[i] ^ aSign[i];
+		Extended |= aData[i] & ~0x3F;
+	}
+	if(Extended)
+		return false;
+	for(int i = 0; i < BULK_BLOCK_SIZE; i++)
+		pDst[i] = aData[i] | (aSign[i] & 0x40);
+	return true;
+}
+#endif
+
 long CVariableInt::Decompress(const void *pSrc_, int SrcSize, void *pDst_, int DstSize)
 {
 	dbg_assert(DstSize % sizeof(int) == 0, "invalid bounds");
@@ -73,6 +166,20 @@ long CVariableInt::Decompress(const void *pSrc_, int SrcSize, void *pDst_, int D
 	const unsigned char *pSrcEnd = pSrc + SrcSize;
 	int *pDst = (int *)pDst_;
 	const int *pDstEnd = pDst + DstSize / sizeof(int);
+	while(pSrcEnd - pSrc >= BULK_BLOCK_SIZE && pDstEnd - pDst >= BULK_BLOCK_SIZE)
+	{
+		if(DecompressBlock(pSrc, pDst))
+		{
+			pSrc += BULK_BLOCK_SIZE;
+			pDst += BULK_BLOCK_SIZE;
+			continue;
+		}
+		// at least one extended int, unpack the next one on its own
+		pSrc = CVariableInt::Unpack(pSrc, pDst, pSrcEnd - pSrc);
+		if(!pSrc)
+			return -1;
+		pDst++;
+	}
 	while(pSrc < pSrcEnd)
 	{
 		if(pDst >= pDstEnd)
@@ -93,6 +200,21 @@ long CVariableInt::Compress(const void *pSrc_, int SrcSize, void *pDst_, int Dst
 	unsigned char *pDst = (unsigned char *)pDst_;
 	const unsigned char *pDstEnd = pDst + DstSize;
 	SrcSize /= sizeof(int);
+	while(SrcSize >= BULK_BLOCK_SIZE && pDstEnd - pDst >= BULK_BLOCK_SIZE * MAX_BYTES_PACKED)
+	{
+		if(CompressBlock(pSrc, pDst))
+		{
+			pDst += BULK_BLOCK_SIZE;
+		}
+		else
+		{
+			// space has been checked for the whole block
+			for(int i = 0; i < BULK_BLOCK_SIZE; i++)
+				pDst = CVariableInt::Pack(pDst, pSrc[i], pDstEnd - pDst);
+		}
+		SrcSize -= BULK_BLOCK_SIZE;
+		pSrc += BULK_BLOCK_SIZE;
+	}
 	while(SrcSize)
 	{
 		pDst = CVariableInt::Pack(pDst, *pSrc, pDstEnd - pDst);
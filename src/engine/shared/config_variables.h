@@ -300,6 +300,7 @@ MACRO_CONFIG_STR(SteamName, steam_name, 16, "", CFGFLAG_SAVE | CFGFLAG_CLIENT, "
 MACRO_CONFIG_STR(Logfile, logfile, 128, "", CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Filename to log all output to")
 MACRO_CONFIG_INT(Logappend, logappend, 1, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Append to logfile instead of overwriting it every time")
 MACRO_CONFIG_INT(Loglevel, loglevel, 0, -3, 2, CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Adjusts the amount of information in the logfile (-3 = none, -2 = error only, -1 = warn, 0 = info, 1 = debug, 2 = trace)")
+MACRO_CONFIG_INT(Logthread, logthread, 0, 0, 1, CFGFLAG_SERVER, "Write stdout and the logfile from a separate thread, messages are dropped if the output can't keep up")
 MACRO_CONFIG_INT(StdoutOutputLevel, stdout_output_level, 0, -3, 2, CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Adjusts the amount of information in the system console (-3 = none, -2 = error only, -1 = warn, 0 = info, 1 = debug, 2 = trace)")
 MACRO_CONFIG_INT(ConsoleOutputLevel, console_output_level, 0, -3, 2, CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Adjusts the amount of information in the local/remote console (-3 = none, -2 = error only, -1 = warn, 0 = info, 1 = debug, 2 = trace)")
 MACRO_CONFIG_INT(ConsoleEnableColors, console_enable_colors, 1, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT | CFGFLAG_SERVER, "Enable colors in console output")
@@ -450,7 +451,9 @@ MACRO_CONFIG_INT(SvRconMaxTries, sv_rcon_max_tries, 30, 0, 100, CFGFLAG_SERVER,
 MACRO_CONFIG_INT(SvRconBantime, sv_rcon_bantime, 5, 0, 1440, CFGFLAG_SERVER, "The time a client gets banned if remote console authentication fails. 0 makes it just use kick")
 MACRO_CONFIG_INT(SvAutoDemoRecord, sv_auto_demo_record, 0, 0, 1, CFGFLAG_SERVER, "Automatically record demos")
 MACRO_CONFIG_INT(SvAutoDemoMax, sv_auto_demo_max, 10, 0, 1000, CFGFLAG_SERVER, "Maximum number of automatically recorded demos (0 = no limit)")
+MACRO_CONFIG_INT(SvDemoWriterThread, sv_demo_writer_thread, 1, 0, 1, CFGFLAG_SERVER, "Compress and write all server demos on one separate thread instead of the server tick")
 MACRO_CONFIG_INT(SvTeeHistorian, sv_tee_historian, 0, 0, 1, CFGFLAG_SERVER, "Activate the tee historian that writes complete gameplay data to disk (WARNING: This will use a lot of disk space)")
+MACRO_CONFIG_INT(SvTeeHistorianCompression, sv_tee_historian_compression, 0, 0, 1, CFGFLAG_SERVER, "Write the tee historian files gzip compressed (.teehistorian.gz)")
 MACRO_CONFIG_INT(SvVanillaAntiSpoof, sv_vanilla_antispoof, 1, 0, 1, CFGFLAG_SERVER, "Enable vanilla Antispoof")
 MACRO_CONFIG_INT(SvDnsbl, sv_dnsbl, 0, 0, 1, CFGFLAG_SERVER, "Enable DNSBL (DNS-based Blackhole List)")
 MACRO_CONFIG_STR(SvDnsblHost, sv_dnsbl_host, 128, "", CFGFLAG_SERVER, "Hostname of DNSBL provider to use for IP Verification")
@@ -477,8 +480,16 @@ MACRO_CONFIG_INT(EcOutputLevel, ec_output_level, 0, -3, 2, CFGFLAG_ECON, "Adjust
 
 MACRO_CONFIG_INT(Debug, debug, 0, 0, 1, CFGFLAG_CLIENT | CFGFLAG_SERVER, "Debug mode")
 MACRO_CONFIG_INT(DbgSql, dbg_sql, 1, 0, 1, CFGFLAG_SERVER, "Debug SQL")
+MACRO_CONFIG_INT(SvTickProfiler, sv_tick_profiler, 0, 0, 1, CFGFLAG_SERVER, "Measure how long the phases of each server tick take, see tick_profile")
+MACRO_CONFIG_INT(SvTickProfilerInterval, sv_tick_profiler_interval, 0, 0, 3600, CFGFLAG_SERVER, "Seconds between tick profiler statistics sent to econ clients (0 = never)")
+MACRO_CONFIG_INT(SvAdaptiveSnapRate, sv_adaptive_snap_rate, 0, 0, 1, CFGFLAG_SERVER, "Send fewer snapshots to spectators, AFK players and players far from others when the server is under load")
+MACRO_CONFIG_INT(SvAdaptiveSnapRateLoad, sv_adaptive_snap_rate_load, 60, 1, 100, CFGFLAG_SERVER, "Percentage of the tick time used by game ticks and snapshots above which the adaptive snapshot rate kicks in")
+MACRO_CONFIG_INT(SvAdaptiveSnapRateBandwidth, sv_adaptive_snap_rate_bandwidth, 0, 0, 1000000, CFGFLAG_SERVER, "Outgoing snapshot bandwidth in KiB/s above which the adaptive snapshot rate kicks in (0 = ignore bandwidth)")
+MACRO_CONFIG_INT(SvSnapshotStats, sv_snapshot_stats, 0, 0, 1, CFGFLAG_SERVER, "Count the snapshot sizes per client and item type, see snapshot_stats")
+MACRO_CONFIG_INT(SvSnapshotStatsInterval, sv_snapshot_stats_interval, 0, 0, 3600, CFGFLAG_SERVER, "Seconds between snapshot statistics logged as JSON lines, the statistics are reset afterwards (0 = never)")
 MACRO_CONFIG_INT(DbgCurl, dbg_curl, 0, 0, 1, CFGFLAG_CLIENT | CFGFLAG_SERVER, "Debug curl")
 MACRO_CONFIG_INT(DbgGraphs, dbg_graphs, 0, 0, 1, CFGFLAG_CLIENT, "Performance graphs")
+MACRO_CONFIG_INT(DbgFrameProfiler, dbg_frame_profiler, 0, 0, 1, CFGFLAG_CLIENT, "Measure how long the components take to render each frame, shown with debug 1, see frame_profile and frame_profile_trace")
 MACRO_CONFIG_INT(DbgGfx, dbg_gfx, 0, 0, 4, CFGFLAG_CLIENT, "Show graphic library warnings and errors, if the GPU supports it (0: none, 1: minimal, 2: affects performance, 3: verbose, 4: all)")
 #ifdef CONF_DEBUG
 MACRO_CONFIG_INT(DbgStress, dbg_stress, 0, 0, 1, CFGFLAG_CLIENT, "Stress systems (Debug build only)")
@@ -541,6 +552,10 @@ MACRO_CONFIG_INT(SvSwap, sv_swap, 1, 0, 1, CFGFLAG_SERVER, "Enable /swap")
 MACRO_CONFIG_INT(SvTeam0Mode, sv_team0mode, 1, 0, 1, CFGFLAG_SERVER, "Enables /team0mode")
 MACRO_CONFIG_INT(SvUseSql, sv_use_sql, 0, 0, 1, CFGFLAG_SERVER, "Enables MySQL backend instead of SQLite backend (sv_sqlite_file is still used as fallback write server when no MySQL server is reachable)")
 MACRO_CONFIG_INT(SvSqlQueriesDelay, sv_sql_queries_delay, 1, 0, 20, CFGFLAG_SERVER, "Delay in seconds between SQL queries of a single player")
+MACRO_CONFIG_INT(SvSqlReadWorkers, sv_sql_read_workers, 0, 0, 8, CFGFLAG_SERVER, "Number of threads executing read queries with their own database connections (0 = execute them in order with the writes, only read on startup)")
+MACRO_CONFIG_INT(SvSqlWriteBatch, sv_sql_write_batch, 16, 1, 256, CFGFLAG_SERVER, "Maximum number of queued write queries that are executed in one transaction")
+MACRO_CONFIG_INT(SvRankCache, sv_rank_cache, 1, 0, 1, CFGFLAG_SERVER, "Answer /rank and /top5 from the times of the current map kept in memory")
+MACRO_CONFIG_INT(SvRankCacheRefresh, sv_rank_cache_refresh, 300, 0, 86400, CFGFLAG_SERVER, "Seconds between reloads of the cached times to include finishes of other servers (0 = only load them once)")
 MACRO_CONFIG_STR(SvSqliteFile, sv_sqlite_file, 64, "ddnet-server.sqlite", CFGFLAG_SERVER, "File to store ranks in case sv_use_sql is turned off or used as backup sql server")
 
 #if defined(CONF_UPNP)
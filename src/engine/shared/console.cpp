@@ -14,6 +14,8 @@
 #include "console.h"
 #include "linereader.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iterator> // std::size
 #include <new>
 
@@ -116,6 +118,8 @@ int CConsole::ParseStart(CResult *pResult, const char *pString, int Length)
 		Len = Length;
 
 	str_copy(pResult->m_aStringStorage, pString, Len);
+	// parsing only replaces characters inside the copied string
+	pResult->m_StringStorageUsed = str_length(pResult->m_aStringStorage) + 1;
 	pStr = pResult->m_aStringStorage;
 
 	// get command
@@ -603,7 +607,7 @@ int CConsole::PossibleCommands(const char *pStr, int FlagMask, bool Temp, FPossi
 
 CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask)
 		{
@@ -618,7 +622,10 @@ CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 void CConsole::ExecuteLine(const char *pStr, int ClientId, bool InterpretSemicolons)
 {
 	CConsole::ExecuteLineStroked(1, pStr, ClientId, InterpretSemicolons); // press it
-	CConsole::ExecuteLineStroked(0, pStr, ClientId, InterpretSemicolons); // then release it
+	// releasing only does something for stroke commands (starting with '+'),
+	// skip parsing the line again for everything else, e.g. config variables
+	if(str_find(pStr, "+"))
+		CConsole::ExecuteLineStroked(0, pStr, ClientId, InterpretSemicolons); // then release it
 }
 
 void CConsole::ExecuteLineFlag(const char *pStr, int FlagMask, int ClientId, bool InterpretSemicolons)
@@ -659,11 +666,18 @@ bool CConsole::ExecuteFile(const char *pFilename, int ClientId, bool LogFailure,
 		str_format(aBuf, sizeof(aBuf), "executing '%s'", pFilename);
 		Print(IConsole::OUTPUT_LEVEL_STANDARD, "console", aBuf);
 
+		const std::chrono::nanoseconds StartTime = time_get_nanoseconds();
+		int NumLines = 0;
 		while(const char *pLine = LineReader.Get())
 		{
 			ExecuteLine(pLine, ClientId);
+			NumLines++;
 		}
 
+		const std::chrono::microseconds Duration = std::chrono::duration_cast<std::chrono::microseconds>(time_get_nanoseconds() - StartTime);
+		str_format(aBuf, sizeof(aBuf), "executed '%s' (%d lines) in %.2fms", pFilename, NumLines, Duration.count() / 1000.0f);
+		Print(IConsole::OUTPUT_LEVEL_ADDINFO, "console", aBuf);
+
 		Success = true;
 	}
 	else if(LogFailure)
@@ -784,6 +798,7 @@ CConsole::CConsole(int FlagMask)
 	m_apStrokeStr[0] = "0";
 	m_apStrokeStr[1] = "1";
 	m_pFirstCommand = 0;
+	std::fill(std::begin(m_apCommandHash), std::end(m_apCommandHash), nullptr);
 	m_pFirstExec = 0;
 	m_pfnTeeHistorianCommandCallback = 0;
 	m_pTeeHistorianCommandUserdata = 0;
@@ -857,14 +872,63 @@ void CConsole::ParseArguments(int NumArgs, const char **ppArguments)
 	}
 }
 
+unsigned CConsole::CommandHash(const char *pName)
+{
+	// FNV-1a over the ASCII-lowercased name, so that it agrees with str_comp_nocase
+	unsigned Hash = 2166136261u;
+	for(; *pName; pName++)
+	{
+		unsigned char c = *pName;
+		if(c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		Hash ^= c;
+		Hash *= 16777619u;
+	}
+	return Hash % COMMAND_HASH_SIZE;
+}
+
+void CConsole::AddCommandHashed(CCommand *pCommand)
+{
+	// keep the chain in the same order as the command list, so that commands
+	// which only differ in their flags are found in the same order as before
+	CCommand **ppSlot = &m_apCommandHash[CommandHash(pCommand->m_pName)];
+	while(*ppSlot && str_comp(pCommand->m_pName, (*ppSlot)->m_pName) > 0)
+		ppSlot = &(*ppSlot)->m_pNextHash;
+	pCommand->m_pNextHash = *ppSlot;
+	*ppSlot = pCommand;
+}
+
+void CConsole::RemoveCommandHashed(CCommand *pCommand)
+{
+	for(CCommand **ppSlot = &m_apCommandHash[CommandHash(pCommand->m_pName)]; *ppSlot; ppSlot = &(*ppSlot)->m_pNextHash)
+	{
+		if(*ppSlot == pCommand)
+		{
+			*ppSlot = pCommand->m_pNextHash;
+			pCommand->m_pNextHash = nullptr;
+			return;
+		}
+	}
+}
+
+void CConsole::RebuildCommandHash()
+{
+	std::fill(std::begin(m_apCommandHash), std::end(m_apCommandHash), nullptr);
+	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	{
+		CCommand **ppSlot = &m_apCommandHash[CommandHash(pCommand->m_pName)];
+		while(*ppSlot)
+			ppSlot = &(*ppSlot)->m_pNextHash;
+		pCommand->m_pNextHash = nullptr;
+		*ppSlot = pCommand;
+	}
+}
+
 void CConsole::AddCommandSorted(CCommand *pCommand)
 {
 	if(!m_pFirstCommand || str_comp(pCommand->m_pName, m_pFirstCommand->m_pName) <= 0)
 	{
-		if(m_pFirstCommand && m_pFirstCommand->m_pNext)
-			pCommand->m_pNext = m_pFirstCommand;
-		else
-			pCommand->m_pNext = 0;
+		pCommand->m_pNext = m_pFirstCommand;
 		m_pFirstCommand = pCommand;
 	}
 	else
@@ -879,6 +943,8 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 			}
 		}
 	}
+
+	AddCommandHashed(pCommand);
 }
 
 void CConsole::Register(const char *pName, const char *pParams,
@@ -944,34 +1010,37 @@ void CConsole::RegisterTemp(const char *pName, const char *pParams, int Flags, c
 
 void CConsole::DeregisterTemp(const char *pName)
 {
-	if(!m_pFirstCommand)
-		return;
-
 	CCommand *pRemoved = 0;
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
+	{
+		if(pCommand->m_Temp && str_comp(pCommand->m_pName, pName) == 0)
+		{
+			pRemoved = pCommand;
+			break;
+		}
+	}
+	if(!pRemoved)
+		return;
 
 	// remove temp entry from command list
-	if(m_pFirstCommand->m_Temp && str_comp(m_pFirstCommand->m_pName, pName) == 0)
+	if(m_pFirstCommand == pRemoved)
 	{
-		pRemoved = m_pFirstCommand;
 		m_pFirstCommand = m_pFirstCommand->m_pNext;
 	}
 	else
 	{
 		for(CCommand *pCommand = m_pFirstCommand; pCommand->m_pNext; pCommand = pCommand->m_pNext)
-			if(pCommand->m_pNext->m_Temp && str_comp(pCommand->m_pNext->m_pName, pName) == 0)
+			if(pCommand->m_pNext == pRemoved)
 			{
-				pRemoved = pCommand->m_pNext;
-				pCommand->m_pNext = pCommand->m_pNext->m_pNext;
+				pCommand->m_pNext = pRemoved->m_pNext;
 				break;
 			}
 	}
+	RemoveCommandHashed(pRemoved);
 
 	// add to recycle list
-	if(pRemoved)
-	{
-		pRemoved->m_pNext = m_pRecycleList;
-		m_pRecycleList = pRemoved;
-	}
+	pRemoved->m_pNext = m_pRecycleList;
+	m_pRecycleList = pRemoved;
 }
 
 void CConsole::DeregisterTempAll()
@@ -994,6 +1063,7 @@ void CConsole::DeregisterTempAll()
 
 	m_TempCommands.Reset();
 	m_pRecycleList = 0;
+	RebuildCommandHash();
 }
 
 void CConsole::Con_Chain(IResult *pResult, void *pUserData)
@@ -1042,7 +1112,7 @@ void CConsole::StoreCommands(bool Store)
 
 const IConsole::CCommandInfo *CConsole::GetCommandInfo(const char *pName, int FlagMask, bool Temp)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask && pCommand->m_Temp == Temp)
 		{
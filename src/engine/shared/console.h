@@ -15,6 +15,7 @@ class CConsole : public IConsole
 	{
 	public:
 		CCommand *m_pNext;
+		CCommand *m_pNextHash;
 		int m_Flags;
 		bool m_Temp;
 		FCommandCallback m_pfnCallback;
@@ -39,6 +40,13 @@ class CConsole : public IConsole
 	const char *m_apStrokeStr[2];
 	CCommand *m_pFirstCommand;
 
+	enum
+	{
+		COMMAND_HASH_SIZE = 1024,
+	};
+	// case-insensitive index on the command name, every chain is sorted like the command list
+	CCommand *m_apCommandHash[COMMAND_HASH_SIZE];
+
 	class CExecFile
 	{
 	public:
@@ -79,6 +87,7 @@ class CConsole : public IConsole
 	{
 	public:
 		char m_aStringStorage[CONSOLE_MAX_STR_LENGTH + 1];
+		int m_StringStorageUsed; // bytes of m_aStringStorage written by ParseStart
 		char *m_pArgsStart;
 
 		const char *m_pCommand;
@@ -87,16 +96,21 @@ class CConsole : public IConsole
 		CResult(int ClientId) :
 			IResult(ClientId)
 		{
-			mem_zero(m_aStringStorage, sizeof(m_aStringStorage));
+			// the storage and argument buffers are only read up to what has been
+			// parsed into them, zeroing them would cost ~40KB of writes per command
+			m_aStringStorage[0] = '\0';
+			m_StringStorageUsed = 1;
 			m_pArgsStart = 0;
 			m_pCommand = 0;
-			mem_zero(m_apArgs, sizeof(m_apArgs));
+			m_Victim = VICTIM_NONE;
 		}
 
 		CResult(const CResult &Other) :
 			IResult(Other)
 		{
-			mem_copy(m_aStringStorage, Other.m_aStringStorage, sizeof(m_aStringStorage));
+			// only copy what has been written, the rest of the storage is uninitialized
+			mem_copy(m_aStringStorage, Other.m_aStringStorage, Other.m_StringStorageUsed);
+			m_StringStorageUsed = Other.m_StringStorageUsed;
 			m_pArgsStart = m_aStringStorage + (Other.m_pArgsStart - Other.m_aStringStorage);
 			m_pCommand = m_aStringStorage + (Other.m_pCommand - Other.m_aStringStorage);
 			for(unsigned i = 0; i < Other.m_NumArgs; ++i)
@@ -170,6 +184,10 @@ class CConsole : public IConsole
 	};
 	std::vector<CExecutionQueueEntry> m_vExecutionQueue;
 
+	static unsigned CommandHash(const char *pName);
+	void AddCommandHashed(CCommand *pCommand);
+	void RemoveCommandHashed(CCommand *pCommand);
+	void RebuildCommandHash();
 	void AddCommandSorted(CCommand *pCommand);
 	CCommand *FindCommand(const char *pName, int FlagMask);
 
@@ -56,7 +56,7 @@ CDemoRecorder::~CDemoRecorder()
 }
 
 // Record
-int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetVersion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned Crc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser)
+int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetVersion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned Crc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser, CDemoWriter *pWriter)
 {
 	dbg_assert(m_File == 0, "Demo recorder already recording");
 
@@ -210,6 +210,11 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	m_File = DemoFile;
 	str_copy(m_aCurrentFilename, pFilename);
 
+	m_NumDropped = 0;
+	m_pWriter = pWriter;
+	if(m_pWriter)
+		m_pWriter->AddRecorder(*m_pSnapshotDelta);
+
 	return 0;
 }
 
@@ -241,29 +246,181 @@ enum
 	CHUNKTYPE_DELTA = 3,
 };
 
-void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+struct CDemoWriter::CEntry
+{
+	CDemoRecorder *m_pRecorder;
+	// signaled once all previous entries are written, instead of writing a chunk
+	SEMAPHORE *m_pFlushed;
+	int m_Type;
+	int m_Size;
+	int m_TickMarkerSize;
+	unsigned char m_aTickMarker[CDemoRecorder::MAX_TICKMARKER_SIZE];
+};
+
+CDemoWriter::CDemoWriter(int BufferSize) :
+	m_BufferSize(BufferSize),
+	m_pBuffer(std::make_unique<unsigned char[]>(BufferSize))
+{
+	sphore_init(&m_Semaphore);
+}
+
+CDemoWriter::~CDemoWriter()
+{
+	if(m_pThread)
+	{
+		m_Shutdown.store(true);
+		sphore_signal(&m_Semaphore);
+		thread_wait(m_pThread);
+	}
+	sphore_destroy(&m_Semaphore);
+}
+
+void CDemoWriter::CopyToBuffer(uint64_t Pos, const void *pData, int Size)
+{
+	const int Offset = Pos % m_BufferSize;
+	const int First = minimum(Size, m_BufferSize - Offset);
+	mem_copy(m_pBuffer.get() + Offset, pData, First);
+	mem_copy(m_pBuffer.get(), (const unsigned char *)pData + First, Size - First);
+}
+
+void CDemoWriter::CopyFromBuffer(uint64_t Pos, void *pData, int Size) const
+{
+	const int Offset = Pos % m_BufferSize;
+	const int First = minimum(Size, m_BufferSize - Offset);
+	mem_copy(pData, m_pBuffer.get() + Offset, First);
+	mem_copy((unsigned char *)pData + First, m_pBuffer.get(), Size - First);
+}
+
+bool CDemoWriter::PushEntry(const CEntry &Entry, const void *pData, int Reserve)
+{
+	// only the writer thread changes the read position, the free space can only grow in between
+	const uint64_t WritePos = m_WritePos.load(std::memory_order_relaxed);
+	const uint64_t Used = WritePos - m_ReadPos.load(std::memory_order_acquire);
+	if(m_BufferSize - Used < sizeof(Entry) + Entry.m_Size + Reserve)
+		return false;
+
+	CopyToBuffer(WritePos, &Entry, sizeof(Entry));
+	CopyToBuffer(WritePos + sizeof(Entry), pData, Entry.m_Size);
+	m_WritePos.store(WritePos + sizeof(Entry) + Entry.m_Size, std::memory_order_release);
+	sphore_signal(&m_Semaphore);
+	return true;
+}
+
+void CDemoWriter::AddRecorder(const CSnapshotDelta &SnapshotDelta)
+{
+	const CLockScope LockScope(m_PushLock);
+	if(m_NumRecorders++ == 0)
+		m_pSnapshotDelta = std::make_unique<CSnapshotDelta>(SnapshotDelta);
+	if(!m_pThread)
+		m_pThread = thread_init(ThreadFunc, this, "demo writer");
+}
+
+bool CDemoWriter::Push(CDemoRecorder *pRecorder, int Type, const unsigned char *pTickMarker, int TickMarkerSize, const void *pData, int Size)
+{
+	if(Size > MAX_DATA_SIZE)
+	{
+		// dropped by Write anyway, but keep the tick marker
+		Size = 0;
+		Type = -1;
+	}
+
+	CEntry Entry;
+	Entry.m_pRecorder = pRecorder;
+	Entry.m_pFlushed = nullptr;
+	Entry.m_Type = Type;
+	Entry.m_Size = Size;
+	Entry.m_TickMarkerSize = TickMarkerSize;
+	if(TickMarkerSize > 0)
+		mem_copy(Entry.m_aTickMarker, pTickMarker, TickMarkerSize);
+
+	const CLockScope LockScope(m_PushLock);
+	// keep space for stopping a recorder
+	if(PushEntry(Entry, pData, sizeof(CEntry)))
+		return true;
+	m_NumDropped++;
+	return false;
+}
+
+void CDemoWriter::RemoveRecorder(CDemoRecorder *pRecorder)
+{
+	SEMAPHORE Flushed;
+	sphore_init(&Flushed);
+
+	CEntry Entry;
+	Entry.m_pRecorder = pRecorder;
+	Entry.m_pFlushed = &Flushed;
+	Entry.m_Type = -1;
+	Entry.m_Size = 0;
+	Entry.m_TickMarkerSize = 0;
+	{
+		const CLockScope LockScope(m_PushLock);
+		const bool Pushed = PushEntry(Entry, nullptr, 0);
+		dbg_assert(Pushed, "no space reserved for stopping a demo recorder");
+		m_NumRecorders--;
+	}
+
+	sphore_wait(&Flushed);
+	sphore_destroy(&Flushed);
+}
+
+void CDemoWriter::ThreadFunc(void *pUser)
+{
+	static_cast<CDemoWriter *>(pUser)->Run();
+}
+
+void CDemoWriter::Run()
+{
+	while(true)
+	{
+		sphore_wait(&m_Semaphore);
+		const uint64_t ReadPos = m_ReadPos.load(std::memory_order_relaxed);
+		if(ReadPos == m_WritePos.load(std::memory_order_acquire))
+		{
+			if(m_Shutdown.load())
+				break;
+			continue;
+		}
+
+		const CLockScope LockScope(m_PauseLock);
+		CEntry Entry;
+		CopyFromBuffer(ReadPos, &Entry, sizeof(Entry));
+		CopyFromBuffer(ReadPos + sizeof(Entry), m_aData, Entry.m_Size);
+		CDemoRecorder *pRecorder = Entry.m_pRecorder;
+		if(Entry.m_pFlushed)
+			sphore_signal(Entry.m_pFlushed);
+		else if(Entry.m_Type == CHUNKTYPE_MESSAGE)
+			pRecorder->Write(Entry.m_Type, m_aData, Entry.m_Size);
+		else if(Entry.m_Type == -1)
+			io_write(pRecorder->m_File, Entry.m_aTickMarker, Entry.m_TickMarkerSize);
+		else
+			pRecorder->WriteSnapshot(Entry.m_Type, Entry.m_aTickMarker, Entry.m_TickMarkerSize, m_aData, Entry.m_Size, m_pSnapshotDelta.get());
+		m_ReadPos.store(ReadPos + sizeof(Entry) + Entry.m_Size, std::memory_order_release);
+	}
+}
+
+int CDemoRecorder::CreateTickMarker(int Tick, bool Keyframe, unsigned char *pTickMarker)
 {
+	int Size;
 	if(m_LastTickMarker == -1 || Tick - m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
 	{
-		unsigned char aChunk[sizeof(int32_t) + 1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
-		uint_to_bytes_be(aChunk + 1, Tick);
+		pTickMarker[0] = CHUNKTYPEFLAG_TICKMARKER;
+		uint_to_bytes_be(pTickMarker + 1, Tick);
 
 		if(Keyframe)
-			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
+			pTickMarker[0] |= CHUNKTICKFLAG_KEYFRAME;
 
-		io_write(m_File, aChunk, sizeof(aChunk));
+		Size = sizeof(int32_t) + 1;
 	}
 	else
 	{
-		unsigned char aChunk[1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
-		io_write(m_File, aChunk, sizeof(aChunk));
+		pTickMarker[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
+		Size = 1;
 	}
 
 	m_LastTickMarker = Tick;
 	if(m_FirstTick < 0)
 		m_FirstTick = Tick;
+	return Size;
 }
 
 void CDemoRecorder::Write(int Type, const void *pData, int Size)
@@ -316,29 +473,23 @@ void CDemoRecorder::Write(int Type, const void *pData, int Size)
 	io_write(m_File, aBuffer2, Size);
 }
 
-void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+void CDemoRecorder::WriteSnapshot(int Type, const unsigned char *pTickMarker, int TickMarkerSize, const void *pData, int Size, CSnapshotDelta *pSnapshotDelta)
 {
-	if(m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5)
-	{
-		// write full tickmarker
-		WriteTickMarker(Tick, true);
+	io_write(m_File, pTickMarker, TickMarkerSize);
 
+	if(Type == CHUNKTYPE_SNAPSHOT)
+	{
 		// write snapshot
 		Write(CHUNKTYPE_SNAPSHOT, pData, Size);
-
-		m_LastKeyFrame = Tick;
 		mem_copy(m_aLastSnapshotData, pData, Size);
 	}
 	else
 	{
-		// write tickmarker
-		WriteTickMarker(Tick, false);
-
 		// create delta
 		char aDeltaData[CSnapshot::MAX_SIZE + sizeof(int)];
-		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
-		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
-		const int DeltaSize = m_pSnapshotDelta->CreateDelta((CSnapshot *)m_aLastSnapshotData, (CSnapshot *)pData, &aDeltaData);
+		pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
+		pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
+		const int DeltaSize = pSnapshotDelta->CreateDelta((CSnapshot *)m_aLastSnapshotData, (CSnapshot *)pData, &aDeltaData);
 		if(DeltaSize)
 		{
 			// record delta
@@ -348,6 +499,33 @@ void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 	}
 }
 
+void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+{
+	const bool Keyframe = m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5;
+	if(Keyframe)
+		m_LastKeyFrame = Tick;
+
+	const int LastTickMarker = m_LastTickMarker;
+	const int FirstTick = m_FirstTick;
+	unsigned char aTickMarker[MAX_TICKMARKER_SIZE];
+	const int TickMarkerSize = CreateTickMarker(Tick, Keyframe, aTickMarker);
+	const int Type = Keyframe ? CHUNKTYPE_SNAPSHOT : CHUNKTYPE_DELTA;
+	if(m_pWriter)
+	{
+		if(!m_pWriter->Push(this, Type, aTickMarker, TickMarkerSize, pData, Size))
+		{
+			// the next tick marker and delta refer to the last written snapshot
+			m_LastTickMarker = LastTickMarker;
+			m_FirstTick = FirstTick;
+			if(Keyframe)
+				m_LastKeyFrame = -1;
+			m_NumDropped++;
+		}
+	}
+	else
+		WriteSnapshot(Type, aTickMarker, TickMarkerSize, pData, Size, m_pSnapshotDelta);
+}
+
 void CDemoRecorder::RecordMessage(const void *pData, int Size)
 {
 	if(m_pfnFilter)
@@ -357,7 +535,13 @@ void CDemoRecorder::RecordMessage(const void *pData, int Size)
 			return;
 		}
 	}
-	Write(CHUNKTYPE_MESSAGE, pData, Size);
+	if(m_pWriter)
+	{
+		if(!m_pWriter->Push(this, CHUNKTYPE_MESSAGE, nullptr, 0, pData, Size))
+			m_NumDropped++;
+	}
+	else
+		Write(CHUNKTYPE_MESSAGE, pData, Size);
 }
 
 int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilename)
@@ -365,6 +549,19 @@ int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilena
 	if(!m_File)
 		return -1;
 
+	// finish writing all recorded chunks
+	if(m_pWriter)
+	{
+		m_pWriter->RemoveRecorder(this);
+		m_pWriter = nullptr;
+		if(m_NumDropped > 0 && m_pConsole)
+		{
+			char aBuf[64 + IO_MAX_PATH_LENGTH];
+			str_format(aBuf, sizeof(aBuf), "Dropped %d chunks of '%s', the demo writer was too slow", m_NumDropped, m_aCurrentFilename);
+			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", aBuf, gs_DemoPrintColor);
+		}
+	}
+
 	if(Mode == IDemoRecorder::EStopMode::KEEP_FILE)
 	{
 		// add the demo length to the header
@@ -626,7 +823,7 @@ bool CDemoPlayer::ScanFile()
 	return true;
 }
 
-void CDemoPlayer::DoTick()
+void CDemoPlayer::DoTick(bool Listener)
 {
 	// update ticks
 	m_Info.m_PreviousTick = m_Info.m_Info.m_CurrentTick;
@@ -639,9 +836,10 @@ void CDemoPlayer::DoTick()
 	m_Info.m_IntraTick = (m_Info.m_CurrentTime - PrevtickStart) / (float)(CurtickStart - PrevtickStart);
 	m_Info.m_IntraTickSincePrev = (m_Info.m_CurrentTime - PrevtickStart) / (float)(Freq / SERVER_TICK_SPEED);
 	m_Info.m_TickTime = (m_Info.m_CurrentTime - PrevtickStart) / (float)Freq;
-	if(m_UpdateIntraTimesFunc)
+	if(m_UpdateIntraTimesFunc && Listener)
 		m_UpdateIntraTimesFunc();
 
+	IListener *pListener = Listener ? m_pListener : nullptr;
 	bool GotSnapshot = false;
 	while(true)
 	{
@@ -721,8 +919,8 @@ void CDemoPlayer::DoTick()
 			}
 			else
 			{
-				if(m_pListener)
-					m_pListener->OnDemoPlayerSnapshot(m_aSnapshot, DataSize);
+				if(pListener)
+					pListener->OnDemoPlayerSnapshot(m_aSnapshot, DataSize);
 
 				m_LastSnapshotDataSize = DataSize;
 				mem_copy(m_aLastSnapshotData, m_aSnapshot, DataSize);
@@ -748,17 +946,17 @@ void CDemoPlayer::DoTick()
 
 				m_LastSnapshotDataSize = DataSize;
 				mem_copy(m_aLastSnapshotData, m_aChunkData, DataSize);
-				if(m_pListener)
-					m_pListener->OnDemoPlayerSnapshot(m_aChunkData, DataSize);
+				if(pListener)
+					pListener->OnDemoPlayerSnapshot(m_aChunkData, DataSize);
 			}
 		}
 		else
 		{
 			// if there were no snapshots in this tick, replay the last one
-			if(!GotSnapshot && m_pListener && m_LastSnapshotDataSize != -1)
+			if(!GotSnapshot && pListener && m_LastSnapshotDataSize != -1)
 			{
 				GotSnapshot = true;
-				m_pListener->OnDemoPlayerSnapshot(m_aLastSnapshotData, m_LastSnapshotDataSize);
+				pListener->OnDemoPlayerSnapshot(m_aLastSnapshotData, m_LastSnapshotDataSize);
 			}
 
 			// check the remaining types
@@ -769,8 +967,8 @@ void CDemoPlayer::DoTick()
 			}
 			else if(ChunkType == CHUNKTYPE_MESSAGE)
 			{
-				if(m_pListener)
-					m_pListener->OnDemoPlayerMessage(m_aChunkData, DataSize);
+				if(pListener)
+					pListener->OnDemoPlayerMessage(m_aChunkData, DataSize);
 			}
 		}
 	}
@@ -994,7 +1192,7 @@ int CDemoPlayer::SeekTick(ETickOffset TickOffset)
 
 int CDemoPlayer::SetPos(int WantedTick)
 {
-	if(!m_File)
+	if(!m_File || m_vKeyFrames.empty())
 		return -1;
 
 	WantedTick = clamp(WantedTick, m_Info.m_Info.m_FirstTick, m_Info.m_Info.m_LastTick);
@@ -1019,15 +1217,61 @@ int CDemoPlayer::SetPos(int WantedTick)
 	m_Info.m_Info.m_CurrentTick = -1;
 	m_Info.m_PreviousTick = -1;
 
-	// playback everything until we hit our tick
+	// apply everything until we hit our tick without passing it to the listener,
+	// but remember the state before the last two ticks to replay them afterwards
+	int NumTicks = 0;
 	while(m_Info.m_NextTick < WantedTick && IsPlaying())
-		DoTick();
+	{
+		if(!SaveSeekState(&m_aSeekStates[NumTicks % 2]))
+		{
+			Stop("Error reading demo position");
+			return -1;
+		}
+		DoTick(false);
+		NumTicks++;
+	}
+
+	// the listener needs the previous and the current snapshot
+	if(NumTicks > 0 && IsPlaying())
+	{
+		const int NumReplayTicks = minimum(NumTicks, 2);
+		if(!RestoreSeekState(&m_aSeekStates[(NumTicks - NumReplayTicks) % 2]))
+		{
+			Stop("Error seeking replay position");
+			return -1;
+		}
+		for(int i = 0; i < NumReplayTicks && IsPlaying(); i++)
+			DoTick();
+	}
 
 	Play();
 
 	return 0;
 }
 
+bool CDemoPlayer::SaveSeekState(CSeekState *pState)
+{
+	pState->m_Filepos = io_tell(m_File);
+	pState->m_NextTick = m_Info.m_NextTick;
+	pState->m_CurrentTick = m_Info.m_Info.m_CurrentTick;
+	pState->m_PreviousTick = m_Info.m_PreviousTick;
+	pState->m_LastSnapshotDataSize = m_LastSnapshotDataSize;
+	if(m_LastSnapshotDataSize > 0)
+		mem_copy(pState->m_aLastSnapshotData, m_aLastSnapshotData, m_LastSnapshotDataSize);
+	return pState->m_Filepos >= 0;
+}
+
+bool CDemoPlayer::RestoreSeekState(const CSeekState *pState)
+{
+	m_Info.m_NextTick = pState->m_NextTick;
+	m_Info.m_Info.m_CurrentTick = pState->m_CurrentTick;
+	m_Info.m_PreviousTick = pState->m_PreviousTick;
+	m_LastSnapshotDataSize = pState->m_LastSnapshotDataSize;
+	if(m_LastSnapshotDataSize > 0)
+		mem_copy(m_aLastSnapshotData, pState->m_aLastSnapshotData, m_LastSnapshotDataSize);
+	return io_seek(m_File, pState->m_Filepos, IOSEEK_START) == 0;
+}
+
 void CDemoPlayer::SetSpeed(float Speed)
 {
 	m_Info.m_Info.m_Speed = clamp(Speed, 0.f, 256.f);
@@ -1281,7 +1525,9 @@ bool CDemoEditor::Slice(const char *pDemo, const char *pDst, int StartTick, int
 	Listener.m_EndTick = EndTick;
 	DemoPlayer.SetListener(&Listener);
 
-	DemoPlayer.Play();
+	// the ticks before the start tick are not recorded, so skip them quickly
+	if(StartTick == -1 || DemoPlayer.SetPos(StartTick) != 0)
+		DemoPlayer.Play();
 
 	while(DemoPlayer.IsPlaying() && !Listener.m_Stop)
 	{
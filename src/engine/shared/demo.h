@@ -4,19 +4,97 @@
 #define ENGINE_SHARED_DEMO_H
 
 #include <base/hash.h>
+#include <base/lock.h>
 
 #include <engine/demo.h>
 #include <engine/shared/protocol.h>
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "snapshot.h"
 
 typedef std::function<void()> TUpdateIntraTimesFunc;
 
+class CDemoRecorder;
+
+/**
+ * Creates the snapshot deltas, compresses the chunks and writes the files of
+ * any number of demo recorders on one shared thread.
+ *
+ * The recording thread copies the raw snapshots and messages into a ring
+ * buffer shared by all recorders. If the buffer is full, the chunk is dropped
+ * instead of blocking the recording thread, the demo stays playable.
+ */
+class CDemoWriter
+{
+	friend class CDemoRecorder;
+
+	enum
+	{
+		DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024,
+		MAX_DATA_SIZE = 64 * 1024,
+	};
+
+	struct CEntry;
+
+	const int m_BufferSize;
+	std::unique_ptr<unsigned char[]> m_pBuffer;
+	// the positions only grow, the index into the buffer is the position modulo its size
+	std::atomic<uint64_t> m_ReadPos{0};
+	std::atomic<uint64_t> m_WritePos{0};
+	std::atomic<bool> m_Shutdown{false};
+	std::atomic<int> m_NumDropped{0};
+	// signaled once per entry and once on shutdown
+	SEMAPHORE m_Semaphore;
+	void *m_pThread = nullptr;
+	// held by the writer thread while it writes an entry
+	CLock m_PauseLock;
+
+	// serializes the recording threads
+	CLock m_PushLock;
+	int m_NumRecorders GUARDED_BY(m_PushLock) = 0;
+	// the snapshot delta of the recorders can be changed by the recording thread,
+	// the copy is only replaced while no recorder is using the writer
+	std::unique_ptr<CSnapshotDelta> m_pSnapshotDelta;
+
+	unsigned char m_aData[MAX_DATA_SIZE];
+
+	void CopyToBuffer(uint64_t Pos, const void *pData, int Size);
+	void CopyFromBuffer(uint64_t Pos, void *pData, int Size) const;
+	bool PushEntry(const CEntry &Entry, const void *pData, int Reserve) REQUIRES(m_PushLock);
+	static void ThreadFunc(void *pUser);
+	void Run();
+
+	void AddRecorder(const CSnapshotDelta &SnapshotDelta) EXCLUDES(m_PushLock);
+	bool Push(CDemoRecorder *pRecorder, int Type, const unsigned char *pTickMarker, int TickMarkerSize, const void *pData, int Size) EXCLUDES(m_PushLock);
+	// waits until all pushed chunks of the recorder are written
+	void RemoveRecorder(CDemoRecorder *pRecorder) EXCLUDES(m_PushLock);
+
+public:
+	CDemoWriter(int BufferSize = DEFAULT_BUFFER_SIZE);
+	~CDemoWriter();
+
+	int NumDropped() const { return m_NumDropped.load(); }
+
+	// keeps the writer thread from writing chunks until Resume is called, the
+	// recorders keep pushing and drop chunks once the buffer is full, they
+	// must not be stopped while the writer is paused
+	void Pause() NO_THREAD_SAFETY_ANALYSIS { m_PauseLock.lock(); }
+	void Resume() NO_THREAD_SAFETY_ANALYSIS { m_PauseLock.unlock(); }
+};
+
 class CDemoRecorder : public IDemoRecorder
 {
+	friend class CDemoWriter;
+
+	enum
+	{
+		MAX_TICKMARKER_SIZE = sizeof(int32_t) + 1,
+	};
+
 	class IConsole *m_pConsole;
 	class IStorage *m_pStorage;
 
@@ -37,7 +115,12 @@ class CDemoRecorder : public IDemoRecorder
 	DEMOFUNC_FILTER m_pfnFilter;
 	void *m_pUser;
 
-	void WriteTickMarker(int Tick, bool Keyframe);
+	// only set while recording with a writer thread
+	CDemoWriter *m_pWriter = nullptr;
+	int m_NumDropped;
+
+	int CreateTickMarker(int Tick, bool Keyframe, unsigned char *pTickMarker);
+	void WriteSnapshot(int Type, const unsigned char *pTickMarker, int TickMarkerSize, const void *pData, int Size, class CSnapshotDelta *pSnapshotDelta);
 	void Write(int Type, const void *pData, int Size);
 
 public:
@@ -45,7 +128,15 @@ public:
 	CDemoRecorder() {}
 	~CDemoRecorder() override;
 
-	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetversion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned MapCrc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser);
+	/**
+	 * Starts recording to the given file.
+	 *
+	 * With a `pWriter` the snapshots and messages are only copied by the
+	 * recording functions, the delta creation, compression and file writes
+	 * happen on the thread of the writer. The written file is the same as
+	 * long as the writer does not drop chunks.
+	 */
+	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetversion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned MapCrc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser, CDemoWriter *pWriter = nullptr);
 	int Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilename = "") override;
 
 	void AddDemoMarker();
@@ -129,6 +220,21 @@ private:
 	int m_LastSnapshotDataSize;
 	class CSnapshotDelta *m_pSnapshotDelta;
 
+	// Playback state before one of the last ticks while seeking,
+	// used to replay them with the listener.
+	struct CSeekState
+	{
+		int64_t m_Filepos;
+		int m_NextTick;
+		int m_CurrentTick;
+		int m_PreviousTick;
+		int m_LastSnapshotDataSize;
+		unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
+	};
+	CSeekState m_aSeekStates[2];
+	bool SaveSeekState(CSeekState *pState);
+	bool RestoreSeekState(const CSeekState *pState);
+
 	bool m_UseVideo;
 #if defined(CONF_VIDEORECORDER)
 	bool m_WasRecording = false;
@@ -141,7 +247,12 @@ private:
 		CHUNKHEADER_EOF,
 	};
 	EReadChunkHeaderResult ReadChunkHeader(int *pType, int *pSize, int *pTick);
-	void DoTick();
+	/**
+	 * Plays back the chunks of the next tick. Without `Listener` only the
+	 * snapshot state of the player is updated, neither the listener nor the
+	 * intra times callback are called.
+	 */
+	void DoTick(bool Listener = true);
 	bool ScanFile();
 
 	int64_t Time();
@@ -41,6 +41,7 @@ void CHuffman::Setbits_r(CNode *pNode, int Bits, unsigned Depth)
 	{
 		pNode->m_Bits = Bits;
 		pNode->m_NumBits = Depth;
+		m_MaxCodeBits = std::max(m_MaxCodeBits, Depth);
 	}
 }
 
@@ -97,6 +98,7 @@ void CHuffman::Init(const unsigned *pFrequencies)
 	mem_zero(m_apDecodeLut, sizeof(m_apDecodeLut));
 	m_pStartNode = 0x0;
 	m_NumNodes = 0;
+	m_MaxCodeBits = 0;
 
 	// construct the tree
 	ConstructTree(pFrequencies);
@@ -125,82 +127,125 @@ void CHuffman::Init(const unsigned *pFrequencies)
 		if(k == HUFFMAN_LUTBITS)
 			m_apDecodeLut[i] = pNode;
 	}
+
+	ConstructMultiDecodeLut();
+}
+
+void CHuffman::ConstructMultiDecodeLut()
+{
+	for(int i = 0; i < HUFFMAN_LUTSIZE; i++)
+	{
+		CMultiSymbol &Entry = m_aMultiDecodeLut[i];
+		mem_zero(&Entry, sizeof(Entry));
+
+		// decode symbols as long as they end within the index bits, the EOF
+		// symbol is left to the single symbol path
+		unsigned Bits = i;
+		unsigned Bitcount = HUFFMAN_LUTBITS;
+		while(Entry.m_NumSymbols < HUFFMAN_MULTI_MAX_SYMBOLS)
+		{
+			const CNode *pNode = m_pStartNode;
+			unsigned Used = 0;
+			while(!pNode->m_NumBits && Used < Bitcount)
+			{
+				pNode = &m_aNodes[pNode->m_aLeafs[(Bits >> Used) & 1]];
+				Used++;
+			}
+			if(!pNode->m_NumBits || pNode == &m_aNodes[HUFFMAN_EOF_SYMBOL])
+				break;
+
+			Entry.m_aSymbols[Entry.m_NumSymbols++] = pNode->m_Symbol;
+			Entry.m_NumBits += Used;
+			Bits >>= Used;
+			Bitcount -= Used;
+		}
+
+		const CNode *pLutNode = m_apDecodeLut[i];
+		Entry.m_Node = pLutNode && !pLutNode->m_NumBits ? pLutNode - m_aNodes : 0xffff;
+	}
 }
 
 //***************************************************************
 int CHuffman::Compress(const void *pInput, int InputSize, void *pOutput, int OutputSize) const
 {
-	// this macro loads a symbol for a byte into bits and bitcount
-#define HUFFMAN_MACRO_LOADSYMBOL(Sym) \
-	do \
-	{ \
-		Bits |= m_aNodes[Sym].m_Bits << Bitcount; \
-		Bitcount += m_aNodes[Sym].m_NumBits; \
-	} while(0)
-
-	// this macro writes the symbol stored in bits and bitcount to the dst pointer
-#define HUFFMAN_MACRO_WRITE() \
-	do \
-	{ \
-		while(Bitcount >= 8) \
-		{ \
-			*pDst++ = (unsigned char)(Bits & 0xff); \
-			if(pDst == pDstEnd) \
-				return -1; \
-			Bits >>= 8; \
-			Bitcount -= 8; \
-		} \
-	} while(0)
-
 	// setup buffer pointers
 	const unsigned char *pSrc = (const unsigned char *)pInput;
 	const unsigned char *pSrcEnd = pSrc + InputSize;
 	unsigned char *pDst = (unsigned char *)pOutput;
 	unsigned char *pDstEnd = pDst + OutputSize;
 
-	// symbol variables
-	unsigned Bits = 0;
+	// symbol variables, codes are at most 32 bits so the 64 bit buffer never overflows
+	uint64_t Bits = 0;
 	unsigned Bitcount = 0;
 
-	// make sure that we have data that we want to compress
-	if(InputSize)
+	// write 32 bits at a time as long as it leaves room for the last byte
+	while(pSrc != pSrcEnd && pDstEnd - pDst > 4)
 	{
-		// {A} load the first symbol
-		int Symbol = *pSrc++;
-
-		while(pSrc != pSrcEnd)
+		while(Bitcount < 32 && pSrc != pSrcEnd)
 		{
-			// {B} load the symbol
-			HUFFMAN_MACRO_LOADSYMBOL(Symbol);
-
-			// {C} fetch next symbol, this is done here because it will reduce dependency in the code
-			Symbol = *pSrc++;
+			const CNode &Node = m_aNodes[*pSrc++];
+			Bits |= (uint64_t)Node.m_Bits << Bitcount;
+			Bitcount += Node.m_NumBits;
+		}
+		if(Bitcount >= 32)
+		{
+			pDst[0] = (unsigned char)Bits;
+			pDst[1] = (unsigned char)(Bits >> 8);
+			pDst[2] = (unsigned char)(Bits >> 16);
+			pDst[3] = (unsigned char)(Bits >> 24);
+			pDst += 4;
+			Bits >>= 32;
+			Bitcount -= 32;
+		}
+	}
 
-			// {B} write the symbol loaded at
-			HUFFMAN_MACRO_WRITE();
+	// close to the end of the output, write byte by byte and fail once the
+	// output is full, the last byte is reserved for the remaining bits
+	auto &&LoadSymbol = [&](int Symbol) {
+		Bits |= (uint64_t)m_aNodes[Symbol].m_Bits << Bitcount;
+		Bitcount += m_aNodes[Symbol].m_NumBits;
+		while(Bitcount >= 8)
+		{
+			if(pDst == pDstEnd)
+				return false;
+			*pDst++ = (unsigned char)(Bits & 0xff);
+			if(pDst == pDstEnd)
+				return false;
+			Bits >>= 8;
+			Bitcount -= 8;
 		}
+		return true;
+	};
 
-		// write the last symbol loaded from {C} or {A} in the case of only 1 byte input buffer
-		HUFFMAN_MACRO_LOADSYMBOL(Symbol);
-		HUFFMAN_MACRO_WRITE();
+	while(pSrc != pSrcEnd)
+	{
+		if(!LoadSymbol(*pSrc++))
+			return -1;
 	}
 
 	// write EOF symbol
-	HUFFMAN_MACRO_LOADSYMBOL(HUFFMAN_EOF_SYMBOL);
-	HUFFMAN_MACRO_WRITE();
+	if(!LoadSymbol(HUFFMAN_EOF_SYMBOL))
+		return -1;
 
 	// write out the last bits
-	*pDst++ = Bits;
+	if(pDst == pDstEnd)
+		return -1;
+	*pDst++ = (unsigned char)Bits;
 
 	// return the size of the output
 	return (int)(pDst - (const unsigned char *)pOutput);
-
-	// remove macros
-#undef HUFFMAN_MACRO_LOADSYMBOL
-#undef HUFFMAN_MACRO_WRITE
 }
 
 //***************************************************************
+static inline uint64_t ReadLittleEndian64(const unsigned char *pSrc)
+{
+	// compiles to a single load on little endian machines
+	uint64_t Result = 0;
+	for(int i = 0; i < 8; i++)
+		Result |= (uint64_t)pSrc[i] << (i * 8);
+	return Result;
+}
+
 int CHuffman::Decompress(const void *pInput, int InputSize, void *pOutput, int OutputSize) const
 {
 	// setup buffer pointers
@@ -209,29 +254,73 @@ int CHuffman::Decompress(const void *pInput, int InputSize, void *pOutput, int O
 	unsigned char *pDstEnd = pDst + OutputSize;
 	unsigned char *pSrcEnd = pSrc + InputSize;
 
-	unsigned Bits = 0;
+	uint64_t Bits = 0;
 	unsigned Bitcount = 0;
 
 	const CNode *pEof = &m_aNodes[HUFFMAN_EOF_SYMBOL];
+	// a local copy, the member would be reloaded after every write to the output
+	const unsigned MaxCodeBits = m_MaxCodeBits;
 
 	while(true)
 	{
-		// {A} try to load a node now, this will reduce dependency at location {D}
-		const CNode *pNode = 0;
-		if(Bitcount >= HUFFMAN_LUTBITS)
-			pNode = m_apDecodeLut[Bits & HUFFMAN_LUTMASK];
-
-		// {B} fill with new bits
-		while(Bitcount < 24 && pSrc != pSrcEnd)
+		// {A} fill with new bits
+		while(Bitcount <= 56 && pSrc != pSrcEnd)
 		{
-			Bits |= (*pSrc++) << Bitcount;
+			Bits |= (uint64_t)(*pSrc++) << Bitcount;
 			Bitcount += 8;
 		}
 
-		// {C} load symbol now if we didn't that earlier at location {A}
-		if(!pNode)
-			pNode = m_apDecodeLut[Bits & HUFFMAN_LUTMASK];
+		// {B} decode as many short symbols per lookup as possible, while all
+		// bits of the longest code are there long symbols are decoded here too
+		while(pDstEnd - pDst >= HUFFMAN_MULTI_MAX_SYMBOLS)
+		{
+			if(Bitcount < MaxCodeBits)
+			{
+				if(pSrcEnd - pSrc < 8)
+					break;
+				// refill without a loop, the bits above Bitcount are the next
+				// input bits, so loading them again with the next refill is fine
+				Bits |= ReadLittleEndian64(pSrc) << Bitcount;
+				pSrc += (63 - Bitcount) >> 3;
+				Bitcount |= 56;
+				if(Bitcount < MaxCodeBits)
+					break;
+			}
+
+			const CMultiSymbol &Entry = m_aMultiDecodeLut[Bits & HUFFMAN_LUTMASK];
+			if(Entry.m_NumSymbols)
+			{
+				// std::copy_n with a constant size is inlined, mem_copy is a function call
+				std::copy_n(Entry.m_aSymbols, (int)HUFFMAN_MULTI_MAX_SYMBOLS, pDst);
+				pDst += Entry.m_NumSymbols;
+				Bits >>= Entry.m_NumBits;
+				Bitcount -= Entry.m_NumBits;
+				continue;
+			}
+
+			// EOF within the index bits
+			if(Entry.m_Node == 0xffff)
+				break;
+
+			// walk the rest of a long symbol, the code can't run out of bits here
+			const CNode *pNode = &m_aNodes[Entry.m_Node];
+			Bits >>= HUFFMAN_LUTBITS;
+			Bitcount -= HUFFMAN_LUTBITS;
+			do
+			{
+				pNode = &m_aNodes[pNode->m_aLeafs[Bits & 1]];
+				Bitcount--;
+				Bits >>= 1;
+			} while(!pNode->m_NumBits);
+			if(pNode == pEof)
+				return (int)(pDst - (const unsigned char *)pOutput);
+			*pDst++ = pNode->m_Symbol;
+		}
+		if(Bitcount <= 56 && pSrc != pSrcEnd)
+			continue;
 
+		// {C} decode a single symbol, needed for long symbols, EOF and the end of the buffers
+		const CNode *pNode = m_apDecodeLut[Bits & HUFFMAN_LUTMASK];
 		if(!pNode)
 			return -1;
 
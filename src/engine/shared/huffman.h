@@ -14,7 +14,9 @@ class CHuffman
 
 		HUFFMAN_LUTBITS = 10,
 		HUFFMAN_LUTSIZE = (1 << HUFFMAN_LUTBITS),
-		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE - 1)
+		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE - 1),
+
+		HUFFMAN_MULTI_MAX_SYMBOLS = 6,
 	};
 
 	struct CNode
@@ -30,15 +32,29 @@ class CHuffman
 		unsigned char m_Symbol;
 	};
 
+	// all symbols that are fully contained in the bits of a LUT index,
+	// allows decoding several short symbols with one lookup. If the first
+	// symbol is longer, m_Node is the tree node reached after the index bits.
+	struct CMultiSymbol
+	{
+		unsigned char m_aSymbols[HUFFMAN_MULTI_MAX_SYMBOLS];
+		unsigned char m_NumSymbols;
+		unsigned char m_NumBits;
+		unsigned short m_Node;
+	};
+
 	static const unsigned ms_aFreqTable[HUFFMAN_MAX_SYMBOLS];
 
 	CNode m_aNodes[HUFFMAN_MAX_NODES];
 	CNode *m_apDecodeLut[HUFFMAN_LUTSIZE];
+	CMultiSymbol m_aMultiDecodeLut[HUFFMAN_LUTSIZE];
 	CNode *m_pStartNode;
 	int m_NumNodes;
+	unsigned m_MaxCodeBits;
 
 	void Setbits_r(CNode *pNode, int Bits, unsigned Depth);
 	void ConstructTree(const unsigned *pFrequencies);
+	void ConstructMultiDecodeLut();
 
 public:
 	/*
@@ -0,0 +1,110 @@
+#include "snapshot_stats.h"
+
+#include <base/system.h>
+
+#include <engine/shared/json.h>
+#include <engine/shared/snapshot.h>
+
+#include <algorithm>
+
+void CSnapshotStats::Reset()
+{
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+		ResetClient(ClientId);
+}
+
+void CSnapshotStats::ResetClient(int ClientId)
+{
+	m_aClients[ClientId] = CCounters();
+	m_aClientTypes[ClientId].clear();
+}
+
+void CSnapshotStats::AddSnapshot(int ClientId, bool Sixup, const CSnapshot *pSnapshot, int Size)
+{
+	CCounters &Counters = m_aClients[ClientId];
+	Counters.m_Snapshots++;
+	Counters.m_Items += pSnapshot->NumItems();
+	Counters.m_RawBytes += Size;
+
+	std::map<int64_t, CTypeCounters> &Types = m_aClientTypes[ClientId];
+	for(int i = 0; i < pSnapshot->NumItems(); i++)
+	{
+		CTypeCounters &TypeCounters = Types[TypeKey(pSnapshot->GetItemType(i), Sixup)];
+		TypeCounters.m_Items++;
+		TypeCounters.m_RawBytes += sizeof(CSnapshotItem) + pSnapshot->GetItemSize(i);
+	}
+}
+
+void CSnapshotStats::AddDelta(int ClientId, int DeltaSize, int CompressedSize, int NumPackets)
+{
+	CCounters &Counters = m_aClients[ClientId];
+	Counters.m_DeltaBytes += DeltaSize;
+	Counters.m_CompressedBytes += CompressedSize;
+	Counters.m_Packets += NumPackets;
+}
+
+CSnapshotStats::CCounters CSnapshotStats::Total() const
+{
+	CCounters Total;
+	for(const CCounters &Counters : m_aClients)
+	{
+		Total.m_Snapshots += Counters.m_Snapshots;
+		Total.m_Items += Counters.m_Items;
+		Total.m_RawBytes += Counters.m_RawBytes;
+		Total.m_DeltaBytes += Counters.m_DeltaBytes;
+		Total.m_CompressedBytes += Counters.m_CompressedBytes;
+		Total.m_Packets += Counters.m_Packets;
+	}
+	return Total;
+}
+
+std::vector<CSnapshotStats::CType> CSnapshotStats::TopTypes(int ClientId, int MaxTypes) const
+{
+	std::map<int64_t, CTypeCounters> Sum;
+	for(int Id = 0; Id < MAX_CLIENTS; Id++)
+	{
+		if(ClientId != -1 && Id != ClientId)
+			continue;
+		for(const auto &[Key, Counters] : m_aClientTypes[Id])
+		{
+			CTypeCounters &SumCounters = Sum[Key];
+			SumCounters.m_Items += Counters.m_Items;
+			SumCounters.m_RawBytes += Counters.m_RawBytes;
+		}
+	}
+
+	std::vector<CType> vTypes;
+	vTypes.reserve(Sum.size());
+	for(const auto &[Key, Counters] : Sum)
+		vTypes.push_back({(int)(uint32_t)Key, (Key >> 32) != 0, Counters});
+	std::stable_sort(vTypes.begin(), vTypes.end(), [](const CType &Left, const CType &Right) {
+		return Left.m_Counters.m_RawBytes > Right.m_Counters.m_RawBytes;
+	});
+	if((int)vTypes.size() > MaxTypes)
+		vTypes.resize(MaxTypes);
+	return vTypes;
+}
+
+std::string CSnapshotStats::FormatJson(int ClientId, int MaxTypes, FTypeName pfnTypeName) const
+{
+	const CCounters Counters = ClientId == -1 ? Total() : Client(ClientId);
+
+	char aBuf[512];
+	str_format(aBuf, sizeof(aBuf),
+		"{\"client\":%d,\"snapshots\":%" PRId64 ",\"items\":%" PRId64 ",\"raw_bytes\":%" PRId64 ",\"delta_bytes\":%" PRId64 ",\"compressed_bytes\":%" PRId64 ",\"packets\":%" PRId64 ",\"types\":[",
+		ClientId, Counters.m_Snapshots, Counters.m_Items, Counters.m_RawBytes, Counters.m_DeltaBytes, Counters.m_CompressedBytes, Counters.m_Packets);
+	std::string Json = aBuf;
+
+	bool First = true;
+	for(const CType &Type : TopTypes(ClientId, MaxTypes))
+	{
+		char aName[128];
+		EscapeJson(aName, sizeof(aName), pfnTypeName ? pfnTypeName(Type.m_Type, Type.m_Sixup) : "");
+		str_format(aBuf, sizeof(aBuf), "%s{\"type\":%d,\"name\":\"%s\",\"sixup\":%s,\"items\":%" PRId64 ",\"raw_bytes\":%" PRId64 "}",
+			First ? "" : ",", Type.m_Type, aName, Type.m_Sixup ? "true" : "false", Type.m_Counters.m_Items, Type.m_Counters.m_RawBytes);
+		Json += aBuf;
+		First = false;
+	}
+	Json += "]}";
+	return Json;
+}
@@ -0,0 +1,83 @@
+#ifndef ENGINE_SHARED_SNAPSHOT_STATS_H
+#define ENGINE_SHARED_SNAPSHOT_STATS_H
+
+#include <engine/shared/protocol.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class CSnapshot;
+
+/**
+ * Accumulates how large the snapshots sent to each client are, in total and
+ * per item type, since the last @link Reset @endlink.
+ *
+ * Item types are the external types of the snapshot items, so extended
+ * items are counted by their UUID type. Types of 0.7 clients are counted
+ * separately because their numbers overlap with the 0.6 types.
+ */
+class CSnapshotStats
+{
+public:
+	struct CCounters
+	{
+		int64_t m_Snapshots = 0;
+		int64_t m_Items = 0;
+		int64_t m_RawBytes = 0;
+		int64_t m_DeltaBytes = 0;
+		int64_t m_CompressedBytes = 0;
+		int64_t m_Packets = 0;
+	};
+
+	struct CTypeCounters
+	{
+		int64_t m_Items = 0;
+		int64_t m_RawBytes = 0;
+	};
+
+	struct CType
+	{
+		int m_Type;
+		bool m_Sixup;
+		CTypeCounters m_Counters;
+	};
+
+	typedef const char *(*FTypeName)(int Type, bool Sixup);
+
+	void Reset();
+	void ResetClient(int ClientId);
+
+	/**
+	 * Counts the items of a snapshot that was built for a client.
+	 */
+	void AddSnapshot(int ClientId, bool Sixup, const CSnapshot *pSnapshot, int Size);
+	/**
+	 * Counts the delta of the last snapshot that was sent to a client.
+	 */
+	void AddDelta(int ClientId, int DeltaSize, int CompressedSize, int NumPackets);
+
+	const CCounters &Client(int ClientId) const { return m_aClients[ClientId]; }
+	CCounters Total() const;
+
+	/**
+	 * Returns the item types ordered by the number of raw bytes, largest
+	 * first. If `ClientId` is -1, the types of all clients are summed up.
+	 */
+	std::vector<CType> TopTypes(int ClientId, int MaxTypes) const;
+
+	/**
+	 * Formats a single JSON object with the totals and the largest item types
+	 * of a client, or of all clients if `ClientId` is -1.
+	 */
+	std::string FormatJson(int ClientId, int MaxTypes, FTypeName pfnTypeName) const;
+
+private:
+	static int64_t TypeKey(int Type, bool Sixup) { return ((int64_t)Sixup << 32) | (uint32_t)Type; }
+
+	CCounters m_aClients[MAX_CLIENTS];
+	std::map<int64_t, CTypeCounters> m_aClientTypes[MAX_CLIENTS];
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef ENGINE_SHARED_SPSC_QUEUE_H
+#define ENGINE_SHARED_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. `TSIZE` must be a power of two, one slot is kept free to tell a full
+ * queue from an empty one.
+ */
+template<typename T, size_t TSIZE>
+class CSpscQueue
+{
+	static_assert(TSIZE >= 2 && (TSIZE & (TSIZE - 1)) == 0, "Size must be a power of two");
+
+	T m_aItems[TSIZE] = {};
+	alignas(64) std::atomic<size_t> m_Head = 0; // next item to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_Tail = 0; // next slot to push, written by the producer
+
+public:
+	/**
+	 * Must only be called by the producer. Returns `false` if the queue is full.
+	 */
+	bool Push(const T &Item)
+	{
+		const size_t Tail = m_Tail.load(std::memory_order_relaxed);
+		const size_t NextTail = (Tail + 1) & (TSIZE - 1);
+		if(NextTail == m_Head.load(std::memory_order_acquire))
+			return false;
+		m_aItems[Tail] = Item;
+		m_Tail.store(NextTail, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Must only be called by the consumer. Returns `false` if the queue is empty.
+	 */
+	bool Pop(T *pItem)
+	{
+		const size_t Head = m_Head.load(std::memory_order_relaxed);
+		if(Head == m_Tail.load(std::memory_order_acquire))
+			return false;
+		*pItem = m_aItems[Head];
+		m_Head.store((Head + 1) & (TSIZE - 1), std::memory_order_release);
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "tick_profiler.h"
+
+#include <base/math.h>
+
+#include <engine/shared/jsonwriter.h>
+
+#include <algorithm>
+
+CTickProfiler::CTickProfiler() :
+	m_Enabled(false),
+	m_NumPhases(0),
+	m_TraceTicksLeft(-1)
+{
+	Reset();
+}
+
+int CTickProfiler::RegisterPhase(const char *pName)
+{
+	for(int i = 0; i < m_NumPhases; i++)
+	{
+		if(str_comp(m_aaPhaseNames[i], pName) == 0)
+			return i;
+	}
+	if(m_NumPhases == MAX_PHASES)
+		return -1;
+	str_copy(m_aaPhaseNames[m_NumPhases], pName);
+	m_aCurrent[m_NumPhases] = 0;
+	m_aRan[m_NumPhases] = false;
+	std::fill(std::begin(m_aaHistory[m_NumPhases]), std::end(m_aaHistory[m_NumPhases]), 0);
+	m_aHistoryPos[m_NumPhases] = 0;
+	m_aNumSamples[m_NumPhases] = 0;
+	return m_NumPhases++;
+}
+
+void CTickProfiler::SetEnabled(bool Enabled)
+{
+	if(m_Enabled == Enabled)
+		return;
+	m_Enabled = Enabled;
+	Reset();
+}
+
+void CTickProfiler::Add(int Phase, std::chrono::nanoseconds Duration)
+{
+	if(Phase < 0 || Phase >= m_NumPhases)
+		return;
+	m_aCurrent[Phase] += Duration.count();
+	m_aRan[Phase] = true;
+}
+
+void CTickProfiler::Add(int Phase, std::chrono::nanoseconds StartTime, std::chrono::nanoseconds Duration)
+{
+	Add(Phase, Duration);
+	if(m_TraceTicksLeft > 0 && Phase >= 0 && Phase < m_NumPhases && m_vTraceEvents.size() < MAX_TRACE_EVENTS)
+		m_vTraceEvents.push_back({Phase, StartTime.count(), Duration.count()});
+}
+
+void CTickProfiler::EndTick()
+{
+	if(!m_Enabled)
+		return;
+	for(int i = 0; i < m_NumPhases; i++)
+	{
+		if(!m_aRan[i])
+			continue;
+		m_aaHistory[i][m_aHistoryPos[i]] = m_aCurrent[i];
+		m_aHistoryPos[i] = (m_aHistoryPos[i] + 1) % HISTORY_SIZE;
+		m_aNumSamples[i] = minimum(m_aNumSamples[i] + 1, (int)HISTORY_SIZE);
+		m_aCurrent[i] = 0;
+		m_aRan[i] = false;
+	}
+	m_NumTicks = minimum(m_NumTicks + 1, (int)HISTORY_SIZE);
+	if(m_TraceTicksLeft > 0)
+		m_TraceTicksLeft--;
+}
+
+void CTickProfiler::Reset()
+{
+	std::fill(std::begin(m_aCurrent), std::end(m_aCurrent), 0);
+	std::fill(std::begin(m_aRan), std::end(m_aRan), false);
+	for(auto &aHistory : m_aaHistory)
+		std::fill(std::begin(aHistory), std::end(aHistory), 0);
+	std::fill(std::begin(m_aHistoryPos), std::end(m_aHistoryPos), 0);
+	std::fill(std::begin(m_aNumSamples), std::end(m_aNumSamples), 0);
+	m_NumTicks = 0;
+	ClearTrace();
+}
+
+CTickProfiler::CStats CTickProfiler::Stats(int Phase) const
+{
+	if(Phase < 0 || Phase >= m_NumPhases)
+		return {0, 0, 0, 0};
+	const int NumSamples = m_aNumSamples[Phase];
+	CStats Stats = {NumSamples, 0, 0, 0};
+	if(NumSamples == 0)
+		return Stats;
+
+	// the history is a ring buffer, but only filled from the start until it wraps
+	int64_t aSamples[HISTORY_SIZE];
+	std::copy(m_aaHistory[Phase], m_aaHistory[Phase] + NumSamples, aSamples);
+	int64_t *pEnd = aSamples + NumSamples;
+
+	int64_t *pP50 = aSamples + (NumSamples - 1) / 2;
+	std::nth_element(aSamples, pP50, pEnd);
+	Stats.m_P50 = *pP50 / 1000;
+	int64_t *pP99 = aSamples + (NumSamples - 1) * 99 / 100;
+	std::nth_element(pP50, pP99, pEnd);
+	Stats.m_P99 = *pP99 / 1000;
+	Stats.m_Max = *std::max_element(pP99, pEnd) / 1000;
+	return Stats;
+}
+
+void CTickProfiler::FormatStats(int Phase, char *pBuf, int BufSize) const
+{
+	const CStats Stats = this->Stats(Phase);
+	str_format(pBuf, BufSize, "phase=%s samples=%d p50=%" PRId64 " p99=%" PRId64 " max=%" PRId64,
+		PhaseName(Phase), Stats.m_NumSamples, Stats.m_P50, Stats.m_P99, Stats.m_Max);
+}
+
+void CTickProfiler::StartTrace(int NumTicks)
+{
+	m_vTraceEvents.clear();
+	m_TraceTicksLeft = maximum(NumTicks, 1);
+}
+
+void CTickProfiler::ClearTrace()
+{
+	m_vTraceEvents.clear();
+	m_vTraceEvents.shrink_to_fit();
+	m_TraceTicksLeft = -1;
+}
+
+void CTickProfiler::WriteChromeTrace(CJsonWriter *pWriter) const
+{
+	// scopes are recorded when they end, so nested scopes come before their parents
+	int64_t TraceStart = m_vTraceEvents.empty() ? 0 : m_vTraceEvents.front().m_StartTime;
+	for(const CTraceEvent &Event : m_vTraceEvents)
+		TraceStart = minimum(TraceStart, Event.m_StartTime);
+
+	pWriter->BeginObject();
+	pWriter->WriteAttribute("displayTimeUnit");
+	pWriter->WriteStrValue("ms");
+	pWriter->WriteAttribute("traceEvents");
+	pWriter->BeginArray();
+	for(const CTraceEvent &Event : m_vTraceEvents)
+	{
+		// complete events, timestamps in microseconds relative to the first scope
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("name");
+		pWriter->WriteStrValue(PhaseName(Event.m_Phase));
+		pWriter->WriteAttribute("ph");
+		pWriter->WriteStrValue("X");
+		pWriter->WriteAttribute("ts");
+		pWriter->WriteIntValue((Event.m_StartTime - TraceStart) / 1000);
+		pWriter->WriteAttribute("dur");
+		pWriter->WriteIntValue(Event.m_Duration / 1000);
+		pWriter->WriteAttribute("pid");
+		pWriter->WriteIntValue(1);
+		pWriter->WriteAttribute("tid");
+		pWriter->WriteIntValue(1);
+		pWriter->EndObject();
+	}
+	pWriter->EndArray();
+	pWriter->EndObject();
+}
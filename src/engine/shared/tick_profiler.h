@@ -0,0 +1,143 @@
+#ifndef ENGINE_SHARED_TICK_PROFILER_H
+#define ENGINE_SHARED_TICK_PROFILER_H
+
+#include <base/system.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class CJsonWriter;
+
+/**
+ * Collects how long the phases of each server tick or client frame took and
+ * keeps the last @link HISTORY_SIZE @endlink samples of each phase for
+ * percentile statistics.
+ *
+ * Phases are registered by name, the time spent in a phase is summed up
+ * until the tick is finished with @link EndTick @endlink. Only ticks in
+ * which a phase ran add a sample for it, e.g. the snapshot phases are not
+ * diluted by the ticks without snapshots. Nothing is measured while the
+ * profiler is disabled.
+ */
+class CTickProfiler
+{
+public:
+	enum
+	{
+		MAX_PHASES = 96,
+		MAX_PHASE_NAME_LENGTH = 32,
+		HISTORY_SIZE = 500,
+		MAX_TRACE_EVENTS = 1 << 20,
+	};
+
+	/**
+	 * Statistics over the recorded samples of one phase, times in microseconds.
+	 */
+	struct CStats
+	{
+		int m_NumSamples;
+		int64_t m_P50;
+		int64_t m_P99;
+		int64_t m_Max;
+	};
+
+	/**
+	 * Adds the time from construction to destruction to a phase.
+	 */
+	class CScope
+	{
+		CTickProfiler *m_pProfiler;
+		int m_Phase;
+		std::chrono::nanoseconds m_StartTime;
+
+	public:
+		CScope(CTickProfiler *pProfiler, int Phase) :
+			m_pProfiler(pProfiler->Enabled() ? pProfiler : nullptr),
+			m_Phase(Phase),
+			m_StartTime(m_pProfiler ? time_get_nanoseconds() : std::chrono::nanoseconds(0))
+		{
+		}
+		~CScope()
+		{
+			if(m_pProfiler)
+				m_pProfiler->Add(m_Phase, m_StartTime, time_get_nanoseconds() - m_StartTime);
+		}
+		CScope(const CScope &Other) = delete;
+		CScope &operator=(const CScope &Other) = delete;
+	};
+
+	CTickProfiler();
+
+	/**
+	 * Returns the id of the phase with the given name, registering it if it
+	 * doesn't exist yet. Returns -1 if there is no space left.
+	 */
+	int RegisterPhase(const char *pName);
+	int NumPhases() const { return m_NumPhases; }
+	const char *PhaseName(int Phase) const { return m_aaPhaseNames[Phase]; }
+
+	bool Enabled() const { return m_Enabled; }
+	void SetEnabled(bool Enabled);
+
+	void Add(int Phase, std::chrono::nanoseconds Duration);
+	/**
+	 * Like @link Add @endlink, but also records the scope for the trace if
+	 * one is being recorded.
+	 */
+	void Add(int Phase, std::chrono::nanoseconds StartTime, std::chrono::nanoseconds Duration);
+	/**
+	 * Stores the times of the current tick in the history and starts the
+	 * next tick.
+	 */
+	void EndTick();
+	void Reset();
+
+	int NumTicks() const { return m_NumTicks; }
+	CStats Stats(int Phase) const;
+
+	/**
+	 * Formats the statistics of a phase as a single line of space separated
+	 * key=value pairs, e.g. `phase=snapshot samples=500 p50=120 p99=480 max=950`.
+	 */
+	void FormatStats(int Phase, char *pBuf, int BufSize) const;
+
+	/**
+	 * Records every scope of the next `NumTicks` ticks, replacing the
+	 * previous trace.
+	 */
+	void StartTrace(int NumTicks);
+	bool TraceFinished() const { return m_TraceTicksLeft == 0; }
+	void ClearTrace();
+	int NumTraceEvents() const { return m_vTraceEvents.size(); }
+	/**
+	 * Writes the recorded trace in the Chrome trace event format, which can
+	 * be opened with chrome://tracing or Perfetto.
+	 */
+	void WriteChromeTrace(CJsonWriter *pWriter) const;
+
+private:
+	struct CTraceEvent
+	{
+		int m_Phase;
+		int64_t m_StartTime;
+		int64_t m_Duration;
+	};
+
+	bool m_Enabled;
+	int m_NumPhases;
+	char m_aaPhaseNames[MAX_PHASES][MAX_PHASE_NAME_LENGTH];
+
+	int64_t m_aCurrent[MAX_PHASES];
+	bool m_aRan[MAX_PHASES];
+	int64_t m_aaHistory[MAX_PHASES][HISTORY_SIZE];
+	int m_aHistoryPos[MAX_PHASES];
+	int m_aNumSamples[MAX_PHASES];
+	int m_NumTicks;
+
+	// -1 if no trace is being recorded, 0 once the trace is finished
+	int m_TraceTicksLeft;
+	std::vector<CTraceEvent> m_vTraceEvents;
+};
+
+#endif
@@ -328,6 +328,8 @@ public:
 	virtual bool LoadFonts() = 0;
 	virtual void SetFontPreset(EFontPreset FontPreset) = 0;
 	virtual void SetFontLanguageVariant(const char *pLanguageFile) = 0;
+	// Renders the printable ASCII glyphs for the given font sizes in the current screen mapping
+	virtual void PrewarmGlyphs(const float *pFontSizes, size_t NumFontSizes) = 0;
 
 	virtual void SetRenderFlags(unsigned Flags) = 0;
 	virtual unsigned GetRenderFlags() const = 0;
@@ -384,6 +386,9 @@ class IEngineTextRender : public ITextRender
 public:
 	virtual void Init() = 0;
 	virtual void Shutdown() override = 0;
+
+	// Number of cached text layouts and the cache hits and misses since startup
+	virtual void LayoutCacheStats(int *pEntries, int64_t *pHits, int64_t *pMisses) const = 0;
 };
 
 extern IEngineTextRender *CreateEngineTextRender();
@@ -911,8 +911,18 @@ void CMapLayers::RenderTileLayer(int LayerIndex, const ColorRGBA &Color)
 
 			if(NumVertices)
 			{
-				s_vpIndexOffsets.push_back((offset_ptr_size)Visuals.m_pTilesOfLayer[y * Visuals.m_Width + X0].IndexBufferByteOffset());
-				s_vDrawCounts.push_back(NumVertices);
+				char *pIndexOffset = (offset_ptr_size)Visuals.m_pTilesOfLayer[y * Visuals.m_Width + X0].IndexBufferByteOffset();
+				// the tiles between the previous range and this row draw nothing, e.g. when the whole
+				// width of the layer is visible, so the row can be appended to the previous range
+				if(!s_vpIndexOffsets.empty() && s_vpIndexOffsets.back() + s_vDrawCounts.back() * sizeof(unsigned int) == pIndexOffset)
+				{
+					s_vDrawCounts.back() += NumVertices;
+				}
+				else
+				{
+					s_vpIndexOffsets.push_back(pIndexOffset);
+					s_vDrawCounts.push_back(NumVertices);
+				}
 			}
 		}
 
@@ -2184,6 +2184,8 @@ void CMenus::OnShutdown()
 	KillServer();
 	m_CommunityIconLoadJobs.clear();
 	m_CommunityIconDownloadJobs.clear();
+	AbortDemoInfoFetchJobs();
+	m_pDemoInfoCache = nullptr;
 }
 
 bool CMenus::OnCursorMove(float x, float y, IInput::ECursorType CursorType)
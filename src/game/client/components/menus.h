@@ -8,10 +8,12 @@
 
 #include <chrono>
 #include <deque>
+#include <memory>
 #include <optional>
 #include <unordered_set>
 #include <vector>
 
+#include <engine/client/demo_info_cache.h>
 #include <engine/console.h>
 #include <engine/demo.h>
 #include <engine/friends.h>
@@ -371,6 +373,43 @@ protected:
 	void DemolistOnUpdate(bool Reset);
 	static int DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser);
 
+	// reads the demo infos that are not in the demo info cache yet
+	class CDemoInfoFetchJob : public IJob
+	{
+	public:
+		class CRequest
+		{
+		public:
+			char m_aFilename[IO_MAX_PATH_LENGTH];
+			char m_aPath[IO_MAX_PATH_LENGTH];
+			int m_StorageType;
+			time_t m_Date;
+			IDemoInfoCache::CEntry m_Entry;
+		};
+
+	private:
+		IStorage *m_pStorage;
+		IDemoPlayer *m_pDemoPlayer;
+		std::vector<CRequest> m_vRequests;
+
+	protected:
+		void Run() override;
+
+	public:
+		CDemoInfoFetchJob(IStorage *pStorage, IDemoPlayer *pDemoPlayer, std::vector<CRequest> &&vRequests);
+
+		const std::vector<CRequest> &Requests() const { return m_vRequests; }
+	};
+
+	std::unique_ptr<IDemoInfoCache> m_pDemoInfoCache;
+	std::deque<std::shared_ptr<CDemoInfoFetchJob>> m_DemoInfoFetchJobs;
+	void DemoInfoCachePath(const CDemoItem &Item, char *pBuffer, int BufferSize);
+	std::chrono::nanoseconds m_DemoInfoCacheFlushTime{0};
+	void StoreDemoInfo(const CDemoItem &Item);
+	void RemoveMissingDemoInfos();
+	void UpdateDemoInfoFetchJobs();
+	void AbortDemoInfoFetchJobs();
+
 	// friends
 	class CFriendItem
 	{
@@ -6,6 +6,7 @@
 #include <base/system.h>
 
 #include <engine/demo.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/keys.h>
 #include <engine/shared/localization.h>
@@ -24,6 +25,9 @@
 #include "menus.h"
 
 #include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace FontIcons;
 using namespace std::chrono_literals;
@@ -929,6 +933,21 @@ int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int Stora
 	Item.m_IsDir = IsDir != 0;
 	Item.m_IsLink = false;
 	Item.m_StorageType = StorageType;
+
+	if(!IsDir && pSelf->m_pDemoInfoCache)
+	{
+		char aCachePath[IO_MAX_PATH_LENGTH];
+		pSelf->DemoInfoCachePath(Item, aCachePath, sizeof(aCachePath));
+		IDemoInfoCache::CEntry Entry;
+		if(pSelf->m_pDemoInfoCache->Get(aCachePath, Item.m_Date, &Entry))
+		{
+			Item.m_Valid = Entry.m_Valid;
+			Item.m_Info = Entry.m_Info;
+			Item.m_TimelineMarkers = Entry.m_TimelineMarkers;
+			Item.m_MapInfo = Entry.m_MapInfo;
+			Item.m_InfosLoaded = true;
+		}
+	}
 	pSelf->m_vDemos.push_back(Item);
 
 	if(time_get_nanoseconds() - pSelf->m_DemoPopulateStartTime > 500ms)
@@ -941,6 +960,7 @@ int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int Stora
 
 void CMenus::DemolistPopulate()
 {
+	AbortDemoInfoFetchJobs();
 	m_vDemos.clear();
 
 	int NumStoragesWithDemos = 0;
@@ -990,6 +1010,7 @@ void CMenus::DemolistPopulate()
 	{
 		m_DemoPopulateStartTime = time_get_nanoseconds();
 		Storage()->ListDirectoryInfo(m_DemolistStorageType, m_aCurrentDemoFolder, DemolistFetchCallback, this);
+		RemoveMissingDemoInfos();
 
 		if(g_Config.m_BrDemoFetchInfo)
 			FetchAllHeaders();
@@ -1004,7 +1025,8 @@ void CMenus::RefreshFilteredDemos()
 	m_vpFilteredDemos.clear();
 	for(auto &Demo : m_vDemos)
 	{
-		if(str_find_nocase(Demo.m_aFilename, m_DemoSearchInput.GetString()))
+		if(str_find_nocase(Demo.m_aFilename, m_DemoSearchInput.GetString()) ||
+			(Demo.m_Valid && str_find_nocase(Demo.m_Info.m_aMapName, m_DemoSearchInput.GetString())))
 		{
 			m_vpFilteredDemos.push_back(&Demo);
 		}
@@ -1056,17 +1078,165 @@ bool CMenus::FetchHeader(CDemoItem &Item)
 		str_format(aBuffer, sizeof(aBuffer), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
 		Item.m_Valid = DemoPlayer()->GetDemoInfo(Storage(), nullptr, aBuffer, Item.m_StorageType, &Item.m_Info, &Item.m_TimelineMarkers, &Item.m_MapInfo);
 		Item.m_InfosLoaded = true;
+		// written with the next flush of the demo info cache
+		StoreDemoInfo(Item);
 	}
 	return Item.m_Valid;
 }
 
 void CMenus::FetchAllHeaders()
 {
-	for(auto &Item : m_vDemos)
+	// read the infos which are not cached in the background, in small batches
+	// so that they show up while the remaining ones are still being read
+	static constexpr size_t BATCH_SIZE = 256;
+	AbortDemoInfoFetchJobs();
+	std::vector<CDemoInfoFetchJob::CRequest> vRequests;
+	for(const auto &Item : m_vDemos)
+	{
+		if(Item.m_IsDir || Item.m_InfosLoaded)
+			continue;
+
+		CDemoInfoFetchJob::CRequest &Request = vRequests.emplace_back();
+		str_copy(Request.m_aFilename, Item.m_aFilename);
+		str_format(Request.m_aPath, sizeof(Request.m_aPath), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
+		Request.m_StorageType = Item.m_StorageType;
+		Request.m_Date = Item.m_Date;
+		if(vRequests.size() == BATCH_SIZE)
+		{
+			m_DemoInfoFetchJobs.push_back(std::make_shared<CDemoInfoFetchJob>(Storage(), DemoPlayer(), std::move(vRequests)));
+			Engine()->AddJob(m_DemoInfoFetchJobs.back());
+			vRequests.clear();
+		}
+	}
+	if(!vRequests.empty())
+	{
+		m_DemoInfoFetchJobs.push_back(std::make_shared<CDemoInfoFetchJob>(Storage(), DemoPlayer(), std::move(vRequests)));
+		Engine()->AddJob(m_DemoInfoFetchJobs.back());
+	}
+}
+
+CMenus::CDemoInfoFetchJob::CDemoInfoFetchJob(IStorage *pStorage, IDemoPlayer *pDemoPlayer, std::vector<CRequest> &&vRequests) :
+	m_pStorage(pStorage),
+	m_pDemoPlayer(pDemoPlayer),
+	m_vRequests(std::move(vRequests))
+{
+	Abortable(true);
+}
+
+void CMenus::CDemoInfoFetchJob::Run()
+{
+	for(auto &Request : m_vRequests)
 	{
-		FetchHeader(Item);
+		if(State() == IJob::STATE_ABORTED)
+			return;
+		IDemoInfoCache::CEntry &Entry = Request.m_Entry;
+		Entry.m_Valid = m_pDemoPlayer->GetDemoInfo(m_pStorage, nullptr, Request.m_aPath, Request.m_StorageType, &Entry.m_Info, &Entry.m_TimelineMarkers, &Entry.m_MapInfo);
 	}
-	std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+}
+
+void CMenus::DemoInfoCachePath(const CDemoItem &Item, char *pBuffer, int BufferSize)
+{
+	char aPath[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
+	Storage()->GetCompletePath(Item.m_StorageType, aPath, pBuffer, BufferSize);
+}
+
+void CMenus::StoreDemoInfo(const CDemoItem &Item)
+{
+	if(!m_pDemoInfoCache)
+		return;
+	char aCachePath[IO_MAX_PATH_LENGTH];
+	DemoInfoCachePath(Item, aCachePath, sizeof(aCachePath));
+	IDemoInfoCache::CEntry Entry;
+	Entry.m_Valid = Item.m_Valid;
+	Entry.m_Info = Item.m_Info;
+	Entry.m_TimelineMarkers = Item.m_TimelineMarkers;
+	Entry.m_MapInfo = Item.m_MapInfo;
+	m_pDemoInfoCache->Store(aCachePath, Item.m_Date, Entry);
+}
+
+void CMenus::UpdateDemoInfoFetchJobs()
+{
+	bool Changed = false;
+	while(!m_DemoInfoFetchJobs.empty() && m_DemoInfoFetchJobs.front()->Done())
+	{
+		std::shared_ptr<CDemoInfoFetchJob> pJob = m_DemoInfoFetchJobs.front();
+		m_DemoInfoFetchJobs.pop_front();
+		if(pJob->State() != IJob::STATE_DONE)
+			continue;
+
+		std::unordered_map<std::string, CDemoItem *> ItemsByFilename;
+		for(auto &Item : m_vDemos)
+		{
+			if(!Item.m_IsDir && !Item.m_InfosLoaded)
+				ItemsByFilename[Item.m_aFilename] = &Item;
+		}
+		for(const auto &Request : pJob->Requests())
+		{
+			auto Found = ItemsByFilename.find(Request.m_aFilename);
+			if(Found == ItemsByFilename.end() || Found->second->m_StorageType != Request.m_StorageType)
+				continue;
+			CDemoItem &Item = *Found->second;
+			Item.m_Valid = Request.m_Entry.m_Valid;
+			Item.m_Info = Request.m_Entry.m_Info;
+			Item.m_TimelineMarkers = Request.m_Entry.m_TimelineMarkers;
+			Item.m_MapInfo = Request.m_Entry.m_MapInfo;
+			Item.m_InfosLoaded = true;
+			StoreDemoInfo(Item);
+			Changed = true;
+		}
+	}
+
+	if(Changed)
+	{
+		std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+		DemolistOnUpdate(false);
+	}
+}
+
+void CMenus::RemoveMissingDemoInfos()
+{
+	if(!m_pDemoInfoCache)
+		return;
+
+	// the listing of all storages skips the files that are hidden by another
+	// storage, count these as existing
+	std::unordered_set<std::string> ExistingPaths;
+	for(const auto &Item : m_vDemos)
+	{
+		if(Item.m_IsDir)
+			continue;
+		char aPath[IO_MAX_PATH_LENGTH];
+		str_format(aPath, sizeof(aPath), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
+		for(int StorageType = IStorage::TYPE_SAVE; StorageType < Storage()->NumPaths(); ++StorageType)
+		{
+			if(m_DemolistStorageType != IStorage::TYPE_ALL && StorageType != m_DemolistStorageType)
+				continue;
+			char aCachePath[IO_MAX_PATH_LENGTH];
+			Storage()->GetCompletePath(StorageType, aPath, aCachePath, sizeof(aCachePath));
+			ExistingPaths.emplace(aCachePath);
+		}
+	}
+
+	for(int StorageType = IStorage::TYPE_SAVE; StorageType < Storage()->NumPaths(); ++StorageType)
+	{
+		if(m_DemolistStorageType != IStorage::TYPE_ALL && StorageType != m_DemolistStorageType)
+			continue;
+		char aFolderPath[IO_MAX_PATH_LENGTH];
+		Storage()->GetCompletePath(StorageType, m_aCurrentDemoFolder, aFolderPath, sizeof(aFolderPath));
+		m_pDemoInfoCache->RemoveMissing(aFolderPath, ExistingPaths);
+	}
+
+	// also writes the infos read in the previous folder
+	m_pDemoInfoCache->Flush();
+	m_DemoInfoCacheFlushTime = time_get_nanoseconds();
+}
+
+void CMenus::AbortDemoInfoFetchJobs()
+{
+	for(auto &pJob : m_DemoInfoFetchJobs)
+		pJob->Abort();
+	m_DemoInfoFetchJobs.clear();
 }
 
 void CMenus::RenderDemoBrowser(CUIRect MainView)
@@ -1084,16 +1254,30 @@ void CMenus::RenderDemoBrowser(CUIRect MainView)
 	RenderDemoBrowserList(ListView, WasListboxItemActivated);
 	RenderDemoBrowserDetails(DetailsView);
 	RenderDemoBrowserButtons(ButtonsView, WasListboxItemActivated);
+
+	// write the infos read while browsing in one transaction every few seconds,
+	// instead of one for every selected demo
+	if(m_pDemoInfoCache && time_get_nanoseconds() - m_DemoInfoCacheFlushTime > 5s)
+	{
+		m_pDemoInfoCache->Flush();
+		m_DemoInfoCacheFlushTime = time_get_nanoseconds();
+	}
 }
 
 void CMenus::RenderDemoBrowserList(CUIRect ListView, bool &WasListboxItemActivated)
 {
 	if(!m_DemoBrowserListInitialized)
 	{
+		if(!m_pDemoInfoCache)
+		{
+			m_pDemoInfoCache = std::unique_ptr<IDemoInfoCache>(CreateDemoInfoCache(Console(), Storage()));
+			m_pDemoInfoCache->Load();
+		}
 		DemolistPopulate();
 		DemolistOnUpdate(true);
 		m_DemoBrowserListInitialized = true;
 	}
+	UpdateDemoInfoFetchJobs();
 
 #if defined(CONF_VIDEORECORDER)
 	if(!m_DemoRenderInput.IsEmpty())
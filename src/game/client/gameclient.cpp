@@ -1,8 +1,14 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
+#include <typeinfo>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
 
 #include <engine/client/checksum.h>
 #include <engine/client/enums.h>
@@ -15,6 +21,7 @@
 #include <engine/map.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/sound.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -288,10 +295,49 @@ void CGameClient::InitializeLanguage()
 	g_Localization.Load(g_Config.m_ClLanguagefile, Storage(), Console());
 }
 
+static void ComponentName(const CComponent *pComponent, char *pBuf, int BufSize)
+{
+	const char *pName = typeid(*pComponent).name();
+#if defined(__GNUC__)
+	int Status;
+	char *pDemangled = abi::__cxa_demangle(pName, nullptr, nullptr, &Status);
+	str_copy(pBuf, Status == 0 ? pDemangled : pName, BufSize);
+	free(pDemangled);
+#else
+	const char *pClassName = str_startswith(pName, "class ");
+	str_copy(pBuf, pClassName ? pClassName : pName, BufSize);
+#endif
+}
+
+void CGameClient::RegisterProfilerPhases()
+{
+	CTickProfiler *pProfiler = Client()->FrameProfiler();
+	m_ProfilerPhaseSnapshot = pProfiler->RegisterPhase("snapshot");
+	m_ProfilerPhasePredict = pProfiler->RegisterPhase("predict");
+
+	m_vComponentProfilerPhases.clear();
+	for(const CComponent *pComponent : m_vpAll)
+	{
+		char aName[CTickProfiler::MAX_PHASE_NAME_LENGTH];
+		ComponentName(pComponent, aName, sizeof(aName));
+		// components of the same class, e.g. the background and foreground map layers, get numbered
+		int Phase = pProfiler->RegisterPhase(aName);
+		for(int Number = 2; Phase >= 0 && std::find(m_vComponentProfilerPhases.begin(), m_vComponentProfilerPhases.end(), Phase) != m_vComponentProfilerPhases.end(); Number++)
+		{
+			char aNumberedName[CTickProfiler::MAX_PHASE_NAME_LENGTH];
+			str_format(aNumberedName, sizeof(aNumberedName), "%s#%d", aName, Number);
+			Phase = pProfiler->RegisterPhase(aNumberedName);
+		}
+		m_vComponentProfilerPhases.push_back(Phase);
+	}
+}
+
 void CGameClient::OnInit()
 {
 	const int64_t OnInitStart = time_get();
 
+	RegisterProfilerPhases();
+
 	Client()->SetLoadingCallback([this](IClient::ELoadingCallbackDetail Detail) {
 		const char *pTitle;
 		if(Detail == IClient::LOADING_CALLBACK_DETAIL_DEMO || DemoPlayer()->IsPlaying())
@@ -349,6 +395,7 @@ void CGameClient::OnInit()
 		Client()->AddWarning(SWarning(Localize("Some fonts could not be loaded. Check the local console for details.")));
 	}
 	TextRender()->SetFontLanguageVariant(g_Config.m_ClLanguagefile);
+	PrewarmGlyphs();
 
 	// update and swap after font loading, they are quite huge
 	Client()->UpdateAndSwap();
@@ -801,8 +848,11 @@ void CGameClient::OnRender()
 	UpdateSpectatorCursor();
 
 	// render all systems
-	for(auto &pComponent : m_vpAll)
-		pComponent->OnRender();
+	for(size_t i = 0; i < m_vpAll.size(); i++)
+	{
+		CTickProfiler::CScope Scope(Client()->FrameProfiler(), m_vComponentProfilerPhases[i]);
+		m_vpAll[i]->OnRender();
+	}
 
 	// clear all events/input for this frame
 	Input()->Clear();
@@ -1243,11 +1293,21 @@ void CGameClient::HandleLanguageChanged()
 
 	g_Localization.Load(g_Config.m_ClLanguagefile, Storage(), Console());
 	TextRender()->SetFontLanguageVariant(g_Config.m_ClLanguagefile);
+	PrewarmGlyphs(); // the glyph atlas is cleared when the variant font changes
 
 	// Clear all text containers
 	Client()->OnWindowResize();
 }
 
+void CGameClient::PrewarmGlyphs()
+{
+	// render the glyphs of the font sizes that the menus use most before they
+	// are first shown, instead of while laying out the first frames
+	static const float s_aFontSizes[] = {10.0f, 12.0f, 13.0f, 14.0f, 16.0f, 18.0f, 20.0f, 24.0f};
+	Ui()->MapScreen();
+	TextRender()->PrewarmGlyphs(s_aFontSizes, std::size(s_aFontSizes));
+}
+
 void CGameClient::RenderShutdownMessage()
 {
 	const char *pMessage = nullptr;
@@ -1526,6 +1586,8 @@ void CGameClient::InvalidateSnapshot()
 
 void CGameClient::OnNewSnapshot()
 {
+	CTickProfiler::CScope ProfilerScope(Client()->FrameProfiler(), m_ProfilerPhaseSnapshot);
+
 	auto &&Evolve = [this](CNetObj_Character *pCharacter, int Tick) {
 		CWorldCore TempWorld;
 		CCharacterCore TempCore = CCharacterCore();
@@ -2260,6 +2322,8 @@ void CGameClient::UpdateEditorIngameMoved()
 
 void CGameClient::OnPredict()
 {
+	CTickProfiler::CScope ProfilerScope(Client()->FrameProfiler(), m_ProfilerPhasePredict);
+
 	// store the previous values so we can detect prediction errors
 	CCharacterCore BeforePrevChar = m_PredictedPrevChar;
 	CCharacterCore BeforeChar = m_PredictedChar;
@@ -196,6 +196,11 @@ public:
 private:
 	std::vector<class CComponent *> m_vpAll;
 	std::vector<class CComponent *> m_vpInput;
+	// frame profiler phases of the components in m_vpAll
+	std::vector<int> m_vComponentProfilerPhases;
+	int m_ProfilerPhaseSnapshot = -1;
+	int m_ProfilerPhasePredict = -1;
+	void RegisterProfilerPhases();
 	CNetObjHandler m_NetObjHandler;
 	protocol7::CNetObjHandler m_NetObjHandler7;
 
@@ -612,6 +617,7 @@ public:
 	bool m_LanguageChanged = false;
 	void OnLanguageChange();
 	void HandleLanguageChanged();
+	void PrewarmGlyphs();
 
 	void RefreshSkins();
 
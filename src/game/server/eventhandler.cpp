@@ -4,6 +4,7 @@
 
 #include "entity.h"
 #include "gamecontext.h"
+#include "player.h"
 
 #include <base/system.h>
 #include <base/vmath.h>
@@ -36,6 +37,7 @@ void *CEventHandler::Create(int Type, int Size, CClientMask Mask)
 	m_aClientMasks[m_NumEvents] = Mask;
 	m_CurrentOffset += Size;
 	m_NumEvents++;
+	m_Prepared = false;
 	return p;
 }
 
@@ -43,22 +45,82 @@ void CEventHandler::Clear()
 {
 	m_NumEvents = 0;
 	m_CurrentOffset = 0;
+	m_Prepared = false;
+}
+
+int CEventHandler::Bucket(int CellX, int CellY)
+{
+	return ((unsigned)CellX * 73856093u ^ (unsigned)CellY * 19349663u) % NUM_BUCKETS;
+}
+
+void CEventHandler::Prepare()
+{
+	for(auto &Bucket : m_aBuckets)
+		Bucket.reset();
+
+	for(int i = 0; i < m_NumEvents; i++)
+	{
+		const CNetEvent_Common *pEvent = (const CNetEvent_Common *)&m_aData[m_aOffsets[i]];
+		// arithmetic shift, rounds towards negative infinity
+		m_aBuckets[Bucket(pEvent->m_X >> CELL_SHIFT, pEvent->m_Y >> CELL_SHIFT)].set(i);
+
+		m_aSixupTypes[i] = m_aTypes[i];
+		m_aSixupSizes[i] = m_aSizes[i];
+		m_apSixupData[i] = &m_aData[m_aOffsets[i]];
+		EventToSixup(&m_aSixupTypes[i], &m_aSixupSizes[i], &m_apSixupData[i], m_aaSixupData[i]);
+	}
+	m_Prepared = true;
+}
+
+CEventHandler::CEventMask CEventHandler::VisibleEvents(int SnappingClient) const
+{
+	CEventMask Visible;
+	if(SnappingClient == SERVER_DEMO_CLIENT || GameServer()->m_apPlayers[SnappingClient]->m_ShowAll)
+	{
+		for(int i = 0; i < m_NumEvents; i++)
+			Visible.set(i);
+		return Visible;
+	}
+
+	// events in the buckets of all cells overlapping the view, hash
+	// collisions are filtered by the exact check in `Snap`
+	const CPlayer *pPlayer = GameServer()->m_apPlayers[SnappingClient];
+	int MinCellX, MinCellY, MaxCellX, MaxCellY;
+	if(!ViewCells(pPlayer->m_ViewPos, pPlayer->m_ShowDistance, &MinCellX, &MinCellY, &MaxCellX, &MaxCellY))
+	{
+		for(int i = 0; i < m_NumEvents; i++)
+			Visible.set(i);
+		return Visible;
+	}
+	for(int CellY = MinCellY; CellY <= MaxCellY; CellY++)
+	{
+		for(int CellX = MinCellX; CellX <= MaxCellX; CellX++)
+			Visible |= m_aBuckets[Bucket(CellX, CellY)];
+	}
+	return Visible;
 }
 
 void CEventHandler::Snap(int SnappingClient)
 {
+	if(m_NumEvents == 0)
+		return;
+	if(!m_Prepared)
+		Prepare();
+
+	const bool Sixup = GameServer()->Server()->IsSixup(SnappingClient);
+	const CEventMask Visible = VisibleEvents(SnappingClient);
 	for(int i = 0; i < m_NumEvents; i++)
 	{
+		if(!Visible.test(i))
+			continue;
 		if(SnappingClient == SERVER_DEMO_CLIENT || m_aClientMasks[i].test(SnappingClient))
 		{
 			CNetEvent_Common *pEvent = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
 			if(!NetworkClipped(GameServer(), SnappingClient, vec2(pEvent->m_X, pEvent->m_Y)))
 			{
-				int Type = m_aTypes[i];
-				int Size = m_aSizes[i];
-				const char *pData = &m_aData[m_aOffsets[i]];
-				if(GameServer()->Server()->IsSixup(SnappingClient))
-					EventToSixup(&Type, &Size, &pData);
+				const int Type = Sixup ? m_aSixupTypes[i] : m_aTypes[i];
+				const int Size = Sixup ? m_aSixupSizes[i] : m_aSizes[i];
+				const char *pData = Sixup ? m_apSixupData[i] : &m_aData[m_aOffsets[i]];
 
 				void *pItem = GameServer()->Server()->SnapNewItem(Type, i, Size);
 				if(pItem)
@@ -68,13 +130,13 @@ void CEventHandler::Snap(int SnappingClient)
 	}
 }
 
-void CEventHandler::EventToSixup(int *pType, int *pSize, const char **ppData)
+void CEventHandler::EventToSixup(int *pType, int *pSize, const char **ppData, char *pStore)
 {
-	static char s_aEventStore[128];
 	if(*pType == NETEVENTTYPE_DAMAGEIND)
 	{
 		const CNetEvent_DamageInd *pEvent = (const CNetEvent_DamageInd *)(*ppData);
-		protocol7::CNetEvent_Damage *pEvent7 = (protocol7::CNetEvent_Damage *)s_aEventStore;
+		protocol7::CNetEvent_Damage *pEvent7 = (protocol7::CNetEvent_Damage *)pStore;
+		static_assert(sizeof(*pEvent7) <= SIXUP_EVENT_SIZE);
 		*pType = -protocol7::NETEVENTTYPE_DAMAGE;
 		*pSize = sizeof(*pEvent7);
 
@@ -92,12 +154,13 @@ void CEventHandler::EventToSixup(int *pType, int *pSize, const char **ppData)
 		pEvent7->m_ArmorAmount = 0;
 		pEvent7->m_Self = 0;
 
-		*ppData = s_aEventStore;
+		*ppData = pStore;
 	}
 	else if(*pType == NETEVENTTYPE_SOUNDGLOBAL) // No more global sounds for the server
 	{
 		const CNetEvent_SoundGlobal *pEvent = (const CNetEvent_SoundGlobal *)(*ppData);
-		protocol7::CNetEvent_SoundWorld *pEvent7 = (protocol7::CNetEvent_SoundWorld *)s_aEventStore;
+		protocol7::CNetEvent_SoundWorld *pEvent7 = (protocol7::CNetEvent_SoundWorld *)pStore;
+		static_assert(sizeof(*pEvent7) <= SIXUP_EVENT_SIZE);
 
 		*pType = -protocol7::NETEVENTTYPE_SOUNDWORLD;
 		*pSize = sizeof(*pEvent7);
@@ -106,6 +169,6 @@ void CEventHandler::EventToSixup(int *pType, int *pSize, const char **ppData)
 		pEvent7->m_X = pEvent->m_X;
 		pEvent7->m_Y = pEvent->m_Y;
 
-		*ppData = s_aEventStore;
+		*ppData = pStore;
 	}
 }
@@ -3,8 +3,11 @@
 #ifndef GAME_SERVER_EVENTHANDLER_H
 #define GAME_SERVER_EVENTHANDLER_H
 
+#include <bitset>
 #include <cstdint>
 
+#include <base/vmath.h>
+
 #include <engine/shared/protocol.h>
 
 class CEventHandler
@@ -13,19 +16,39 @@ class CEventHandler
 	{
 		MAX_EVENTS = 128,
 		MAX_DATASIZE = 128 * 64,
+		SIXUP_EVENT_SIZE = 32,
+
+		// events are sorted into coarse cells of the world, cells are
+		// hashed into a fixed number of buckets
+		CELL_SHIFT = 10,
+		NUM_BUCKETS = 64,
 	};
 
+	typedef std::bitset<MAX_EVENTS> CEventMask;
+
 	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
 	int m_aOffsets[MAX_EVENTS];
 	int m_aSizes[MAX_EVENTS];
 	CClientMask m_aClientMasks[MAX_EVENTS];
 	char m_aData[MAX_DATASIZE];
 
+	// filled once per tick by `Prepare`
+	bool m_Prepared;
+	CEventMask m_aBuckets[NUM_BUCKETS];
+	int m_aSixupTypes[MAX_EVENTS];
+	int m_aSixupSizes[MAX_EVENTS];
+	const char *m_apSixupData[MAX_EVENTS];
+	char m_aaSixupData[MAX_EVENTS][SIXUP_EVENT_SIZE];
+
 	class CGameContext *m_pGameServer;
 
 	int m_CurrentOffset;
 	int m_NumEvents;
 
+	static int Bucket(int CellX, int CellY);
+	void Prepare();
+	CEventMask VisibleEvents(int SnappingClient) const;
+
 public:
 	CGameContext *GameServer() const { return m_pGameServer; }
 	void SetGameServer(CGameContext *pGameServer);
@@ -42,7 +65,34 @@ public:
 	void Clear();
 	void Snap(int SnappingClient);
 
-	void EventToSixup(int *pType, int *pSize, const char **ppData);
+	static void EventToSixup(int *pType, int *pSize, const char **ppData, char *pStore);
+
+	/**
+	 * Gets the range of cells that overlap the view. Returns false if the
+	 * view covers so many cells, or coordinates so large, that all events
+	 * have to be checked.
+	 */
+	static bool ViewCells(vec2 ViewPos, vec2 ShowDistance, int *pMinCellX, int *pMinCellY, int *pMaxCellX, int *pMaxCellY)
+	{
+		// the show distance is sent by the client, check it before converting
+		// to int, this also rejects values that are not finite
+		constexpr float MAX_COORD = 1 << 30;
+		const float aCoords[] = {ViewPos.x - ShowDistance.x - 1.0f, ViewPos.y - ShowDistance.y - 1.0f, ViewPos.x + ShowDistance.x + 1.0f, ViewPos.y + ShowDistance.y + 1.0f};
+		for(float Coord : aCoords)
+		{
+			if(!(Coord >= -MAX_COORD && Coord <= MAX_COORD))
+				return false;
+		}
+
+		// arithmetic shift, rounds towards negative infinity
+		*pMinCellX = round_to_int(aCoords[0]) >> CELL_SHIFT;
+		*pMinCellY = round_to_int(aCoords[1]) >> CELL_SHIFT;
+		*pMaxCellX = round_to_int(aCoords[2]) >> CELL_SHIFT;
+		*pMaxCellY = round_to_int(aCoords[3]) >> CELL_SHIFT;
+		if(*pMaxCellX < *pMinCellX || *pMaxCellY < *pMinCellY)
+			return true; // negative show distance, nothing is visible
+		return (int64_t)(*pMaxCellX - *pMinCellX + 1) * (*pMaxCellY - *pMinCellY + 1) < NUM_BUCKETS;
+	}
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include <engine/shared/linereader.h>
 #include <engine/shared/memheap.h>
 #include <engine/shared/protocolglue.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/storage.h>
 
 #include <game/collision.h>
@@ -1022,6 +1023,7 @@ void CGameContext::OnTick()
 
 	if(m_TeeHistorianActive)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhaseTeeHistorian);
 		int Error = aio_error(m_pTeeHistorianFile);
 		if(Error)
 		{
@@ -1040,29 +1042,41 @@ void CGameContext::OnTick()
 
 	// copy tuning
 	m_World.m_Core.m_aTuning[0] = m_Tuning;
-	m_World.Tick();
+	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhaseWorld);
+		m_World.Tick();
+	}
 
 	UpdatePlayerMaps();
 
-	//if(world.paused) // make sure that the game object always updates
-	m_pController->Tick();
+	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhaseController);
+		//if(world.paused) // make sure that the game object always updates
+		m_pController->Tick();
+	}
+
+	if(m_pScore)
+		m_pScore->Tick();
 
-	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
-		if(m_apPlayers[i])
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhasePlayers);
+		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
-			// send vote options
-			ProgressVoteOptions(i);
+			if(m_apPlayers[i])
+			{
+				// send vote options
+				ProgressVoteOptions(i);
 
-			m_apPlayers[i]->Tick();
-			m_apPlayers[i]->PostTick();
+				m_apPlayers[i]->Tick();
+				m_apPlayers[i]->PostTick();
+			}
 		}
-	}
 
-	for(auto &pPlayer : m_apPlayers)
-	{
-		if(pPlayer)
-			pPlayer->PostPostTick();
+		for(auto &pPlayer : m_apPlayers)
+		{
+			if(pPlayer)
+				pPlayer->PostPostTick();
+		}
 	}
 
 	// update voting
@@ -1290,6 +1304,7 @@ void CGameContext::OnTick()
 
 	if(m_SqlRandomMapResult != nullptr && m_SqlRandomMapResult->m_Completed)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhaseSqlResults);
 		if(m_SqlRandomMapResult->m_Success)
 		{
 			if(m_SqlRandomMapResult->m_ClientId != -1 && m_apPlayers[m_SqlRandomMapResult->m_ClientId] && m_SqlRandomMapResult->m_aMessage[0] != '\0')
@@ -1305,6 +1320,7 @@ void CGameContext::OnTick()
 	// Record player position at the end of the tick
 	if(m_TeeHistorianActive)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_TickPhaseTeeHistorian);
 		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
 			if(m_apPlayers[i] && m_apPlayers[i]->GetCharacter())
@@ -3862,6 +3878,13 @@ void CGameContext::OnInit(const void *pPersistentData)
 	m_World.SetGameServer(this);
 	m_Events.SetGameServer(this);
 
+	m_TickPhaseWorld = Server()->TickProfiler()->RegisterPhase("world");
+	m_TickPhaseController = Server()->TickProfiler()->RegisterPhase("controller");
+	m_TickPhasePlayers = Server()->TickProfiler()->RegisterPhase("players");
+	m_TickPhaseTeeHistorian = Server()->TickProfiler()->RegisterPhase("teehistorian");
+	// completed database queries, partly also counted in "controller" and "players"
+	m_TickPhaseSqlResults = Server()->TickProfiler()->RegisterPhase("sql_results");
+
 	m_GameUuid = RandomUuid();
 	Console()->SetTeeHistorianCommandCallback(CommandCallback, this);
 
@@ -3969,7 +3992,7 @@ void CGameContext::OnInit(const void *pPersistentData)
 		FormatUuid(m_GameUuid, aGameUuid, sizeof(aGameUuid));
 
 		char aFilename[IO_MAX_PATH_LENGTH];
-		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian", aGameUuid);
+		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian%s", aGameUuid, g_Config.m_SvTeeHistorianCompression ? ".gz" : "");
 
 		IOHANDLE THFile = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
 		if(!THFile)
@@ -3983,6 +4006,12 @@ void CGameContext::OnInit(const void *pPersistentData)
 			dbg_msg("teehistorian", "recording to '%s'", aFilename);
 		}
 		m_pTeeHistorianFile = aio_new(THFile);
+		if(g_Config.m_SvTeeHistorianCompression)
+		{
+			// compressed on the thread of the file writer
+			m_pTeeHistorianCompressor = std::make_unique<CTeeHistorianCompressor>();
+			aio_set_filter(m_pTeeHistorianFile, CTeeHistorianCompressor::AioFilter, m_pTeeHistorianCompressor.get());
+		}
 
 		char aVersion[128];
 		if(GIT_SHORTREV_HASH)
@@ -4303,6 +4332,7 @@ void CGameContext::OnShutdown(void *pPersistentData)
 			Server()->SetErrorShutdown("teehistorian close error");
 		}
 		aio_free(m_pTeeHistorianFile);
+		m_pTeeHistorianCompressor = nullptr;
 	}
 
 	// Stop any demos being recorded.
@@ -4458,6 +4488,29 @@ bool CGameContext::IsClientPlayer(int ClientId) const
 	return m_apPlayers[ClientId] && m_apPlayers[ClientId]->GetTeam() != TEAM_SPECTATORS;
 }
 
+int CGameContext::ClientSnapPriority(int ClientId) const
+{
+	const CPlayer *pPlayer = m_apPlayers[ClientId];
+	if(!pPlayer)
+		return SNAP_PRIORITY_NORMAL;
+	if(pPlayer->GetTeam() == TEAM_SPECTATORS || pPlayer->IsPaused())
+		return SNAP_PRIORITY_SPECTATOR;
+	if(pPlayer->IsAfk())
+		return SNAP_PRIORITY_AFK;
+
+	// nobody else is close enough to interact with
+	const float ActionDistance = 2000.0f;
+	for(const CPlayer *pOther : m_apPlayers)
+	{
+		if(!pOther || pOther == pPlayer || !pOther->GetCharacter())
+			continue;
+		const vec2 Distance = pOther->GetCharacter()->GetPos() - pPlayer->m_ViewPos;
+		if(absolute(Distance.x) < ActionDistance && absolute(Distance.y) < ActionDistance)
+			return SNAP_PRIORITY_NORMAL;
+	}
+	return SNAP_PRIORITY_FAR;
+}
+
 CUuid CGameContext::GameUuid() const { return m_GameUuid; }
 const char *CGameContext::GameType() const { return m_pController && m_pController->m_pGameType ? m_pController->m_pGameType : ""; }
 const char *CGameContext::Version() const { return GAME_VERSION; }
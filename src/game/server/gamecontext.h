@@ -94,7 +94,13 @@ class CGameContext : public IGameServer
 
 	bool m_TeeHistorianActive;
 	CTeeHistorian m_TeeHistorian;
+	int m_TickPhaseWorld;
+	int m_TickPhaseController;
+	int m_TickPhasePlayers;
+	int m_TickPhaseTeeHistorian;
+	int m_TickPhaseSqlResults;
 	ASYNCIO *m_pTeeHistorianFile;
+	std::unique_ptr<CTeeHistorianCompressor> m_pTeeHistorianCompressor;
 	CUuid m_GameUuid;
 	CMapBugs m_MapBugs;
 	CPrng m_Prng;
@@ -168,6 +174,7 @@ public:
 	CTuningParams *TuningList() { return &m_aTuningList[0]; }
 	IAntibot *Antibot() { return m_pAntibot; }
 	CTeeHistorian *TeeHistorian() { return &m_TeeHistorian; }
+	int TickPhaseSqlResults() const { return m_TickPhaseSqlResults; }
 	bool TeeHistorianActive() const { return m_TeeHistorianActive; }
 
 	CGameContext();
@@ -334,6 +341,7 @@ public:
 
 	bool IsClientReady(int ClientId) const override;
 	bool IsClientPlayer(int ClientId) const override;
+	int ClientSnapPriority(int ClientId) const override;
 	int PersistentDataSize() const override { return sizeof(CPersistentData); }
 	int PersistentClientDataSize() const override { return sizeof(CPersistentClientData); }
 
@@ -3,6 +3,7 @@
 #include <engine/shared/config.h>
 
 #include <engine/shared/protocolglue.h>
+#include <engine/shared/tick_profiler.h>
 #include <game/generated/protocol.h>
 #include <game/mapitems.h>
 #include <game/server/score.h>
@@ -550,6 +551,7 @@ void IGameController::Tick()
 
 	if(m_pLoadBestTimeResult != nullptr && m_pLoadBestTimeResult->m_Completed)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), GameServer()->TickPhaseSqlResults());
 		if(m_pLoadBestTimeResult->m_Success)
 		{
 			m_CurrentRecord = m_pLoadBestTimeResult->m_CurrentRecord;
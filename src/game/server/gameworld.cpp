@@ -8,6 +8,7 @@
 #include "gamecontroller.h"
 
 #include <engine/shared/config.h>
+#include <engine/shared/tick_profiler.h>
 
 #include <algorithm>
 #include <utility>
@@ -40,6 +41,10 @@ void CGameWorld::SetGameServer(CGameContext *pGameServer)
 	m_pGameServer = pGameServer;
 	m_pConfig = m_pGameServer->Config();
 	m_pServer = m_pGameServer->Server();
+
+	static const char *const s_apEntTypeNames[NUM_ENTTYPES] = {"ent_projectile", "ent_laser", "ent_pickup", "ent_flag", "ent_character"};
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+		m_aTickProfilerPhases[i] = m_pServer->TickProfiler()->RegisterPhase(s_apEntTypeNames[i]);
 }
 
 CEntity *CGameWorld::FindFirst(int Type)
@@ -217,6 +222,7 @@ void CGameWorld::Tick()
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
+			CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), m_aTickProfilerPhases[i]);
 			// It's important to call PreTick() and Tick() after each other.
 			// If we call PreTick() before, and Tick() after other entities have been processed, it causes physics changes such as a stronger shotgun or grenade.
 			if(g_Config.m_SvNoWeakHook && i == ENTTYPE_CHARACTER)
@@ -36,6 +36,7 @@ private:
 
 	CEntity *m_pNextTraverseEntity = nullptr;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
+	int m_aTickProfilerPhases[NUM_ENTTYPES];
 
 	class CGameContext *m_pGameServer;
 	class CConfig *m_pConfig;
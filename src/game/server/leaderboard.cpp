@@ -0,0 +1,160 @@
+#include "leaderboard.h"
+
+#include <base/system.h>
+
+void CLeaderboard::Clear()
+{
+	m_vNodes.clear();
+	m_NameToNode.clear();
+	m_Root = -1;
+}
+
+bool CLeaderboard::Add(const char *pName, float Time)
+{
+	auto It = m_NameToNode.find(pName);
+	if(It != m_NameToNode.end())
+	{
+		const int Node = It->second;
+		if(m_vNodes[Node].m_Time <= Time)
+			return false;
+		m_Root = Remove(m_Root, Node);
+		m_vNodes[Node].m_Time = Time;
+		Insert(Node);
+		return true;
+	}
+
+	// xorshift, the priorities only have to be independent of the order
+	m_Seed ^= m_Seed << 13;
+	m_Seed ^= m_Seed >> 17;
+	m_Seed ^= m_Seed << 5;
+	const int Node = m_vNodes.size();
+	m_vNodes.push_back({Time, pName, m_Seed, 1, -1, -1});
+	m_NameToNode.emplace(pName, Node);
+	Insert(Node);
+	return true;
+}
+
+bool CLeaderboard::Find(const char *pName, float *pTime) const
+{
+	auto It = m_NameToNode.find(pName);
+	if(It == m_NameToNode.end())
+		return false;
+	*pTime = m_vNodes[It->second].m_Time;
+	return true;
+}
+
+int CLeaderboard::Rank(float Time) const
+{
+	int NumBetter = 0;
+	int Node = m_Root;
+	while(Node >= 0)
+	{
+		if(m_vNodes[Node].m_Time < Time)
+		{
+			NumBetter += SizeOf(m_vNodes[Node].m_Left) + 1;
+			Node = m_vNodes[Node].m_Right;
+		}
+		else
+		{
+			Node = m_vNodes[Node].m_Left;
+		}
+	}
+	return NumBetter + 1;
+}
+
+void CLeaderboard::Get(int Index, const char **ppName, float *pTime) const
+{
+	dbg_assert(Index >= 0 && Index < Size(), "leaderboard index out of range");
+	int Node = m_Root;
+	while(true)
+	{
+		const int NumLeft = SizeOf(m_vNodes[Node].m_Left);
+		if(Index < NumLeft)
+		{
+			Node = m_vNodes[Node].m_Left;
+		}
+		else if(Index == NumLeft)
+		{
+			*ppName = m_vNodes[Node].m_Name.c_str();
+			*pTime = m_vNodes[Node].m_Time;
+			return;
+		}
+		else
+		{
+			Index -= NumLeft + 1;
+			Node = m_vNodes[Node].m_Right;
+		}
+	}
+}
+
+void CLeaderboard::Update(int Node)
+{
+	m_vNodes[Node].m_Size = SizeOf(m_vNodes[Node].m_Left) + SizeOf(m_vNodes[Node].m_Right) + 1;
+}
+
+bool CLeaderboard::Less(int Node, float Time, const char *pName) const
+{
+	if(m_vNodes[Node].m_Time != Time)
+		return m_vNodes[Node].m_Time < Time;
+	return str_comp(m_vNodes[Node].m_Name.c_str(), pName) < 0;
+}
+
+void CLeaderboard::Split(int Root, float Time, const char *pName, int &Left, int &Right)
+{
+	// `Left` gets the nodes before the key, `Right` the remaining ones
+	if(Root < 0)
+	{
+		Left = Right = -1;
+		return;
+	}
+	if(Less(Root, Time, pName))
+	{
+		Split(m_vNodes[Root].m_Right, Time, pName, m_vNodes[Root].m_Right, Right);
+		Left = Root;
+	}
+	else
+	{
+		Split(m_vNodes[Root].m_Left, Time, pName, Left, m_vNodes[Root].m_Left);
+		Right = Root;
+	}
+	Update(Root);
+}
+
+int CLeaderboard::Merge(int Left, int Right)
+{
+	if(Left < 0)
+		return Right;
+	if(Right < 0)
+		return Left;
+	if(m_vNodes[Left].m_Priority > m_vNodes[Right].m_Priority)
+	{
+		m_vNodes[Left].m_Right = Merge(m_vNodes[Left].m_Right, Right);
+		Update(Left);
+		return Left;
+	}
+	m_vNodes[Right].m_Left = Merge(Left, m_vNodes[Right].m_Left);
+	Update(Right);
+	return Right;
+}
+
+int CLeaderboard::Remove(int Root, int Node)
+{
+	if(Root == Node)
+		return Merge(m_vNodes[Node].m_Left, m_vNodes[Node].m_Right);
+	if(Less(Root, m_vNodes[Node].m_Time, m_vNodes[Node].m_Name.c_str()))
+		m_vNodes[Root].m_Right = Remove(m_vNodes[Root].m_Right, Node);
+	else
+		m_vNodes[Root].m_Left = Remove(m_vNodes[Root].m_Left, Node);
+	Update(Root);
+	return Root;
+}
+
+void CLeaderboard::Insert(int Node)
+{
+	m_vNodes[Node].m_Size = 1;
+	m_vNodes[Node].m_Left = -1;
+	m_vNodes[Node].m_Right = -1;
+	int Left, Right;
+	Split(m_Root, m_vNodes[Node].m_Time, m_vNodes[Node].m_Name.c_str(), Left, Right);
+	m_Root = Merge(Merge(Left, Node), Right);
+}
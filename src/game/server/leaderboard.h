@@ -0,0 +1,70 @@
+#ifndef GAME_SERVER_LEADERBOARD_H
+#define GAME_SERVER_LEADERBOARD_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Best time of every player on a map, ordered by time and name.
+ *
+ * Answers the rank of a time and the player at a position in O(log n), so
+ * rank queries of the current map don't have to go through the database.
+ */
+class CLeaderboard
+{
+public:
+	CLeaderboard() = default;
+
+	void Clear();
+
+	/**
+	 * Keeps the time if it's the first or a better time of the player.
+	 *
+	 * @return `true` if the time was kept.
+	 */
+	bool Add(const char *pName, float Time);
+
+	int Size() const { return m_NameToNode.size(); }
+	/**
+	 * @return `false` if the player has no time.
+	 */
+	bool Find(const char *pName, float *pTime) const;
+	/**
+	 * Rank of a time like SQL's `RANK()`, one more than the number of
+	 * players with a better time.
+	 */
+	int Rank(float Time) const;
+	/**
+	 * Player at a position, 0 is the best one.
+	 */
+	void Get(int Index, const char **ppName, float *pTime) const;
+
+private:
+	// nodes of a treap, ordered by time and name and with the subtree size
+	// to find positions
+	struct CNode
+	{
+		float m_Time;
+		std::string m_Name;
+		unsigned m_Priority;
+		int m_Size;
+		int m_Left;
+		int m_Right;
+	};
+
+	int SizeOf(int Node) const { return Node < 0 ? 0 : m_vNodes[Node].m_Size; }
+	void Update(int Node);
+	bool Less(int Node, float Time, const char *pName) const;
+	void Split(int Root, float Time, const char *pName, int &Left, int &Right);
+	int Merge(int Left, int Right);
+	int Remove(int Root, int Node);
+	void Insert(int Node);
+
+	std::vector<CNode> m_vNodes;
+	std::unordered_map<std::string, int> m_NameToNode;
+	int m_Root = -1;
+	unsigned m_Seed = 0x9e3779b9;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include <engine/antibot.h>
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/tick_profiler.h>
 
 #include <game/gamecore.h>
 #include <game/teamscore.h>
@@ -165,11 +166,13 @@ void CPlayer::Tick()
 {
 	if(m_ScoreQueryResult != nullptr && m_ScoreQueryResult->m_Completed && m_SentSnaps >= 3)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), GameServer()->TickPhaseSqlResults());
 		ProcessScoreResult(*m_ScoreQueryResult);
 		m_ScoreQueryResult = nullptr;
 	}
 	if(m_ScoreFinishResult != nullptr && m_ScoreFinishResult->m_Completed)
 	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), GameServer()->TickPhaseSqlResults());
 		ProcessScoreResult(*m_ScoreFinishResult);
 		m_ScoreFinishResult = nullptr;
 	}
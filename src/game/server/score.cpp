@@ -9,6 +9,7 @@
 #include <engine/shared/config.h>
 #include <engine/shared/console.h>
 #include <engine/shared/linereader.h>
+#include <engine/shared/tick_profiler.h>
 #include <engine/storage.h>
 #include <game/generated/wordlist.h>
 
@@ -36,15 +37,36 @@ void CScore::ExecPlayerThread(
 	if(pResult == nullptr)
 		return;
 	auto Tmp = std::make_unique<CSqlPlayerRequest>(pResult);
-	str_copy(Tmp->m_aName, pName, sizeof(Tmp->m_aName));
-	str_copy(Tmp->m_aMap, Server()->GetMapName(), sizeof(Tmp->m_aMap));
-	str_copy(Tmp->m_aServer, g_Config.m_SvSqlServerName, sizeof(Tmp->m_aServer));
-	str_copy(Tmp->m_aRequestingPlayer, Server()->ClientName(ClientId), sizeof(Tmp->m_aRequestingPlayer));
-	Tmp->m_Offset = Offset;
+	FillPlayerRequest(Tmp.get(), ClientId, pName, Offset);
 
 	m_pPool->Execute(pFuncPtr, std::move(Tmp), pThreadName);
 }
 
+void CScore::ExecPlayerLeaderboard(
+	void (*pFuncPtr)(const CLeaderboard &, const CLeaderboard &, const CSqlPlayerRequest *),
+	int ClientId,
+	const char *pName,
+	int Offset)
+{
+	auto pResult = NewSqlPlayerResult(ClientId);
+	if(pResult == nullptr)
+		return;
+	CSqlPlayerRequest Request(pResult);
+	FillPlayerRequest(&Request, ClientId, pName, Offset);
+	pFuncPtr(m_Leaderboard, m_RegionalLeaderboard, &Request);
+	pResult->m_Success = true;
+	pResult->m_Completed = true;
+}
+
+void CScore::FillPlayerRequest(CSqlPlayerRequest *pRequest, int ClientId, const char *pName, int Offset)
+{
+	str_copy(pRequest->m_aName, pName, sizeof(pRequest->m_aName));
+	str_copy(pRequest->m_aMap, Server()->GetMapName(), sizeof(pRequest->m_aMap));
+	str_copy(pRequest->m_aServer, g_Config.m_SvSqlServerName, sizeof(pRequest->m_aServer));
+	str_copy(pRequest->m_aRequestingPlayer, Server()->ClientName(ClientId), sizeof(pRequest->m_aRequestingPlayer));
+	pRequest->m_Offset = Offset;
+}
+
 bool CScore::RateLimitPlayer(int ClientId)
 {
 	CPlayer *pPlayer = GameServer()->m_apPlayers[ClientId];
@@ -71,9 +93,15 @@ void CScore::GeneratePassphrase(char *pBuf, int BufSize)
 CScore::CScore(CGameContext *pGameServer, CDbConnectionPool *pPool) :
 	m_pPool(pPool),
 	m_pGameServer(pGameServer),
-	m_pServer(pGameServer->Server())
+	m_pServer(pGameServer->Server()),
+	m_LeaderboardLoaded(false),
+	m_pLeaderboardResult(nullptr),
+	m_NextLeaderboardLoad(0)
 {
+	m_aLeaderboardServer[0] = '\0';
 	LoadBestTime();
+	if(g_Config.m_SvRankCache)
+		LoadLeaderboard();
 
 	uint64_t aSeed[2];
 	secure_random_fill(aSeed, sizeof(aSeed));
@@ -117,6 +145,68 @@ void CScore::LoadBestTime()
 	m_pPool->Execute(CScoreWorker::LoadBestTime, std::move(Tmp), "load best time");
 }
 
+void CScore::LoadLeaderboard()
+{
+	m_pLeaderboardResult = std::make_shared<CScoreLeaderboardResult>();
+	auto Tmp = std::make_unique<CSqlLeaderboardRequest>(m_pLeaderboardResult);
+	str_copy(Tmp->m_aMap, Server()->GetMapName(), sizeof(Tmp->m_aMap));
+	str_copy(Tmp->m_aServer, g_Config.m_SvSqlServerName, sizeof(Tmp->m_aServer));
+	if(str_comp(m_aLeaderboardServer, Tmp->m_aServer) != 0)
+	{
+		// the regional leaderboard is of another region
+		m_LeaderboardLoaded = false;
+		str_copy(m_aLeaderboardServer, Tmp->m_aServer, sizeof(m_aLeaderboardServer));
+	}
+	m_vLeaderboardFinishes.clear();
+	m_pPool->Execute(CScoreWorker::LoadLeaderboard, std::move(Tmp), "load leaderboard");
+}
+
+bool CScore::UseLeaderboard() const
+{
+	char aServer[sizeof(m_aLeaderboardServer)];
+	str_copy(aServer, g_Config.m_SvSqlServerName, sizeof(aServer));
+	return g_Config.m_SvRankCache && m_LeaderboardLoaded && str_comp(aServer, m_aLeaderboardServer) == 0;
+}
+
+void CScore::Tick()
+{
+	if(m_pLeaderboardResult != nullptr && m_pLeaderboardResult->m_Completed)
+	{
+		CTickProfiler::CScope ProfilerScope(Server()->TickProfiler(), GameServer()->TickPhaseSqlResults());
+		if(m_pLeaderboardResult->m_Success)
+		{
+			m_Leaderboard = std::move(m_pLeaderboardResult->m_Global);
+			m_RegionalLeaderboard = std::move(m_pLeaderboardResult->m_Regional);
+			for(const auto &[Name, Time] : m_vLeaderboardFinishes)
+			{
+				m_Leaderboard.Add(Name.c_str(), Time);
+				m_RegionalLeaderboard.Add(Name.c_str(), Time);
+			}
+			m_LeaderboardLoaded = true;
+			m_NextLeaderboardLoad = Server()->Tick() + (int64_t)g_Config.m_SvRankCacheRefresh * Server()->TickSpeed();
+		}
+		else
+		{
+			// database not reachable, try again later
+			m_LeaderboardLoaded = false;
+			m_NextLeaderboardLoad = Server()->Tick() + 10 * Server()->TickSpeed();
+		}
+		m_pLeaderboardResult = nullptr;
+		m_vLeaderboardFinishes.clear();
+	}
+
+	if(!g_Config.m_SvRankCache)
+	{
+		m_LeaderboardLoaded = false;
+		return;
+	}
+	if(m_pLeaderboardResult == nullptr && Server()->Tick() >= m_NextLeaderboardLoad &&
+		(!UseLeaderboard() || g_Config.m_SvRankCacheRefresh > 0))
+	{
+		LoadLeaderboard();
+	}
+}
+
 void CScore::LoadPlayerData(int ClientId, const char *pName)
 {
 	ExecPlayerThread(CScoreWorker::LoadPlayerData, "load player data", ClientId, pName, 0);
@@ -163,6 +253,15 @@ void CScore::SaveScore(int ClientId, int TimeTicks, const char *pTimestamp, cons
 	for(int i = 0; i < NUM_CHECKPOINTS; i++)
 		Tmp->m_aCurrentTimeCp[i] = aTimeCp[i];
 
+	// the database only keeps two decimals
+	char aTime[32];
+	str_format(aTime, sizeof(aTime), "%.2f", Tmp->m_Time);
+	const float Time = str_tofloat(aTime);
+	m_Leaderboard.Add(Tmp->m_aName, Time);
+	m_RegionalLeaderboard.Add(Tmp->m_aName, Time);
+	if(m_pLeaderboardResult != nullptr)
+		m_vLeaderboardFinishes.emplace_back(Tmp->m_aName, Time);
+
 	m_pPool->ExecuteWrite(CScoreWorker::SaveScore, std::move(Tmp), "save score");
 }
 
@@ -196,6 +295,11 @@ void CScore::ShowRank(int ClientId, const char *pName)
 {
 	if(RateLimitPlayer(ClientId))
 		return;
+	if(UseLeaderboard())
+	{
+		ExecPlayerLeaderboard(CScoreWorker::ShowRankCached, ClientId, pName, 0);
+		return;
+	}
 	ExecPlayerThread(CScoreWorker::ShowRank, "show rank", ClientId, pName, 0);
 }
 
@@ -210,6 +314,11 @@ void CScore::ShowTop(int ClientId, int Offset)
 {
 	if(RateLimitPlayer(ClientId))
 		return;
+	if(UseLeaderboard())
+	{
+		ExecPlayerLeaderboard(CScoreWorker::ShowTopCached, ClientId, "", Offset);
+		return;
+	}
 	ExecPlayerThread(CScoreWorker::ShowTop, "show top5", ClientId, "", Offset);
 }
 
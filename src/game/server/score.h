@@ -3,6 +3,7 @@
 
 #include <game/prng.h>
 
+#include "leaderboard.h"
 #include "scoreworker.h"
 
 class CDbConnectionPool;
@@ -25,8 +26,22 @@ class CScore
 	CPrng m_Prng;
 	void GeneratePassphrase(char *pBuf, int BufSize);
 
+	// best times of the current map, used instead of the database for /rank and /top5
+	CLeaderboard m_Leaderboard;
+	CLeaderboard m_RegionalLeaderboard;
+	char m_aLeaderboardServer[5];
+	bool m_LeaderboardLoaded;
+	std::shared_ptr<CScoreLeaderboardResult> m_pLeaderboardResult;
+	int64_t m_NextLeaderboardLoad;
+	// finishes while the leaderboards are being reloaded, added to the new ones
+	std::vector<std::pair<std::string, float>> m_vLeaderboardFinishes;
+
+	void LoadLeaderboard();
+	bool UseLeaderboard() const;
+
 	// returns new SqlResult bound to the player, if no current Thread is active for this player
 	std::shared_ptr<CScorePlayerResult> NewSqlPlayerResult(int ClientId);
+	void FillPlayerRequest(CSqlPlayerRequest *pRequest, int ClientId, const char *pName, int Offset);
 	// Creates for player database requests
 	void ExecPlayerThread(
 		bool (*pFuncPtr)(IDbConnection *, const ISqlData *, char *pError, int ErrorSize),
@@ -34,6 +49,12 @@ class CScore
 		int ClientId,
 		const char *pName,
 		int Offset);
+	// Answers player requests from the leaderboards without the database
+	void ExecPlayerLeaderboard(
+		void (*pFuncPtr)(const CLeaderboard &, const CLeaderboard &, const CSqlPlayerRequest *),
+		int ClientId,
+		const char *pName,
+		int Offset);
 
 	// returns true if the player should be rate limited
 	bool RateLimitPlayer(int ClientId);
@@ -44,6 +65,8 @@ public:
 
 	CPlayerData *PlayerData(int Id) { return &m_aPlayerData[Id]; }
 
+	void Tick();
+
 	void LoadBestTime();
 	void MapInfo(int ClientId, const char *pMapName);
 	void MapVote(int ClientId, const char *pMapName);
@@ -170,6 +170,49 @@ bool CScoreWorker::LoadBestTime(IDbConnection *pSqlServer, const ISqlData *pGame
 	return false;
 }
 
+bool CScoreWorker::LoadLeaderboard(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
+{
+	const auto *pData = dynamic_cast<const CSqlLeaderboardRequest *>(pGameData);
+	auto *pResult = dynamic_cast<CScoreLeaderboardResult *>(pGameData->m_pResult.get());
+
+	char aServerLike[16];
+	str_format(aServerLike, sizeof(aServerLike), "%%%s%%", pData->m_aServer);
+
+	char aBuf[512];
+	str_format(aBuf, sizeof(aBuf),
+		"SELECT Name, MIN(Time) "
+		"FROM %s_race "
+		"WHERE Map = ? "
+		"AND Server LIKE ? "
+		"GROUP BY Name",
+		pSqlServer->GetPrefix());
+
+	CLeaderboard *apLeaderboards[] = {&pResult->m_Global, &pResult->m_Regional};
+	const char *apServerLike[] = {"%", aServerLike};
+	for(int i = 0; i < 2; i++)
+	{
+		if(pSqlServer->PrepareStatement(aBuf, pError, ErrorSize))
+		{
+			return true;
+		}
+		pSqlServer->BindString(1, pData->m_aMap);
+		pSqlServer->BindString(2, apServerLike[i]);
+
+		bool End;
+		while(!pSqlServer->Step(&End, pError, ErrorSize) && !End)
+		{
+			char aName[MAX_NAME_LENGTH];
+			pSqlServer->GetString(1, aName, sizeof(aName));
+			apLeaderboards[i]->Add(aName, pSqlServer->GetFloat(2));
+		}
+		if(!End)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 // update stuff
 bool CScoreWorker::LoadPlayerData(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
 {
@@ -817,6 +860,55 @@ bool CScoreWorker::SaveTeamScore(IDbConnection *pSqlServer, const ISqlData *pGam
 	return false;
 }
 
+static void FormatRank(const CSqlPlayerRequest *pData, CScorePlayerResult *pResult, int Rank, float Time, float PercentRank, const char *pRegionalRank)
+{
+	char aTime[32];
+	// CEIL and FLOOR are not supported in SQLite
+	int BetterThanPercent = std::floor(100.0f - 100.0f * PercentRank);
+	str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
+	if(g_Config.m_SvHideScore)
+	{
+		str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+			"Your time: %s, better than %d%%", aTime, BetterThanPercent);
+	}
+	else
+	{
+		pResult->m_MessageKind = CScorePlayerResult::ALL;
+
+		if(str_comp_nocase(pData->m_aRequestingPlayer, pData->m_aName) == 0)
+		{
+			str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+				"%s - %s - better than %d%%",
+				pData->m_aName, aTime, BetterThanPercent);
+		}
+		else
+		{
+			str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+				"%s - %s - better than %d%% - requested by %s",
+				pData->m_aName, aTime, BetterThanPercent, pData->m_aRequestingPlayer);
+		}
+
+		if(g_Config.m_SvRegionalRankings)
+		{
+			str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
+				"Global rank %d - %s %s",
+				Rank, pData->m_aServer, pRegionalRank);
+		}
+		else
+		{
+			str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
+				"Global rank %d", Rank);
+		}
+	}
+}
+
+static void FormatTopLine(char *pBuf, int BufSize, int Rank, const char *pName, float Time)
+{
+	char aTime[32];
+	str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
+	str_format(pBuf, BufSize, "%d. %s Time: %s", Rank, pName, aTime);
+}
+
 bool CScoreWorker::ShowRank(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
 {
 	const auto *pData = dynamic_cast<const CSqlPlayerRequest *>(pGameData);
@@ -881,45 +973,7 @@ bool CScoreWorker::ShowRank(IDbConnection *pSqlServer, const ISqlData *pGameData
 
 	if(!End)
 	{
-		int Rank = pSqlServer->GetInt(1);
-		float Time = pSqlServer->GetFloat(2);
-		// CEIL and FLOOR are not supported in SQLite
-		int BetterThanPercent = std::floor(100.0f - 100.0f * pSqlServer->GetFloat(3));
-		str_time_float(Time, TIME_HOURS_CENTISECS, aBuf, sizeof(aBuf));
-		if(g_Config.m_SvHideScore)
-		{
-			str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-				"Your time: %s, better than %d%%", aBuf, BetterThanPercent);
-		}
-		else
-		{
-			pResult->m_MessageKind = CScorePlayerResult::ALL;
-
-			if(str_comp_nocase(pData->m_aRequestingPlayer, pData->m_aName) == 0)
-			{
-				str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-					"%s - %s - better than %d%%",
-					pData->m_aName, aBuf, BetterThanPercent);
-			}
-			else
-			{
-				str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
-					"%s - %s - better than %d%% - requested by %s",
-					pData->m_aName, aBuf, BetterThanPercent, pData->m_aRequestingPlayer);
-			}
-
-			if(g_Config.m_SvRegionalRankings)
-			{
-				str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
-					"Global rank %d - %s %s",
-					Rank, pData->m_aServer, aRegionalRank);
-			}
-			else
-			{
-				str_format(pResult->m_Data.m_aaMessages[1], sizeof(pResult->m_Data.m_aaMessages[1]),
-					"Global rank %d", Rank);
-			}
-		}
+		FormatRank(pData, pResult, pSqlServer->GetInt(1), pSqlServer->GetFloat(2), pSqlServer->GetFloat(3), aRegionalRank);
 	}
 	else
 	{
@@ -1052,18 +1106,14 @@ bool CScoreWorker::ShowTop(IDbConnection *pSqlServer, const ISqlData *pGameData,
 	str_copy(pResult->m_Data.m_aaMessages[Line], "------------ Global Top ------------", sizeof(pResult->m_Data.m_aaMessages[Line]));
 	Line++;
 
-	char aTime[32];
 	bool End = false;
 
 	while(!pSqlServer->Step(&End, pError, ErrorSize) && !End)
 	{
 		char aName[MAX_NAME_LENGTH];
 		pSqlServer->GetString(1, aName, sizeof(aName));
-		float Time = pSqlServer->GetFloat(2);
-		str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
-		int Rank = pSqlServer->GetInt(3);
-		str_format(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
-			"%d. %s Time: %s", Rank, aName, aTime);
+		FormatTopLine(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+			pSqlServer->GetInt(3), aName, pSqlServer->GetFloat(2));
 
 		Line++;
 	}
@@ -1094,17 +1144,77 @@ bool CScoreWorker::ShowTop(IDbConnection *pSqlServer, const ISqlData *pGameData,
 	{
 		char aName[MAX_NAME_LENGTH];
 		pSqlServer->GetString(1, aName, sizeof(aName));
-		float Time = pSqlServer->GetFloat(2);
-		str_time_float(Time, TIME_HOURS_CENTISECS, aTime, sizeof(aTime));
-		int Rank = pSqlServer->GetInt(3);
-		str_format(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
-			"%d. %s Time: %s", Rank, aName, aTime);
+		FormatTopLine(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+			pSqlServer->GetInt(3), aName, pSqlServer->GetFloat(2));
 		Line++;
 	}
 
 	return !End;
 }
 
+void CScoreWorker::ShowRankCached(const CLeaderboard &Global, const CLeaderboard &Regional, const CSqlPlayerRequest *pData)
+{
+	auto *pResult = dynamic_cast<CScorePlayerResult *>(pData->m_pResult.get());
+
+	float Time;
+	if(!Global.Find(pData->m_aName, &Time))
+	{
+		str_format(pResult->m_Data.m_aaMessages[0], sizeof(pResult->m_Data.m_aaMessages[0]),
+			"%s is not ranked", pData->m_aName);
+		return;
+	}
+
+	char aRegionalRank[16];
+	float RegionalTime;
+	if(Regional.Find(pData->m_aName, &RegionalTime))
+	{
+		str_format(aRegionalRank, sizeof(aRegionalRank), "rank %d", Regional.Rank(RegionalTime));
+	}
+	else
+	{
+		str_copy(aRegionalRank, "unranked", sizeof(aRegionalRank));
+	}
+
+	// same as PERCENT_RANK() of the database
+	int Rank = Global.Rank(Time);
+	float PercentRank = Global.Size() > 1 ? (double)(Rank - 1) / (Global.Size() - 1) : 0.0;
+	FormatRank(pData, pResult, Rank, Time, PercentRank, aRegionalRank);
+}
+
+void CScoreWorker::ShowTopCached(const CLeaderboard &Global, const CLeaderboard &Regional, const CSqlPlayerRequest *pData)
+{
+	auto *pResult = dynamic_cast<CScorePlayerResult *>(pData->m_pResult.get());
+
+	int LimitStart = maximum(absolute(pData->m_Offset) - 1, 0);
+	auto &&ShowLines = [&](const CLeaderboard &Leaderboard, int Line, int Count) {
+		for(int i = 0; i < Count && LimitStart + i < Leaderboard.Size(); i++)
+		{
+			int Index = pData->m_Offset >= 0 ? LimitStart + i : Leaderboard.Size() - 1 - LimitStart - i;
+			const char *pName;
+			float Time;
+			Leaderboard.Get(Index, &pName, &Time);
+			FormatTopLine(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+				Leaderboard.Rank(Time), pName, Time);
+			Line++;
+		}
+		return Line;
+	};
+
+	int Line = 0;
+	str_copy(pResult->m_Data.m_aaMessages[Line], "------------ Global Top ------------", sizeof(pResult->m_Data.m_aaMessages[Line]));
+	Line = ShowLines(Global, Line + 1, 5);
+
+	if(!g_Config.m_SvRegionalRankings)
+	{
+		str_copy(pResult->m_Data.m_aaMessages[Line], "-----------------------------------------", sizeof(pResult->m_Data.m_aaMessages[Line]));
+		return;
+	}
+
+	str_format(pResult->m_Data.m_aaMessages[Line], sizeof(pResult->m_Data.m_aaMessages[Line]),
+		"------------ %s Top ------------", pData->m_aServer);
+	ShowLines(Regional, Line + 1, 3);
+}
+
 bool CScoreWorker::ShowTeamTop5(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
 {
 	const auto *pData = dynamic_cast<const CSqlPlayerRequest *>(pGameData);
@@ -11,6 +11,7 @@
 #include <engine/server/databases/connection_pool.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/uuid_manager.h>
+#include <game/server/leaderboard.h>
 #include <game/server/save.h>
 #include <game/voting.h>
 
@@ -83,6 +84,25 @@ struct CSqlLoadBestTimeRequest : ISqlData
 	char m_aMap[MAX_MAP_LENGTH];
 };
 
+struct CScoreLeaderboardResult : ISqlResult
+{
+	CLeaderboard m_Global;
+	// only the times finished on servers of the region
+	CLeaderboard m_Regional;
+};
+
+struct CSqlLeaderboardRequest : ISqlData
+{
+	CSqlLeaderboardRequest(std::shared_ptr<CScoreLeaderboardResult> pResult) :
+		ISqlData(std::move(pResult))
+	{
+	}
+
+	// current map
+	char m_aMap[MAX_MAP_LENGTH];
+	char m_aServer[5];
+};
+
 struct CSqlPlayerRequest : ISqlData
 {
 	CSqlPlayerRequest(std::shared_ptr<CScorePlayerResult> pResult) :
@@ -287,6 +307,7 @@ struct CTeamrank
 struct CScoreWorker
 {
 	static bool LoadBestTime(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
+	static bool LoadLeaderboard(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 
 	static bool RandomMap(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool RandomUnfinishedMap(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
@@ -298,6 +319,9 @@ struct CScoreWorker
 	static bool ShowRank(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool ShowTeamRank(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool ShowTop(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
+	// same messages as ShowRank and ShowTop, but from the leaderboards of the current map
+	static void ShowRankCached(const CLeaderboard &Global, const CLeaderboard &Regional, const CSqlPlayerRequest *pData);
+	static void ShowTopCached(const CLeaderboard &Global, const CLeaderboard &Regional, const CSqlPlayerRequest *pData);
 	static bool ShowTeamTop5(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool ShowPlayerTeamTop5(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
 	static bool ShowTimes(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize);
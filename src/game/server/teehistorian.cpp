@@ -9,6 +9,8 @@
 
 #include <game/gamecore.h>
 
+#include <zlib.h>
+
 class CTeehistorianPacker : public CAbstractPacker
 {
 public:
@@ -79,8 +81,11 @@ void CTeeHistorian::Reset(const CGameInfo *pGameInfo, WRITE_CALLBACK pfnWriteCal
 	}
 	m_pfnWriteCallback = pfnWriteCallback;
 	m_pWriteCallbackUserdata = pUser;
+	m_vWriteBuffer.clear();
+	m_vWriteBuffer.reserve(FLUSH_THRESHOLD);
 
 	WriteHeader(pGameInfo);
+	Flush();
 
 	m_State = STATE_START;
 }
@@ -393,7 +398,21 @@ void CTeeHistorian::RecordTeamPractice(int Team, bool Practice)
 
 void CTeeHistorian::Write(const void *pData, int DataSize)
 {
-	m_pfnWriteCallback(pData, DataSize, m_pWriteCallbackUserdata);
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	m_vWriteBuffer.insert(m_vWriteBuffer.end(), pBytes, pBytes + DataSize);
+	if(m_vWriteBuffer.size() >= FLUSH_THRESHOLD)
+	{
+		Flush();
+	}
+}
+
+void CTeeHistorian::Flush()
+{
+	if(!m_vWriteBuffer.empty())
+	{
+		m_pfnWriteCallback(m_vWriteBuffer.data(), m_vWriteBuffer.size(), m_pWriteCallbackUserdata);
+		m_vWriteBuffer.clear();
+	}
 }
 
 void CTeeHistorian::EnsureTickWritten()
@@ -733,6 +752,9 @@ void CTeeHistorian::EndTick()
 {
 	dbg_assert(m_State == STATE_BEFORE_ENDTICK, "invalid teehistorian state");
 	m_State = STATE_BEFORE_TICK;
+
+	// hand the whole tick over at once
+	Flush();
 }
 
 void CTeeHistorian::RecordDDNetVersionOld(int ClientId, int DDNetVersion)
@@ -876,4 +898,69 @@ void CTeeHistorian::Finish()
 	}
 
 	Write(Buffer.Data(), Buffer.Size());
+	Flush();
+}
+
+class CTeeHistorianCompressor::CStream
+{
+public:
+	z_stream m_Stream;
+	unsigned char m_aOutput[64 * 1024];
+};
+
+CTeeHistorianCompressor::CTeeHistorianCompressor() :
+	m_pStream(std::make_unique<CStream>()),
+	m_LastSyncFlush(time_get())
+{
+	z_stream &Stream = m_pStream->m_Stream;
+	mem_zero(&Stream, sizeof(Stream));
+	// gzip framing so the files can be read with the usual tools
+	int Result = deflateInit2(&Stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	dbg_assert(Result == Z_OK, "teehistorian deflateInit2 failed");
+}
+
+CTeeHistorianCompressor::~CTeeHistorianCompressor()
+{
+	deflateEnd(&m_pStream->m_Stream);
+}
+
+void CTeeHistorianCompressor::Write(const void *pData, int DataSize, bool Finish, CTeeHistorian::WRITE_CALLBACK pfnWriteCallback, void *pUser)
+{
+	int ZlibFlush = Z_NO_FLUSH;
+	if(Finish)
+	{
+		ZlibFlush = Z_FINISH;
+	}
+	else if(time_get() - m_LastSyncFlush > time_freq())
+	{
+		ZlibFlush = Z_SYNC_FLUSH;
+		m_LastSyncFlush = time_get();
+	}
+
+	z_stream &Stream = m_pStream->m_Stream;
+	Stream.next_in = (Bytef *)pData;
+	Stream.avail_in = DataSize;
+	int Result;
+	do
+	{
+		Stream.next_out = m_pStream->m_aOutput;
+		Stream.avail_out = sizeof(m_pStream->m_aOutput);
+		Result = deflate(&Stream, ZlibFlush);
+		dbg_assert(Result != Z_STREAM_ERROR, "teehistorian deflate failed");
+		const int Size = sizeof(m_pStream->m_aOutput) - Stream.avail_out;
+		if(Size > 0)
+		{
+			pfnWriteCallback(m_pStream->m_aOutput, Size, pUser);
+		}
+	} while(Stream.avail_out == 0 || (ZlibFlush == Z_FINISH && Result != Z_STREAM_END));
+}
+
+static void WriteFile(const void *pData, int DataSize, void *pUser)
+{
+	io_write((IOHANDLE)pUser, pData, DataSize);
+}
+
+void CTeeHistorianCompressor::AioFilter(const void *pData, unsigned DataSize, bool Finish, IOHANDLE File, void *pUser)
+{
+	static_cast<CTeeHistorianCompressor *>(pUser)->Write(pData, DataSize, Finish, WriteFile, File);
 }
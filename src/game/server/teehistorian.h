@@ -7,6 +7,8 @@
 #include <game/generated/protocol.h>
 
 #include <ctime>
+#include <memory>
+#include <vector>
 
 class CConfig;
 class CTuningParams;
@@ -49,8 +51,11 @@ public:
 
 	CTeeHistorian();
 
+	// Records are collected and passed to the write callback once per tick.
 	void Reset(const CGameInfo *pGameInfo, WRITE_CALLBACK pfnWriteCallback, void *pUser);
 	void Finish();
+	// Passes everything recorded so far to the write callback.
+	void Flush();
 
 	bool Starting() const { return m_State == STATE_START; }
 
@@ -134,8 +139,14 @@ private:
 		bool m_Practice;
 	};
 
+	enum
+	{
+		FLUSH_THRESHOLD = 64 * 1024,
+	};
+
 	WRITE_CALLBACK m_pfnWriteCallback;
 	void *m_pWriteCallbackUserdata;
+	std::vector<unsigned char> m_vWriteBuffer;
 
 	int m_State;
 
@@ -148,4 +159,29 @@ private:
 	CTeam m_aPrevTeams[MAX_CLIENTS];
 };
 
+/**
+ * Gzip stream for the tee historian files.
+ *
+ * Used as the filter of the asynchronous file writer, so the compression
+ * runs on its thread instead of the server tick. The stream is made
+ * decodable about once per second, so a crashed server leaves a readable
+ * file.
+ */
+class CTeeHistorianCompressor
+{
+	class CStream;
+	std::unique_ptr<CStream> m_pStream;
+	int64_t m_LastSyncFlush;
+
+public:
+	CTeeHistorianCompressor();
+	~CTeeHistorianCompressor();
+
+	// Compresses the data and passes the output to the write callback.
+	void Write(const void *pData, int DataSize, bool Finish, CTeeHistorian::WRITE_CALLBACK pfnWriteCallback, void *pUser);
+
+	// `ASYNCIO_FILTER`, `pUser` is the compressor
+	static void AioFilter(const void *pData, unsigned DataSize, bool Finish, IOHANDLE File, void *pUser);
+};
+
 #endif // GAME_SERVER_TEEHISTORIAN_H
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+
+#include <engine/shared/adaptive_snap_rate.h>
+
+static constexpr int TICK_SPEED = 50;
+static constexpr int MAX_LEVEL = 3;
+static constexpr int LOAD_LIMIT = 60;
+
+// one second of ticks using the given percentage of the tick time
+static bool UpdateSecond(CAdaptiveSnapRate &Rate, int LoadPercent, int KiBPerSecond = 0, int BandwidthLimit = 0)
+{
+	Rate.AddSnapshotBytes(KiBPerSecond * 1024);
+	bool Updated = false;
+	for(int Tick = 0; Tick < TICK_SPEED; Tick++)
+	{
+		const std::chrono::nanoseconds Work = std::chrono::nanoseconds(std::chrono::seconds(1)) * LoadPercent / 100 / TICK_SPEED;
+		Updated = Rate.Update(1, Work, TICK_SPEED, MAX_LEVEL, LOAD_LIMIT, BandwidthLimit);
+		if(Tick < TICK_SPEED - 1)
+		{
+			EXPECT_FALSE(Updated);
+		}
+	}
+	return Updated;
+}
+
+TEST(AdaptiveSnapRate, LoadLevels)
+{
+	CAdaptiveSnapRate Rate;
+	EXPECT_TRUE(UpdateSecond(Rate, 10));
+	EXPECT_EQ(Rate.Level(), 0);
+	EXPECT_EQ(Rate.Load(), 10);
+
+	// one level per overloaded second, up to the maximum
+	for(int Level = 1; Level <= MAX_LEVEL + 1; Level++)
+	{
+		EXPECT_TRUE(UpdateSecond(Rate, 80));
+		EXPECT_EQ(Rate.Level(), minimum(Level, MAX_LEVEL));
+	}
+
+	// below the limit, but not relaxed enough to go down again
+	EXPECT_TRUE(UpdateSecond(Rate, 50));
+	EXPECT_EQ(Rate.Level(), MAX_LEVEL);
+	EXPECT_TRUE(UpdateSecond(Rate, 60));
+	EXPECT_EQ(Rate.Level(), MAX_LEVEL);
+
+	for(int Level = MAX_LEVEL - 1; Level >= -1; Level--)
+	{
+		EXPECT_TRUE(UpdateSecond(Rate, 30));
+		EXPECT_EQ(Rate.Level(), maximum(Level, 0));
+	}
+}
+
+TEST(AdaptiveSnapRate, BandwidthLevels)
+{
+	CAdaptiveSnapRate Rate;
+	// ignored without a limit
+	EXPECT_TRUE(UpdateSecond(Rate, 10, 1000));
+	EXPECT_EQ(Rate.Level(), 0);
+	EXPECT_EQ(Rate.Bandwidth(), 1000);
+
+	EXPECT_TRUE(UpdateSecond(Rate, 10, 1000, 500));
+	EXPECT_EQ(Rate.Level(), 1);
+	// hysteresis
+	EXPECT_TRUE(UpdateSecond(Rate, 10, 400, 500));
+	EXPECT_EQ(Rate.Level(), 1);
+	EXPECT_TRUE(UpdateSecond(Rate, 10, 300, 500));
+	EXPECT_EQ(Rate.Level(), 0);
+}
+
+TEST(AdaptiveSnapRate, Reset)
+{
+	CAdaptiveSnapRate Rate;
+	EXPECT_TRUE(UpdateSecond(Rate, 80));
+	EXPECT_EQ(Rate.Level(), 1);
+
+	// bytes counted while the adaptive rate is disabled don't count later
+	Rate.AddSnapshotBytes(100 * 1000 * 1024);
+	Rate.Reset();
+	EXPECT_EQ(Rate.Level(), 0);
+	EXPECT_TRUE(UpdateSecond(Rate, 10, 100, 500));
+	EXPECT_EQ(Rate.Level(), 0);
+	EXPECT_EQ(Rate.Bandwidth(), 100);
+}
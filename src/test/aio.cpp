@@ -144,3 +144,28 @@ TEST_F(Async, Transaction)
 	}
 	Expect(aText);
 }
+
+static void UppercaseFilter(const void *pData, unsigned Size, bool Finish, IOHANDLE File, void *pUser)
+{
+	int *pNumFinished = static_cast<int *>(pUser);
+	if(Finish)
+	{
+		(*pNumFinished)++;
+		io_write(File, "!", 1);
+		return;
+	}
+	char aBuf[BUF_SIZE];
+	for(unsigned i = 0; i < Size; i++)
+		aBuf[i] = str_uppercase(((const char *)pData)[i]);
+	io_write(File, aBuf, Size);
+}
+
+TEST_F(Async, Filter)
+{
+	int NumFinished = 0;
+	aio_set_filter(m_pAio, UppercaseFilter, &NumFinished);
+	Write("abc");
+	Write("def\n");
+	Expect("ABCDEF\n!");
+	EXPECT_EQ(NumFinished, 1);
+}
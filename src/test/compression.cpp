@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <base/system.h>
 #include <engine/shared/compression.h>
 
 static const int DATA[] = {0, 1, -1, 32, 64, 256, -512, 12345, -123456, 1234567, 12345678, 123456789, 2147483647, (-2147483647 - 1)};
@@ -82,3 +83,58 @@ TEST(CVariableInt, DecompressBufferTooSmall)
 	long CompressedSize = CVariableInt::Decompress(aCompressed, sizeof(aCompressed), aUncompressed, sizeof(aUncompressed));
 	ASSERT_EQ(CompressedSize, -1);
 }
+
+TEST(CVariableInt, CompressDecompressBulk)
+{
+	// mostly small values with some larger ones in between, as in snapshot deltas
+	int aData[1000];
+	unsigned Seed = 1234;
+	for(int &Value : aData)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		const int Random = (int)(Seed >> 8);
+		Value = Random % 5 == 0 ? Random * ((Seed & 1) ? 1 : -1) : Random % 128 - 64;
+	}
+
+	unsigned char aExpected[sizeof(aData) / sizeof(int) * CVariableInt::MAX_BYTES_PACKED];
+	unsigned char *pExpectedEnd = aExpected;
+	for(int Value : aData)
+		pExpectedEnd = CVariableInt::Pack(pExpectedEnd, Value, aExpected + sizeof(aExpected) - pExpectedEnd);
+	const long ExpectedSize = pExpectedEnd - aExpected;
+
+	unsigned char aCompressed[sizeof(aExpected)];
+	ASSERT_EQ(CVariableInt::Compress(aData, sizeof(aData), aCompressed, sizeof(aCompressed)), ExpectedSize);
+	EXPECT_EQ(mem_comp(aCompressed, aExpected, ExpectedSize), 0);
+
+	// exactly fitting and too small destination
+	ASSERT_EQ(CVariableInt::Compress(aData, sizeof(aData), aCompressed, ExpectedSize), ExpectedSize);
+	ASSERT_EQ(CVariableInt::Compress(aData, sizeof(aData), aCompressed, ExpectedSize - 1), -1);
+
+	int aDecompressed[std::size(aData)];
+	ASSERT_EQ(CVariableInt::Decompress(aCompressed, ExpectedSize, aDecompressed, sizeof(aDecompressed)), (long)sizeof(aData));
+	for(size_t i = 0; i < std::size(aData); i++)
+		EXPECT_EQ(aDecompressed[i], aData[i]);
+	ASSERT_EQ(CVariableInt::Decompress(aCompressed, ExpectedSize, aDecompressed, sizeof(aDecompressed) - sizeof(int)), -1);
+}
+
+TEST(CVariableInt, CompressDecompressSmall)
+{
+	// only single byte ints, including the limits of that range, so whole blocks take the fast path
+	int aData[1003];
+	for(size_t i = 0; i < std::size(aData); i++)
+		aData[i] = (int)(i * 7 % 128) - 64;
+
+	unsigned char aCompressed[std::size(aData)];
+	ASSERT_EQ(CVariableInt::Compress(aData, sizeof(aData), aCompressed, sizeof(aCompressed)), (long)sizeof(aCompressed));
+	for(size_t i = 0; i < std::size(aData); i++)
+	{
+		unsigned char aPacked[CVariableInt::MAX_BYTES_PACKED];
+		ASSERT_EQ(CVariableInt::Pack(aPacked, aData[i], sizeof(aPacked)) - aPacked, 1);
+		EXPECT_EQ(aCompressed[i], aPacked[0]);
+	}
+
+	int aDecompressed[std::size(aData)];
+	ASSERT_EQ(CVariableInt::Decompress(aCompressed, sizeof(aCompressed), aDecompressed, sizeof(aDecompressed)), (long)sizeof(aData));
+	for(size_t i = 0; i < std::size(aData); i++)
+		EXPECT_EQ(aDecompressed[i], aData[i]);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/server/databases/connection.h>
+#include <engine/server/databases/connection_pool.h>
+
+#include <test/test.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static std::atomic_bool gs_Blocked{false};
+static std::atomic_bool gs_Waiting{false};
+
+struct CPointsResult : ISqlResult
+{
+	int m_Points = 0;
+};
+
+struct CPointsRequest : ISqlData
+{
+	CPointsRequest(std::shared_ptr<ISqlResult> pResult, const char *pName, int Points) :
+		ISqlData(std::move(pResult)), m_Points(Points)
+	{
+		str_copy(m_aName, pName);
+	}
+	char m_aName[MAX_NAME_LENGTH];
+	int m_Points;
+};
+
+static bool AddPoints(IDbConnection *pSqlServer, const ISqlData *pGameData, Write w, char *pError, int ErrorSize)
+{
+	const CPointsRequest *pData = static_cast<const CPointsRequest *>(pGameData);
+	if(gs_Blocked)
+	{
+		gs_Waiting = true;
+		while(gs_Blocked)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		gs_Waiting = false;
+	}
+	if(pData->m_Points < 0)
+	{
+		str_copy(pError, "negative points", ErrorSize);
+		return true;
+	}
+	return pSqlServer->AddPoints(pData->m_aName, pData->m_Points, pError, ErrorSize);
+}
+
+static bool ShowPoints(IDbConnection *pSqlServer, const ISqlData *pGameData, char *pError, int ErrorSize)
+{
+	const CPointsRequest *pData = static_cast<const CPointsRequest *>(pGameData);
+	CPointsResult *pResult = static_cast<CPointsResult *>(pData->m_pResult.get());
+	if(pSqlServer->PrepareStatement("SELECT Points FROM record_points WHERE Name = ?", pError, ErrorSize))
+		return true;
+	pSqlServer->BindString(1, pData->m_aName);
+	bool End;
+	if(pSqlServer->Step(&End, pError, ErrorSize))
+		return true;
+	pResult->m_Points = End ? 0 : pSqlServer->GetInt(1);
+	return false;
+}
+
+static void WaitForCompletion(const std::vector<std::shared_ptr<ISqlResult>> &vpResults)
+{
+	for(const auto &pResult : vpResults)
+	{
+		for(int i = 0; i < 1000 && !pResult->m_Completed; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		ASSERT_TRUE(pResult->m_Completed);
+	}
+}
+
+class ConnectionPool : public testing::Test
+{
+protected:
+	CTestInfo m_Info;
+	char m_aFilename[IO_MAX_PATH_LENGTH];
+	std::unique_ptr<CDbConnectionPool> m_pPool;
+
+	ConnectionPool()
+	{
+		m_Info.Filename(m_aFilename, sizeof(m_aFilename), ".sqlite");
+		m_pPool = std::make_unique<CDbConnectionPool>();
+		m_pPool->SetWriteBatchSize(16);
+		m_pPool->SetNumReadWorkers(2);
+		m_pPool->RegisterSqliteDatabase(CDbConnectionPool::READ, m_aFilename);
+		m_pPool->RegisterSqliteDatabase(CDbConnectionPool::WRITE, m_aFilename);
+	}
+
+	~ConnectionPool() override
+	{
+		m_pPool = nullptr;
+		char aBuf[IO_MAX_PATH_LENGTH];
+		fs_remove(m_aFilename);
+		str_format(aBuf, sizeof(aBuf), "%s-wal", m_aFilename);
+		fs_remove(aBuf);
+		str_format(aBuf, sizeof(aBuf), "%s-shm", m_aFilename);
+		fs_remove(aBuf);
+	}
+
+	std::shared_ptr<ISqlResult> Write(const char *pName, int Points)
+	{
+		auto pResult = std::make_shared<ISqlResult>();
+		m_pPool->ExecuteWrite(AddPoints, std::make_unique<CPointsRequest>(pResult, pName, Points), "add points");
+		return pResult;
+	}
+
+	int Read(const char *pName)
+	{
+		auto pResult = std::make_shared<CPointsResult>();
+		m_pPool->Execute(ShowPoints, std::make_unique<CPointsRequest>(pResult, pName, 0), "show points");
+		WaitForCompletion({pResult});
+		EXPECT_TRUE(pResult->m_Success);
+		return pResult->m_Points;
+	}
+
+	// blocks the write worker, so that the following writes are queued up
+	std::vector<std::shared_ptr<ISqlResult>> QueueWrites(const std::vector<int> &vPoints)
+	{
+		gs_Blocked = true;
+		std::vector<std::shared_ptr<ISqlResult>> vpResults = {Write("blocker", 1)};
+		while(!gs_Waiting)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		for(int Points : vPoints)
+			vpResults.push_back(Write("nameless tee", Points));
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		gs_Blocked = false;
+		return vpResults;
+	}
+};
+
+TEST_F(ConnectionPool, BatchedWrites)
+{
+	const auto vpResults = QueueWrites(std::vector<int>(10, 2));
+	WaitForCompletion(vpResults);
+	for(const auto &pResult : vpResults)
+		EXPECT_TRUE(pResult->m_Success);
+	EXPECT_EQ(Read("nameless tee"), 20);
+	EXPECT_EQ(Read("blocker"), 1);
+	EXPECT_EQ(Read("brainless tee"), 0);
+
+	const CDbConnectionPool::CStats Stats = m_pPool->Stats();
+	EXPECT_EQ(Stats.m_aQueued[true], 11);
+	EXPECT_EQ(Stats.m_aCompleted[true], 11);
+	EXPECT_EQ(Stats.m_aCompleted[false], 3);
+	EXPECT_EQ(Stats.m_aFailed[true], 0);
+	EXPECT_EQ(Stats.QueueDepth(true), 0);
+	EXPECT_EQ(Stats.m_Batches, 1);
+	EXPECT_EQ(Stats.m_BatchedWrites, 10);
+	EXPECT_GE(Stats.m_MaxQueueDepth, 11);
+	EXPECT_GE(Stats.m_aMaxLatency[true], 100000);
+}
+
+TEST_F(ConnectionPool, FailedBatchIsRolledBack)
+{
+	const auto vpResults = QueueWrites({1, 2, -1, 4});
+	WaitForCompletion(vpResults);
+	EXPECT_TRUE(vpResults[1]->m_Success);
+	EXPECT_TRUE(vpResults[2]->m_Success);
+	EXPECT_FALSE(vpResults[3]->m_Success);
+	EXPECT_TRUE(vpResults[4]->m_Success);
+	// the writes before the failing one are not applied twice
+	EXPECT_EQ(Read("nameless tee"), 7);
+
+	const CDbConnectionPool::CStats Stats = m_pPool->Stats();
+	EXPECT_EQ(Stats.m_aFailed[true], 1);
+	EXPECT_EQ(Stats.m_Batches, 0);
+}
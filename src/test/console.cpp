@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+
+#include <string>
+#include <vector>
+
+static void CountCallback(IConsole::IResult *pResult, void *pUserData)
+{
+	(*static_cast<int *>(pUserData))++;
+}
+
+static void PossibleCallback(int Index, const char *pStr, void *pUser)
+{
+	static_cast<std::vector<std::string> *>(pUser)->emplace_back(pStr);
+}
+
+TEST(Console, FindCommandCaseInsensitive)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	int Count = 0;
+	pConsole->Register("test_command", "", CFGFLAG_SERVER, CountCallback, &Count, "");
+
+	EXPECT_TRUE(pConsole->GetCommandInfo("test_command", CFGFLAG_SERVER, false));
+	EXPECT_TRUE(pConsole->GetCommandInfo("TEST_Command", CFGFLAG_SERVER, false));
+	EXPECT_FALSE(pConsole->GetCommandInfo("test_command", CFGFLAG_CLIENT, false));
+	EXPECT_FALSE(pConsole->GetCommandInfo("test_command", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(pConsole->GetCommandInfo("test_comman", CFGFLAG_SERVER, false));
+
+	pConsole->ExecuteLine("test_command");
+	pConsole->ExecuteLine("Test_Command; TEST_COMMAND");
+	pConsole->ExecuteLine("test_command_unknown");
+	EXPECT_EQ(Count, 3);
+}
+
+TEST(Console, SameNameDifferentFlags)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	int CountServer = 0;
+	int CountChat = 0;
+	pConsole->Register("rank", "", CFGFLAG_SERVER, CountCallback, &CountServer, "");
+	pConsole->Register("rank", "", CFGFLAG_CHAT, CountCallback, &CountChat, "");
+
+	pConsole->ExecuteLine("rank");
+	EXPECT_EQ(CountServer, 1);
+	EXPECT_EQ(CountChat, 0);
+
+	pConsole->ExecuteLineFlag("rank", CFGFLAG_CHAT);
+	EXPECT_EQ(CountServer, 1);
+	EXPECT_EQ(CountChat, 1);
+}
+
+TEST(Console, TempCommands)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_CLIENT);
+	pConsole->RegisterTemp("remote_a", "", CFGFLAG_SERVER, "");
+	pConsole->RegisterTemp("remote_b", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(pConsole->GetCommandInfo("remote_a", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("REMOTE_B", CFGFLAG_SERVER, true));
+
+	pConsole->DeregisterTemp("remote_a");
+	EXPECT_FALSE(pConsole->GetCommandInfo("remote_a", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("remote_b", CFGFLAG_SERVER, true));
+
+	// recycled entries must be found by their new name only
+	pConsole->RegisterTemp("remote_c", "", CFGFLAG_SERVER, "");
+	EXPECT_FALSE(pConsole->GetCommandInfo("remote_a", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("remote_c", CFGFLAG_SERVER, true));
+
+	pConsole->DeregisterTempAll();
+	EXPECT_FALSE(pConsole->GetCommandInfo("remote_b", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(pConsole->GetCommandInfo("remote_c", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("exec", CFGFLAG_CLIENT, false));
+
+	pConsole->RegisterTemp("remote_a", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(pConsole->GetCommandInfo("remote_a", CFGFLAG_SERVER, true));
+}
+
+TEST(Console, PossibleCommands)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_CLIENT);
+	pConsole->Register("cl_foo", "", CFGFLAG_CLIENT, CountCallback, nullptr, "");
+	pConsole->Register("cl_bar", "", CFGFLAG_CLIENT, CountCallback, nullptr, "");
+	pConsole->Register("sv_foo", "", CFGFLAG_SERVER, CountCallback, nullptr, "");
+
+	std::vector<std::string> vPossible;
+	EXPECT_EQ(pConsole->PossibleCommands("FOO", CFGFLAG_CLIENT, false, PossibleCallback, &vPossible), 1);
+	EXPECT_EQ(vPossible, std::vector<std::string>({"cl_foo"}));
+
+	vPossible.clear();
+	EXPECT_EQ(pConsole->PossibleCommands("cl_", CFGFLAG_CLIENT, false, PossibleCallback, &vPossible), 2);
+	EXPECT_EQ(vPossible, std::vector<std::string>({"cl_bar", "cl_foo"}));
+}
+
+TEST(Console, ManyCommands)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	const int NumCommands = 2000;
+	std::vector<std::string> vNames;
+	vNames.reserve(NumCommands);
+	for(int i = 0; i < NumCommands; i++)
+	{
+		char aName[32];
+		str_format(aName, sizeof(aName), "sv_setting_%d", i);
+		vNames.emplace_back(aName);
+	}
+
+	int Count = 0;
+	for(const std::string &Name : vNames)
+		pConsole->Register(Name.c_str(), "?i[value]", CFGFLAG_SERVER, CountCallback, &Count, "");
+
+	// mimic executing a large config file
+	for(int Pass = 0; Pass < 10; Pass++)
+	{
+		for(int i = NumCommands - 1; i >= 0; i--)
+		{
+			char aLine[64];
+			str_format(aLine, sizeof(aLine), "%s %d", vNames[i].c_str(), i);
+			pConsole->ExecuteLine(aLine);
+		}
+	}
+	EXPECT_EQ(Count, NumCommands * 10);
+}
+
+static void StrokeCallback(IConsole::IResult *pResult, void *pUserData)
+{
+	static_cast<std::vector<int> *>(pUserData)->push_back(pResult->GetInteger(0));
+}
+
+TEST(Console, StrokeCommands)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_CLIENT);
+	std::vector<int> vStrokes;
+	int Count = 0;
+	pConsole->Register("+fire", "", CFGFLAG_CLIENT, StrokeCallback, &vStrokes, "");
+	pConsole->Register("cl_value", "?i[value]", CFGFLAG_CLIENT, CountCallback, &Count, "");
+
+	pConsole->ExecuteLine("+fire");
+	EXPECT_EQ(vStrokes, std::vector<int>({1, 0}));
+	EXPECT_EQ(Count, 0);
+
+	vStrokes.clear();
+	pConsole->ExecuteLine("cl_value 1; +fire; cl_value 2");
+	EXPECT_EQ(vStrokes, std::vector<int>({1, 0}));
+	EXPECT_EQ(Count, 2);
+
+	vStrokes.clear();
+	pConsole->ExecuteLine("cl_value 3");
+	EXPECT_TRUE(vStrokes.empty());
+	EXPECT_EQ(Count, 3);
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <base/hash.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/demo.h>
+#include <engine/shared/network.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+
+#include <test/test.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+static int BuildSnapshot(int Tick, char *pData)
+{
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	for(int Id = 0; Id < 8 + Tick % 5; Id++)
+	{
+		int *pItem = (int *)Builder.NewItem(1 + Id % 3, Id, 4 * sizeof(int));
+		for(int i = 0; i < 4; i++)
+			pItem[i] = (Tick / (Id + 1)) * (i + 1);
+	}
+	return Builder.Finish(pData);
+}
+
+// records the same demo to all files at the same time
+static void RecordDemos(IStorage *pStorage, const std::vector<const char *> &vpFilenames, CDemoWriter *pWriter, const std::function<void(int Tick)> &OnTick = nullptr)
+{
+	CNetBase::Init();
+	CSnapshotDelta SnapshotDelta;
+	std::vector<CDemoRecorder> vRecorders(vpFilenames.size(), CDemoRecorder(&SnapshotDelta, true));
+	unsigned char aMapData[1] = {0};
+	for(size_t i = 0; i < vRecorders.size(); i++)
+		ASSERT_EQ(vRecorders[i].Start(pStorage, nullptr, vpFilenames[i], "0.6 626fce9a778df4d4", "test", SHA256_ZEROED, 0, "server", 0, aMapData, nullptr, nullptr, nullptr, pWriter), 0);
+
+	char aData[CSnapshot::MAX_SIZE];
+	for(int Tick = 1; Tick < 800; Tick++)
+	{
+		// gaps between ticks, to also write uncompressed tick markers
+		if(Tick % 200 == 0)
+			Tick += 40;
+		if(OnTick)
+			OnTick(Tick);
+
+		const int Size = BuildSnapshot(Tick, aData);
+		for(auto &Recorder : vRecorders)
+			Recorder.RecordSnapshot(Tick, aData, Size);
+
+		if(Tick % 7 == 0)
+		{
+			char aMessage[32];
+			str_format(aMessage, sizeof(aMessage), "message %d", Tick);
+			for(auto &Recorder : vRecorders)
+				Recorder.RecordMessage(aMessage, str_length(aMessage) + 1);
+		}
+		if(Tick % 100 == 0)
+		{
+			for(auto &Recorder : vRecorders)
+				Recorder.AddDemoMarker(Tick);
+		}
+	}
+	for(auto &Recorder : vRecorders)
+	{
+		if(!pWriter || pWriter->NumDropped() == 0)
+		{
+			EXPECT_EQ(Recorder.Length(), (799 - 1) / SERVER_TICK_SPEED);
+		}
+		EXPECT_EQ(Recorder.Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+	}
+}
+
+static void RecordDemo(IStorage *pStorage, const char *pFilename)
+{
+	RecordDemos(pStorage, {pFilename}, nullptr);
+}
+
+TEST(Demo, ThreadedRecorderIdentical)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	std::unique_ptr<IStorage> pStorage(Info.CreateTestStorage());
+	ASSERT_TRUE(pStorage);
+
+	RecordDemo(pStorage.get(), "direct.demo");
+	// all recorders share the thread of one writer
+	CDemoWriter Writer;
+	RecordDemos(pStorage.get(), {"threaded0.demo", "threaded1.demo", "threaded2.demo"}, &Writer);
+	EXPECT_EQ(Writer.NumDropped(), 0);
+
+	void *pDirect;
+	unsigned DirectSize;
+	ASSERT_TRUE(pStorage->ReadFile("direct.demo", IStorage::TYPE_SAVE, &pDirect, &DirectSize));
+	ASSERT_GT(DirectSize, sizeof(CDemoHeader));
+	for(const char *pFilename : {"threaded0.demo", "threaded1.demo", "threaded2.demo"})
+	{
+		void *pThreaded;
+		unsigned ThreadedSize;
+		ASSERT_TRUE(pStorage->ReadFile(pFilename, IStorage::TYPE_SAVE, &pThreaded, &ThreadedSize));
+		ASSERT_EQ(DirectSize, ThreadedSize);
+
+		// the header contains the timestamp of the recording
+		CDemoHeader DirectHeader, ThreadedHeader;
+		mem_copy(&DirectHeader, pDirect, sizeof(CDemoHeader));
+		mem_copy(&ThreadedHeader, pThreaded, sizeof(CDemoHeader));
+		mem_zero(DirectHeader.m_aTimestamp, sizeof(DirectHeader.m_aTimestamp));
+		mem_zero(ThreadedHeader.m_aTimestamp, sizeof(ThreadedHeader.m_aTimestamp));
+		EXPECT_EQ(mem_comp(&DirectHeader, &ThreadedHeader, sizeof(CDemoHeader)), 0);
+		EXPECT_EQ(mem_comp((char *)pDirect + sizeof(CDemoHeader), (char *)pThreaded + sizeof(CDemoHeader), DirectSize - sizeof(CDemoHeader)), 0);
+
+		free(pThreaded);
+		EXPECT_TRUE(pStorage->RemoveFile(pFilename, IStorage::TYPE_SAVE));
+	}
+
+	free(pDirect);
+	EXPECT_TRUE(pStorage->RemoveFile("direct.demo", IStorage::TYPE_SAVE));
+}
+
+class CSnapshotCollector : public CDemoPlayer::IListener
+{
+public:
+	struct CEntry
+	{
+		int m_Tick;
+		int m_PreviousTick;
+		std::vector<unsigned char> m_vData;
+	};
+
+	CDemoPlayer *m_pDemoPlayer;
+	std::vector<CEntry> m_vSnapshots;
+
+	void OnDemoPlayerSnapshot(void *pData, int Size) override
+	{
+		const CDemoPlayer::CPlaybackInfo *pInfo = m_pDemoPlayer->Info();
+		m_vSnapshots.push_back({pInfo->m_Info.m_CurrentTick, pInfo->m_PreviousTick, std::vector<unsigned char>((unsigned char *)pData, (unsigned char *)pData + Size)});
+	}
+
+	void OnDemoPlayerMessage(void *pData, int Size) override {}
+};
+
+TEST(Demo, SeekMatchesPlayback)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	std::unique_ptr<IStorage> pStorage(Info.CreateTestStorage());
+	ASSERT_TRUE(pStorage);
+	RecordDemo(pStorage.get(), "seek.demo");
+
+	CSnapshotDelta SnapshotDelta;
+	CDemoPlayer DemoPlayer(&SnapshotDelta, false);
+	CSnapshotCollector Collector;
+	Collector.m_pDemoPlayer = &DemoPlayer;
+	DemoPlayer.SetListener(&Collector);
+	ASSERT_EQ(DemoPlayer.Load(pStorage.get(), nullptr, "seek.demo", IStorage::TYPE_SAVE), 0);
+
+	// play back everything to know the snapshot of every tick
+	DemoPlayer.Play();
+	while(DemoPlayer.IsPlaying() && !DemoPlayer.Info()->m_Info.m_Paused)
+		DemoPlayer.Update(false);
+	std::map<int, std::vector<unsigned char>> SnapshotsByTick;
+	for(const auto &Snapshot : Collector.m_vSnapshots)
+		SnapshotsByTick[Snapshot.m_Tick] = Snapshot.m_vData;
+	ASSERT_GT(SnapshotsByTick.size(), 600u);
+
+	for(int WantedTick : {1, 2, 100, 239, 240, 251, 500, 641, 799, 1000})
+	{
+		Collector.m_vSnapshots.clear();
+		ASSERT_EQ(DemoPlayer.SetPos(WantedTick), 0);
+		ASSERT_TRUE(DemoPlayer.IsPlaying());
+
+		// only the previous and the current tick are passed to the listener,
+		// ignore the repeated last snapshot for the empty tick before the keyframe
+		Collector.m_vSnapshots.erase(std::remove_if(Collector.m_vSnapshots.begin(), Collector.m_vSnapshots.end(), [](const auto &Snapshot) { return Snapshot.m_Tick == -1; }), Collector.m_vSnapshots.end());
+		const CDemoPlayer::CPlaybackInfo *pInfo = DemoPlayer.Info();
+		EXPECT_GE(pInfo->m_NextTick, minimum(WantedTick, pInfo->m_Info.m_LastTick));
+		ASSERT_GE(Collector.m_vSnapshots.size(), 1u);
+		ASSERT_LE(Collector.m_vSnapshots.size(), 2u);
+		const auto &Current = Collector.m_vSnapshots.back();
+		EXPECT_EQ(Current.m_Tick, pInfo->m_Info.m_CurrentTick);
+		EXPECT_EQ(Current.m_PreviousTick, pInfo->m_PreviousTick);
+		EXPECT_EQ(Current.m_vData, SnapshotsByTick[Current.m_Tick]);
+		if(Collector.m_vSnapshots.size() == 2)
+		{
+			const auto &Previous = Collector.m_vSnapshots.front();
+			EXPECT_EQ(Previous.m_Tick, pInfo->m_PreviousTick);
+			EXPECT_EQ(Previous.m_vData, SnapshotsByTick[Previous.m_Tick]);
+		}
+	}
+
+	DemoPlayer.Stop();
+	EXPECT_TRUE(pStorage->RemoveFile("seek.demo", IStorage::TYPE_SAVE));
+}
+
+TEST(Demo, ThreadedRecorderDropsChunks)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	std::unique_ptr<IStorage> pStorage(Info.CreateTestStorage());
+	ASSERT_TRUE(pStorage);
+
+	// the buffer fills up while the writer is paused, chunks are dropped
+	// instead of waiting
+	CDemoWriter Writer(16 * 1024);
+	const std::vector<const char *> vpFilenames = {"dropped0.demo", "dropped1.demo", "dropped2.demo", "dropped3.demo"};
+	RecordDemos(pStorage.get(), vpFilenames, &Writer, [&](int Tick) {
+		if(Tick == 100)
+			Writer.Pause();
+		else if(Tick == 300)
+			Writer.Resume();
+	});
+	EXPECT_GT(Writer.NumDropped(), 0);
+
+	// the snapshots that were written still play back correctly
+	for(const char *pFilename : vpFilenames)
+	{
+		CSnapshotDelta SnapshotDelta;
+		CDemoPlayer DemoPlayer(&SnapshotDelta, false);
+		CSnapshotCollector Collector;
+		Collector.m_pDemoPlayer = &DemoPlayer;
+		DemoPlayer.SetListener(&Collector);
+		ASSERT_EQ(DemoPlayer.Load(pStorage.get(), nullptr, pFilename, IStorage::TYPE_SAVE), 0);
+		DemoPlayer.Play();
+		while(DemoPlayer.IsPlaying() && !DemoPlayer.Info()->m_Info.m_Paused)
+			DemoPlayer.Update(false);
+		DemoPlayer.Stop();
+
+		ASSERT_FALSE(Collector.m_vSnapshots.empty());
+		int LastTick = 0;
+		for(const auto &Snapshot : Collector.m_vSnapshots)
+		{
+			if(Snapshot.m_Tick == LastTick)
+				continue;
+			ASSERT_GT(Snapshot.m_Tick, LastTick);
+			LastTick = Snapshot.m_Tick;
+			char aData[CSnapshot::MAX_SIZE];
+			const int Size = BuildSnapshot(Snapshot.m_Tick, aData);
+			EXPECT_EQ(Snapshot.m_vData, std::vector<unsigned char>((unsigned char *)aData, (unsigned char *)aData + Size)) << pFilename << " tick " << Snapshot.m_Tick;
+		}
+		EXPECT_TRUE(pStorage->RemoveFile(pFilename, IStorage::TYPE_SAVE));
+	}
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/client/demo_info_cache.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/storage.h>
+
+#include <test/test.h>
+
+#include <memory>
+
+static IDemoInfoCache::CEntry MakeEntry(const char *pMapName, int Length)
+{
+	IDemoInfoCache::CEntry Entry;
+	mem_zero(&Entry, sizeof(Entry));
+	Entry.m_Valid = true;
+	mem_copy(Entry.m_Info.m_aMarker, gs_aHeaderMarker, sizeof(gs_aHeaderMarker));
+	Entry.m_Info.m_Version = 6;
+	str_copy(Entry.m_Info.m_aNetversion, "0.6 626fce9a778df4d4");
+	str_copy(Entry.m_Info.m_aMapName, pMapName);
+	str_copy(Entry.m_Info.m_aType, "client");
+	str_copy(Entry.m_Info.m_aTimestamp, "2024-01-01 00:00:00");
+	uint_to_bytes_be(Entry.m_Info.m_aLength, Length);
+	uint_to_bytes_be(Entry.m_TimelineMarkers.m_aNumTimelineMarkers, 1);
+	uint_to_bytes_be(Entry.m_TimelineMarkers.m_aTimelineMarkers[0], 123);
+	str_copy(Entry.m_MapInfo.m_aName, pMapName);
+	Entry.m_MapInfo.m_Crc = 0xdeadbeef;
+	Entry.m_MapInfo.m_Size = 1234;
+	Entry.m_MapInfo.m_Sha256.data[0] = 42;
+	return Entry;
+}
+
+TEST(DemoInfoCache, StoreAndLoad)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+
+	auto pConsole = CreateConsole(CFGFLAG_CLIENT);
+	auto pStorage = std::unique_ptr<IStorage>(Info.CreateTestStorage());
+
+	const IDemoInfoCache::CEntry First = MakeEntry("Multeasymap", 60);
+	const IDemoInfoCache::CEntry Second = MakeEntry("Tutorial", 300);
+	IDemoInfoCache::CEntry Invalid;
+	mem_zero(&Invalid, sizeof(Invalid));
+	{
+		auto pCache = std::unique_ptr<IDemoInfoCache>(CreateDemoInfoCache(pConsole.get(), pStorage.get()));
+		pCache->Load();
+		EXPECT_EQ(pCache->NumEntries(), 0);
+
+		pCache->Store("/demos/first.demo", 1000, First);
+		pCache->Store("/demos/second.demo", 2000, Second);
+		pCache->Store("/demos/broken.demo", 3000, Invalid);
+		pCache->Store("/demos/second.demo", 2001, Second);
+		EXPECT_EQ(pCache->NumEntries(), 3);
+
+		IDemoInfoCache::CEntry Entry;
+		EXPECT_TRUE(pCache->Get("/demos/first.demo", 1000, &Entry));
+		EXPECT_FALSE(pCache->Get("/demos/second.demo", 2000, &Entry));
+		EXPECT_FALSE(pCache->Get("/demos/third.demo", 1000, &Entry));
+		pCache->Flush();
+	}
+
+	auto pCache = std::unique_ptr<IDemoInfoCache>(CreateDemoInfoCache(pConsole.get(), pStorage.get()));
+	pCache->Load();
+	EXPECT_EQ(pCache->NumEntries(), 3);
+
+	IDemoInfoCache::CEntry Entry;
+	ASSERT_TRUE(pCache->Get("/demos/first.demo", 1000, &Entry));
+	EXPECT_TRUE(Entry.m_Valid);
+	EXPECT_EQ(mem_comp(&Entry.m_Info, &First.m_Info, sizeof(CDemoHeader)), 0);
+	EXPECT_EQ(mem_comp(&Entry.m_TimelineMarkers, &First.m_TimelineMarkers, sizeof(CTimelineMarkers)), 0);
+	EXPECT_STREQ(Entry.m_MapInfo.m_aName, "Multeasymap");
+	EXPECT_EQ(Entry.m_MapInfo.m_Sha256, First.m_MapInfo.m_Sha256);
+	EXPECT_EQ(Entry.m_MapInfo.m_Crc, 0xdeadbeefu);
+	EXPECT_EQ(Entry.m_MapInfo.m_Size, 1234u);
+
+	ASSERT_TRUE(pCache->Get("/demos/second.demo", 2001, &Entry));
+	EXPECT_EQ(bytes_be_to_uint(Entry.m_Info.m_aLength), 300u);
+	EXPECT_FALSE(pCache->Get("/demos/first.demo", 1001, &Entry));
+
+	ASSERT_TRUE(pCache->Get("/demos/broken.demo", 3000, &Entry));
+	EXPECT_FALSE(Entry.m_Valid);
+}
+
+TEST(DemoInfoCache, RemoveMissing)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+
+	auto pConsole = CreateConsole(CFGFLAG_CLIENT);
+	auto pStorage = std::unique_ptr<IStorage>(Info.CreateTestStorage());
+
+	const IDemoInfoCache::CEntry Entry = MakeEntry("Multeasymap", 60);
+	{
+		auto pCache = std::unique_ptr<IDemoInfoCache>(CreateDemoInfoCache(pConsole.get(), pStorage.get()));
+		pCache->Load();
+		pCache->Store("/demos/kept.demo", 1000, Entry);
+		pCache->Store("/demos/deleted.demo", 1000, Entry);
+		pCache->Store("/demos/auto/other.demo", 1000, Entry);
+		pCache->Store("/demosother/other.demo", 1000, Entry);
+		pCache->Flush();
+
+		// only demos directly in the folder are removed
+		pCache->RemoveMissing("/demos", {"/demos/kept.demo"});
+		EXPECT_EQ(pCache->NumEntries(), 3);
+		IDemoInfoCache::CEntry Loaded;
+		EXPECT_FALSE(pCache->Get("/demos/deleted.demo", 1000, &Loaded));
+
+		// stored again before the removal was written
+		pCache->RemoveMissing("/demos/auto", {});
+		pCache->Store("/demos/auto/other.demo", 2000, Entry);
+		pCache->Flush();
+	}
+
+	auto pCache = std::unique_ptr<IDemoInfoCache>(CreateDemoInfoCache(pConsole.get(), pStorage.get()));
+	pCache->Load();
+	EXPECT_EQ(pCache->NumEntries(), 3);
+	IDemoInfoCache::CEntry Loaded;
+	EXPECT_TRUE(pCache->Get("/demos/kept.demo", 1000, &Loaded));
+	EXPECT_FALSE(pCache->Get("/demos/deleted.demo", 1000, &Loaded));
+	EXPECT_TRUE(pCache->Get("/demos/auto/other.demo", 2000, &Loaded));
+	EXPECT_TRUE(pCache->Get("/demosother/other.demo", 1000, &Loaded));
+}
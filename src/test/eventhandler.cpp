@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <game/server/eventhandler.h>
+
+#include <cmath>
+#include <limits>
+
+TEST(EventHandler, ViewCells)
+{
+	int MinCellX, MinCellY, MaxCellX, MaxCellY;
+	ASSERT_TRUE(CEventHandler::ViewCells(vec2(1500.0f, 100.0f), vec2(1000.0f, 800.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_EQ(MinCellX, 0);
+	EXPECT_EQ(MaxCellX, 2);
+	EXPECT_EQ(MinCellY, -1);
+	EXPECT_EQ(MaxCellY, 0);
+
+	// views spanning more cells than there are buckets check all events
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(0.0f, 0.0f), vec2(100000.0f, 100000.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+}
+
+TEST(EventHandler, ViewCellsHugeShowDistance)
+{
+	// the show distance comes from the client and must not overflow the conversion to int
+	int MinCellX, MinCellY, MaxCellX, MaxCellY;
+	const float Huge = std::numeric_limits<int>::max();
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(Huge, Huge), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(Huge, 800.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(800.0f, Huge), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(-Huge, -Huge), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(INFINITY, 800.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_FALSE(CEventHandler::ViewCells(vec2(100.0f, 100.0f), vec2(NAN, 800.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+}
+
+TEST(EventHandler, ViewCellsNegativeShowDistance)
+{
+	// nothing is visible, the range of cells is empty
+	int MinCellX, MinCellY, MaxCellX, MaxCellY;
+	ASSERT_TRUE(CEventHandler::ViewCells(vec2(5000.0f, 5000.0f), vec2(-3000.0f, -3000.0f), &MinCellX, &MinCellY, &MaxCellX, &MaxCellY));
+	EXPECT_LT(MaxCellX, MinCellX);
+	EXPECT_LT(MaxCellY, MinCellY);
+}
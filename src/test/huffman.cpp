@@ -46,3 +46,39 @@ TEST(Huffman, CompressionCompatible)
 	EXPECT_EQ(match, 0) << "The compression is not compatible with older/other implementations anymore";
 	EXPECT_EQ(Size, 15);
 }
+
+TEST(Huffman, RoundtripLarge)
+{
+	CHuffman Huffman;
+	Huffman.Init();
+
+	unsigned char aInput[1400];
+	unsigned char aCompressed[4096];
+	unsigned char aDecompressed[4096];
+	unsigned Seed = 1;
+	for(int Pattern = 0; Pattern < 3; Pattern++)
+	{
+		for(int Size = 0; Size <= (int)sizeof(aInput); Size += 97)
+		{
+			for(int i = 0; i < Size; i++)
+			{
+				Seed = Seed * 1103515245 + 12345;
+				const unsigned char Random = Seed >> 16;
+				// snapshot-like (mostly zeros), text-like and random data
+				aInput[i] = Pattern == 0 ? (Random % 8 == 0 ? Random : 0) : Pattern == 1 ? 'a' + Random % 26 : Random;
+			}
+
+			const int CompressedSize = Huffman.Compress(aInput, Size, aCompressed, sizeof(aCompressed));
+			ASSERT_GT(CompressedSize, 0);
+			EXPECT_EQ(Huffman.Compress(aInput, Size, aCompressed, CompressedSize), CompressedSize);
+			EXPECT_EQ(Huffman.Compress(aInput, Size, aCompressed, CompressedSize - 1), -1);
+
+			ASSERT_EQ(Huffman.Decompress(aCompressed, CompressedSize, aDecompressed, sizeof(aDecompressed)), Size);
+			EXPECT_EQ(mem_comp(aInput, aDecompressed, Size), 0);
+			if(Size > 0)
+			{
+				EXPECT_EQ(Huffman.Decompress(aCompressed, CompressedSize, aDecompressed, Size - 1), -1);
+			}
+		}
+	}
+}
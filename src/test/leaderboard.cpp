@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/server/leaderboard.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(Leaderboard, Empty)
+{
+	CLeaderboard Leaderboard;
+	float Time;
+	EXPECT_EQ(Leaderboard.Size(), 0);
+	EXPECT_FALSE(Leaderboard.Find("nameless tee", &Time));
+	EXPECT_EQ(Leaderboard.Rank(100.0f), 1);
+}
+
+TEST(Leaderboard, KeepsBestTime)
+{
+	CLeaderboard Leaderboard;
+	EXPECT_TRUE(Leaderboard.Add("a", 100.0f));
+	EXPECT_TRUE(Leaderboard.Add("b", 90.0f));
+	EXPECT_FALSE(Leaderboard.Add("a", 110.0f));
+	EXPECT_TRUE(Leaderboard.Add("a", 80.0f));
+	EXPECT_EQ(Leaderboard.Size(), 2);
+
+	float Time;
+	ASSERT_TRUE(Leaderboard.Find("a", &Time));
+	EXPECT_EQ(Time, 80.0f);
+	EXPECT_EQ(Leaderboard.Rank(80.0f), 1);
+	EXPECT_EQ(Leaderboard.Rank(90.0f), 2);
+	EXPECT_EQ(Leaderboard.Rank(95.0f), 3);
+
+	const char *pName;
+	Leaderboard.Get(1, &pName, &Time);
+	EXPECT_STREQ(pName, "b");
+	EXPECT_EQ(Time, 90.0f);
+
+	Leaderboard.Clear();
+	EXPECT_EQ(Leaderboard.Size(), 0);
+	EXPECT_FALSE(Leaderboard.Find("a", &Time));
+}
+
+TEST(Leaderboard, Ties)
+{
+	CLeaderboard Leaderboard;
+	Leaderboard.Add("c", 50.0f);
+	Leaderboard.Add("a", 50.0f);
+	Leaderboard.Add("b", 40.0f);
+	EXPECT_EQ(Leaderboard.Rank(40.0f), 1);
+	EXPECT_EQ(Leaderboard.Rank(50.0f), 2);
+	EXPECT_EQ(Leaderboard.Rank(60.0f), 4);
+
+	const char *apNames[] = {"b", "a", "c"};
+	for(int i = 0; i < 3; i++)
+	{
+		const char *pName;
+		float Time;
+		Leaderboard.Get(i, &pName, &Time);
+		EXPECT_STREQ(pName, apNames[i]);
+	}
+}
+
+TEST(Leaderboard, SameAsSorted)
+{
+	CLeaderboard Leaderboard;
+	std::vector<std::pair<float, std::string>> vExpected;
+	unsigned Seed = 1;
+	for(int i = 0; i < 2000; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		char aName[16];
+		str_format(aName, sizeof(aName), "tee%u", (Seed >> 8) % 500);
+		float Time = (Seed >> 16) % 1000 / 10.0f;
+		Leaderboard.Add(aName, Time);
+
+		auto It = std::find_if(vExpected.begin(), vExpected.end(), [&](const auto &Entry) { return Entry.second == aName; });
+		if(It == vExpected.end())
+			vExpected.emplace_back(Time, aName);
+		else
+			It->first = std::min(It->first, Time);
+	}
+	std::sort(vExpected.begin(), vExpected.end());
+
+	ASSERT_EQ(Leaderboard.Size(), (int)vExpected.size());
+	for(int i = 0; i < Leaderboard.Size(); i++)
+	{
+		const char *pName;
+		float Time;
+		Leaderboard.Get(i, &pName, &Time);
+		EXPECT_EQ(pName, vExpected[i].second);
+		EXPECT_EQ(Time, vExpected[i].first);
+		int Rank = std::lower_bound(vExpected.begin(), vExpected.end(), std::make_pair(Time, std::string())) - vExpected.begin() + 1;
+		EXPECT_EQ(Leaderboard.Rank(Time), Rank);
+	}
+}
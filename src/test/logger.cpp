@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <memory>
+#include <vector>
+
+static const int NUM_THREADS = 4;
+static const int NUM_MESSAGES = 2000;
+
+struct CLoggingThread
+{
+	ILogger *m_pLogger;
+	int m_Thread;
+};
+
+static void LoggingThread(void *pUser)
+{
+	const CLoggingThread *pInfo = static_cast<const CLoggingThread *>(pUser);
+	CLogScope LogScope(pInfo->m_pLogger);
+	for(int i = 0; i < NUM_MESSAGES; i++)
+		log_info("test", "%d %d", pInfo->m_Thread, i);
+}
+
+TEST(ThreadedLogger, Sync)
+{
+	auto pMemoryLogger = std::make_shared<CMemoryLogger>();
+	CThreadedLogger Logger(pMemoryLogger);
+	CLogScope LogScope(&Logger);
+	log_info("test", "hello");
+	EXPECT_EQ(pMemoryLogger->Lines().size(), 1u);
+}
+
+TEST(ThreadedLogger, AsyncMultipleProducers)
+{
+	auto pMemoryLogger = std::make_shared<CMemoryLogger>();
+	CThreadedLogger Logger(pMemoryLogger);
+	Logger.SetAsync(true);
+
+	CLoggingThread aInfos[NUM_THREADS];
+	void *apThreads[NUM_THREADS];
+	for(int t = 0; t < NUM_THREADS; t++)
+	{
+		aInfos[t] = {&Logger, t};
+		apThreads[t] = thread_init(LoggingThread, &aInfos[t], "test logger");
+	}
+	for(void *pThread : apThreads)
+		thread_wait(pThread);
+	Logger.Flush();
+
+	// every message arrives exactly once and in order per thread, unless it
+	// was dropped and counted
+	int aNext[NUM_THREADS] = {0};
+	int Received = 0;
+	for(const CLogMessage &Message : pMemoryLogger->Lines())
+	{
+		if(str_comp(Message.m_aSystem, "test") != 0)
+			continue;
+		int Thread, Index;
+		ASSERT_EQ(sscanf(Message.Message(), "%d %d", &Thread, &Index), 2);
+		ASSERT_GE(Index, aNext[Thread]);
+		aNext[Thread] = Index + 1;
+		Received++;
+	}
+	EXPECT_EQ(Received + Logger.NumDropped(), NUM_THREADS * NUM_MESSAGES);
+
+	// nothing is queued anymore, messages are passed on directly again
+	Logger.SetAsync(false);
+	const size_t NumLines = pMemoryLogger->Lines().size();
+	{
+		CLogScope LogScope(&Logger);
+		log_info("test", "sync");
+	}
+	EXPECT_EQ(pMemoryLogger->Lines().size(), NumLines + 1);
+}
+
+TEST(ThreadedLogger, GlobalFinishFlushes)
+{
+	auto pMemoryLogger = std::make_shared<CMemoryLogger>();
+	CThreadedLogger Logger(pMemoryLogger);
+	Logger.SetAsync(true);
+	{
+		CLogScope LogScope(&Logger);
+		for(int i = 0; i < 100; i++)
+			log_info("test", "%d", i);
+	}
+	Logger.GlobalFinish();
+	EXPECT_EQ((int64_t)pMemoryLogger->Lines().size() + Logger.NumDropped(), 100);
+}
+
+TEST(ThreadedLogger, FilterBeforeQueue)
+{
+	auto pMemoryLogger = std::make_shared<CMemoryLogger>();
+	pMemoryLogger->SetFilter(CLogFilter{LEVEL_TRACE});
+	CThreadedLogger Logger(pMemoryLogger);
+	Logger.SetFilter(CLogFilter{LEVEL_INFO});
+	Logger.SetAsync(true);
+	{
+		// far more messages than fit into the queue
+		CLogScope LogScope(&Logger);
+		for(int i = 0; i < 100000; i++)
+			log_debug("test", "%d", i);
+		log_info("test", "info");
+	}
+	Logger.Flush();
+	EXPECT_EQ(Logger.NumDropped(), 0);
+	ASSERT_EQ(pMemoryLogger->Lines().size(), 1u);
+	EXPECT_STREQ(pMemoryLogger->Lines()[0].Message(), "info");
+}
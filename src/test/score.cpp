@@ -627,6 +627,112 @@ TEST_P(RandomMap, UnfinishedDoesntExist)
 	EXPECT_STREQ(m_pRandomMapResult->m_aMessage, "nameless tee has no more unfinished maps on this server!");
 }
 
+struct CachedRanks : public Score
+{
+	CachedRanks()
+	{
+		InsertRank("a", 100.0f, "GER");
+		InsertRank("b", 90.5f, "USA");
+		InsertRank("c", 120.25f, "GER");
+		InsertRank("d", 80.0f, "USA");
+		InsertRank("e", 110.0f, "GER");
+		InsertRank("a", 85.0f, "USA");
+		InsertRank("f", 130.75f, "GER");
+		InsertRank("g", 95.0f, "USA");
+
+		CSqlLeaderboardRequest Request(m_pLeaderboardResult);
+		str_copy(Request.m_aMap, "Kobra 3", sizeof(Request.m_aMap));
+		str_copy(Request.m_aServer, "GER", sizeof(Request.m_aServer));
+		EXPECT_FALSE(CScoreWorker::LoadLeaderboard(m_pConn, &Request, m_aError, sizeof(m_aError))) << m_aError;
+
+		str_copy(m_PlayerRequest.m_aMap, "Kobra 3", sizeof(m_PlayerRequest.m_aMap));
+		str_copy(m_PlayerRequest.m_aServer, "GER", sizeof(m_PlayerRequest.m_aServer));
+		str_copy(m_PlayerRequest.m_aRequestingPlayer, "brainless tee", sizeof(m_PlayerRequest.m_aRequestingPlayer));
+	}
+
+	void InsertRank(const char *pName, float Time, const char *pServer)
+	{
+		str_copy(g_Config.m_SvSqlServerName, pServer, sizeof(g_Config.m_SvSqlServerName));
+		CSqlScoreData ScoreData(std::make_shared<CScorePlayerResult>());
+		str_copy(ScoreData.m_aMap, "Kobra 3", sizeof(ScoreData.m_aMap));
+		str_copy(ScoreData.m_aGameUuid, "8d300ecf-5873-4297-bee5-95668fdff320", sizeof(ScoreData.m_aGameUuid));
+		str_copy(ScoreData.m_aName, pName, sizeof(ScoreData.m_aName));
+		ScoreData.m_ClientId = 0;
+		ScoreData.m_Time = Time;
+		str_copy(ScoreData.m_aTimestamp, "2021-11-24 19:24:08", sizeof(ScoreData.m_aTimestamp));
+		for(float &TimeCp : ScoreData.m_aCurrentTimeCp)
+			TimeCp = 0;
+		str_copy(ScoreData.m_aRequestingPlayer, pName, sizeof(ScoreData.m_aRequestingPlayer));
+		ASSERT_FALSE(CScoreWorker::SaveScore(m_pConn, &ScoreData, Write::NORMAL, m_aError, sizeof(m_aError))) << m_aError;
+	}
+
+	void ExpectSameLines(bool (*pfnSql)(IDbConnection *, const ISqlData *, char *, int),
+		void (*pfnCached)(const CLeaderboard &, const CLeaderboard &, const CSqlPlayerRequest *))
+	{
+		auto pSqlResult = std::make_shared<CScorePlayerResult>();
+		m_PlayerRequest.m_pResult = pSqlResult;
+		ASSERT_FALSE(pfnSql(m_pConn, &m_PlayerRequest, m_aError, sizeof(m_aError))) << m_aError;
+
+		auto pCachedResult = std::make_shared<CScorePlayerResult>();
+		m_PlayerRequest.m_pResult = pCachedResult;
+		pfnCached(m_pLeaderboardResult->m_Global, m_pLeaderboardResult->m_Regional, &m_PlayerRequest);
+
+		EXPECT_EQ(pCachedResult->m_MessageKind, pSqlResult->m_MessageKind);
+		for(int i = 0; i < CScorePlayerResult::MAX_MESSAGES; i++)
+		{
+			EXPECT_STREQ(pCachedResult->m_Data.m_aaMessages[i], pSqlResult->m_Data.m_aaMessages[i])
+				<< "name=" << m_PlayerRequest.m_aName << " offset=" << m_PlayerRequest.m_Offset;
+		}
+	}
+
+	void ExpectSameAsDatabase()
+	{
+		for(int Regional = 0; Regional < 2; Regional++)
+		{
+			g_Config.m_SvRegionalRankings = Regional;
+			for(const char *pName : {"a", "b", "c", "d", "e", "f", "g", "h", "unknown"})
+			{
+				str_copy(m_PlayerRequest.m_aName, pName, sizeof(m_PlayerRequest.m_aName));
+				ExpectSameLines(CScoreWorker::ShowRank, CScoreWorker::ShowRankCached);
+			}
+			str_copy(m_PlayerRequest.m_aName, "", sizeof(m_PlayerRequest.m_aName));
+			for(int Offset : {0, 1, 3, 7, 20, -1, -4, -9})
+			{
+				m_PlayerRequest.m_Offset = Offset;
+				ExpectSameLines(CScoreWorker::ShowTop, CScoreWorker::ShowTopCached);
+			}
+		}
+	}
+
+	std::shared_ptr<CScoreLeaderboardResult> m_pLeaderboardResult{std::make_shared<CScoreLeaderboardResult>()};
+};
+
+TEST_P(CachedRanks, Loaded)
+{
+	EXPECT_EQ(m_pLeaderboardResult->m_Global.Size(), 7);
+	EXPECT_EQ(m_pLeaderboardResult->m_Regional.Size(), 4);
+	ExpectSameAsDatabase();
+}
+
+TEST_P(CachedRanks, NewFinishes)
+{
+	// added the same way as the server adds its own finishes
+	for(auto [pName, Time] : {std::pair<const char *, float>{"h", 70.5f}, {"c", 101.0f}, {"f", 140.0f}})
+	{
+		InsertRank(pName, Time, "GER");
+		m_pLeaderboardResult->m_Global.Add(pName, Time);
+		m_pLeaderboardResult->m_Regional.Add(pName, Time);
+	}
+	ExpectSameAsDatabase();
+}
+
+TEST_P(CachedRanks, HideScore)
+{
+	g_Config.m_SvHideScore = 1;
+	ExpectSameAsDatabase();
+	g_Config.m_SvHideScore = 0;
+}
+
 auto g_pSqliteConn = CreateSqliteConnection(":memory:", true);
 #if defined(CONF_TEST_MYSQL)
 CMysqlConfig gMysqlConfig{
@@ -668,3 +774,4 @@ INSTANTIATE(MapInfo);
 INSTANTIATE(MapVote);
 INSTANTIATE(Points);
 INSTANTIATE(RandomMap);
+INSTANTIATE(CachedRanks);
@@ -1,11 +1,16 @@
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <base/system.h>
 
+#include <engine/client/serverbrowser.h>
+#include <engine/client/serverbrowser_http.h>
 #include <engine/client/serverbrowser_ping_cache.h>
 #include <engine/console.h>
 #include <engine/engine.h>
+#include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
 #include <engine/storage.h>
 #include <test/test.h>
@@ -99,3 +104,124 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), 345);
 }
+
+static const char SERVERLIST[] = R"({"servers": [
+	{"addresses": ["tw-0.6+udp://127.0.0.1:8303", "tw-0.7+udp://127.0.0.1:8303"], "location": "eu",
+		"info": {"max_clients": 64, "max_players": 64, "passworded": false, "game_type": "DDraceNetwork", "name": "first",
+			"map": {"name": "Kobra 3"}, "version": "0.6.4, 18.0", "clients": [
+				{"name": "nameless tee", "clan": "", "country": -1, "score": 0, "is_player": true}]}},
+	{"addresses": ["tw-0.7+udp://[::1]:8304"],
+		"info": {"max_clients": 16, "max_players": 8, "passworded": true, "game_type": "DM", "name": "second",
+			"map": {"name": "dm1"}, "version": "0.7.5", "clients": []}},
+	{"addresses": ["tw-0.6+udp://127.0.0.1:8305"], "info": {"name": "invalid info is skipped"}},
+	{"addresses": ["unknown://127.0.0.1:8306"],
+		"info": {"max_clients": 16, "max_players": 8, "passworded": false, "game_type": "DM", "name": "no address",
+			"map": {"name": "dm1"}, "version": "0.6.4", "clients": []}}
+]})";
+
+TEST(ServerBrowser, ParseServers)
+{
+	std::vector<CServerInfo> vServers;
+	ASSERT_FALSE(ServerbrowserParseServers((const unsigned char *)SERVERLIST, str_length(SERVERLIST), &vServers));
+	ASSERT_EQ(vServers.size(), 2u);
+
+	EXPECT_STREQ(vServers[0].m_aName, "first");
+	EXPECT_STREQ(vServers[0].m_aMap, "Kobra 3");
+	EXPECT_EQ(vServers[0].m_Location, CServerInfo::LOC_EUROPE);
+	EXPECT_EQ(vServers[0].m_MaxClients, 64);
+	EXPECT_EQ(vServers[0].m_NumClients, 1);
+	// 0.7 addresses are only used if there's no 0.6 address
+	ASSERT_EQ(vServers[0].m_NumAddresses, 1);
+	char aAddr[NETADDR_MAXSTRSIZE];
+	net_addr_str(&vServers[0].m_aAddresses[0], aAddr, sizeof(aAddr), true);
+	EXPECT_STREQ(aAddr, "127.0.0.1:8303");
+
+	EXPECT_STREQ(vServers[1].m_aName, "second");
+	EXPECT_TRUE(vServers[1].m_Flags & SERVER_FLAG_PASSWORD);
+	EXPECT_EQ(vServers[1].m_Location, CServerInfo::LOC_UNKNOWN);
+	EXPECT_EQ(vServers[1].m_NumAddresses, 1);
+}
+
+TEST(ServerBrowser, ParseServersInvalid)
+{
+	std::vector<CServerInfo> vServers;
+	const char aNotJson[] = "{\"servers\": [";
+	EXPECT_TRUE(ServerbrowserParseServers((const unsigned char *)aNotJson, str_length(aNotJson), &vServers));
+	const char aNoServers[] = "{\"servers\": {}}";
+	EXPECT_TRUE(ServerbrowserParseServers((const unsigned char *)aNoServers, str_length(aNoServers), &vServers));
+	const char aBadLocation[] = "{\"servers\": [{\"addresses\": [], \"location\": \"xx\", \"info\": {}}]}";
+	EXPECT_TRUE(ServerbrowserParseServers((const unsigned char *)aBadLocation, str_length(aBadLocation), &vServers));
+	EXPECT_TRUE(vServers.empty());
+}
+
+static void RandomizeServerEntry(IServerBrowser::CServerEntry *pEntry)
+{
+	// few distinct values, so that many servers compare equal
+	static const char *const s_apNames[] = {"A", "B", "C", "D"};
+	pEntry->m_GotInfo = secure_rand_below(4) != 0;
+	str_copy(pEntry->m_Info.m_aName, s_apNames[secure_rand_below(std::size(s_apNames))]);
+	str_copy(pEntry->m_Info.m_aMap, s_apNames[secure_rand_below(std::size(s_apNames))]);
+	str_copy(pEntry->m_Info.m_aGameType, s_apNames[secure_rand_below(std::size(s_apNames))]);
+	pEntry->m_Info.m_Latency = secure_rand_below(40) * 10;
+	pEntry->m_Info.m_NumFilteredPlayers = secure_rand_below(5);
+	pEntry->m_Info.m_NumClients = pEntry->m_Info.m_NumFilteredPlayers + secure_rand_below(2);
+	pEntry->m_Info.m_FriendNum = secure_rand_below(3);
+}
+
+TEST(ServerBrowser, ResortMatchesSort)
+{
+	const int NumServers = 200;
+	std::vector<IServerBrowser::CServerEntry> vServers(NumServers);
+	std::vector<IServerBrowser::CServerEntry *> vpServerlist(NumServers);
+	for(int i = 0; i < NumServers; i++)
+	{
+		vServers[i].m_NeedResort = false;
+		vServers[i].m_Info.m_ServerIndex = i;
+		vpServerlist[i] = &vServers[i];
+	}
+	const auto IsFiltered = [](IServerBrowser::CServerEntry *pEntry) {
+		return pEntry->m_Info.m_Latency % 70 == 0;
+	};
+	const auto FullSort = [&](int Sort, int SortOrder) {
+		std::vector<int> vSorted;
+		for(int i = 0; i < NumServers; i++)
+		{
+			if(!IsFiltered(vpServerlist[i]))
+				vSorted.push_back(i);
+		}
+		CServerBrowser::SortServers(vpServerlist.data(), vSorted.data(), vSorted.size(), Sort, SortOrder);
+		return vSorted;
+	};
+
+	for(int Sort = IServerBrowser::SORT_NAME; Sort <= IServerBrowser::SORT_NUMFRIENDS; Sort++)
+	{
+		for(int SortOrder = 0; SortOrder <= 2; SortOrder++)
+		{
+			SCOPED_TRACE(std::string("sort=") + std::to_string(Sort) + " order=" + std::to_string(SortOrder));
+			for(auto &Server : vServers)
+				RandomizeServerEntry(&Server);
+
+			std::vector<int> vSorted = FullSort(Sort, SortOrder);
+			int NumSorted = vSorted.size();
+			vSorted.resize(NumServers);
+			for(int Round = 0; Round < 50; Round++)
+			{
+				std::vector<int> vChanged;
+				const int NumChanged = 1 + secure_rand_below(10);
+				for(int i = 0; i < NumChanged; i++)
+				{
+					// the same server may be requested more than once
+					int Index = secure_rand_below(NumServers);
+					RandomizeServerEntry(vpServerlist[Index]);
+					vChanged.push_back(Index);
+				}
+				NumSorted = CServerBrowser::ResortServers(vpServerlist.data(), vSorted.data(), NumSorted, vChanged, IsFiltered, Sort, SortOrder);
+
+				const std::vector<int> vExpected = FullSort(Sort, SortOrder);
+				ASSERT_EQ(std::vector<int>(vSorted.begin(), vSorted.begin() + NumSorted), vExpected) << "round " << Round;
+				for(const auto &Server : vServers)
+					ASSERT_FALSE(Server.m_NeedResort);
+			}
+		}
+	}
+}
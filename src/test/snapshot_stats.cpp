@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/snapshot.h>
+#include <engine/shared/snapshot_stats.h>
+#include <game/generated/protocol.h>
+
+static int BuildSnapshot(char *pData, int NumPickups, int NumFlags)
+{
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	for(int i = 0; i < NumPickups; i++)
+		mem_zero(Builder.NewItem(CNetObj_Pickup::ms_MsgId, i, sizeof(CNetObj_Pickup)), sizeof(CNetObj_Pickup));
+	for(int i = 0; i < NumFlags; i++)
+		mem_zero(Builder.NewItem(CNetObj_Flag::ms_MsgId, i, sizeof(CNetObj_Flag)), sizeof(CNetObj_Flag));
+	return Builder.Finish(pData);
+}
+
+static const char *TypeName(int Type, bool Sixup)
+{
+	return Type == NETOBJTYPE_PICKUP ? "pickup" : "flag";
+}
+
+TEST(SnapshotStats, Counters)
+{
+	CSnapshotStats Stats;
+	Stats.Reset();
+
+	char aData[CSnapshot::MAX_SIZE];
+	const CSnapshot *pSnapshot = (const CSnapshot *)aData;
+	int Size = BuildSnapshot(aData, 10, 2);
+	Stats.AddSnapshot(0, false, pSnapshot, Size);
+	Stats.AddDelta(0, 100, 50, 1);
+	Stats.AddSnapshot(0, false, pSnapshot, Size);
+	Stats.AddDelta(0, 20, 10, 1);
+	Size = BuildSnapshot(aData, 1, 2);
+	Stats.AddSnapshot(3, false, pSnapshot, Size);
+
+	EXPECT_EQ(Stats.Client(0).m_Snapshots, 2);
+	EXPECT_EQ(Stats.Client(0).m_Items, 24);
+	EXPECT_EQ(Stats.Client(0).m_DeltaBytes, 120);
+	EXPECT_EQ(Stats.Client(0).m_CompressedBytes, 60);
+	EXPECT_EQ(Stats.Client(0).m_Packets, 2);
+	EXPECT_EQ(Stats.Total().m_Items, 27);
+
+	std::vector<CSnapshotStats::CType> vTypes = Stats.TopTypes(-1, 8);
+	ASSERT_EQ(vTypes.size(), 2u);
+	EXPECT_EQ(vTypes[0].m_Type, NETOBJTYPE_PICKUP);
+	EXPECT_EQ(vTypes[0].m_Counters.m_Items, 21);
+	EXPECT_EQ(vTypes[0].m_Counters.m_RawBytes, 21 * (int)(sizeof(CSnapshotItem) + sizeof(CNetObj_Pickup)));
+	EXPECT_EQ(vTypes[1].m_Type, NETOBJTYPE_FLAG);
+	EXPECT_EQ(vTypes[1].m_Counters.m_Items, 6);
+
+	vTypes = Stats.TopTypes(3, 1);
+	ASSERT_EQ(vTypes.size(), 1u);
+	EXPECT_EQ(vTypes[0].m_Type, NETOBJTYPE_FLAG);
+
+	EXPECT_EQ(Stats.FormatJson(3, 1, TypeName),
+		"{\"client\":3,\"snapshots\":1,\"items\":3,\"raw_bytes\":" + std::to_string(Stats.Client(3).m_RawBytes) +
+			",\"delta_bytes\":0,\"compressed_bytes\":0,\"packets\":0,\"types\":[{\"type\":5,\"name\":\"flag\",\"sixup\":false,\"items\":2,\"raw_bytes\":32}]}");
+
+	Stats.ResetClient(0);
+	EXPECT_EQ(Stats.Client(0).m_Snapshots, 0);
+	EXPECT_EQ(Stats.TopTypes(-1, 8).size(), 2u);
+	Stats.Reset();
+	EXPECT_TRUE(Stats.TopTypes(-1, 8).empty());
+}
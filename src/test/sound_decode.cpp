@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/sound_decode.h>
+#include <engine/engine.h>
+#include <engine/shared/jobs.h>
+
+#include <functional>
+#include <vector>
+
+static short TestSampleValue(int Frame, int Channel)
+{
+	return (short)((Frame * 7 + Channel * 1000) % 65536 - 32768);
+}
+
+// Decodes generated data in packets of varying length, like Opus does
+class CTestDecoder : public ISampleDecoder
+{
+	int m_NumFrames;
+	int m_NumChannels;
+	int m_ErrorFrame;
+	SEMAPHORE *m_pStart;
+	int m_Pos = 0;
+
+public:
+	CTestDecoder(int NumFrames, int NumChannels, int ErrorFrame = -1, SEMAPHORE *pStart = nullptr) :
+		m_NumFrames(NumFrames),
+		m_NumChannels(NumChannels),
+		m_ErrorFrame(ErrorFrame),
+		m_pStart(pStart)
+	{
+	}
+
+	int Read(short *pOut, int NumFrames) override
+	{
+		if(m_pStart)
+		{
+			sphore_wait(m_pStart);
+			m_pStart = nullptr;
+		}
+		if(m_ErrorFrame >= 0 && m_Pos >= m_ErrorFrame)
+			return -1;
+		const int Packet = 960 * (1 + m_Pos % 3);
+		const int Read = minimum(minimum(NumFrames, Packet), m_NumFrames - m_Pos);
+		for(int Frame = 0; Frame < Read; Frame++)
+		{
+			for(int Channel = 0; Channel < m_NumChannels; Channel++)
+				*pOut++ = TestSampleValue(m_Pos + Frame, Channel);
+		}
+		m_Pos += Read;
+		return Read;
+	}
+};
+
+class CTestJob : public IJob
+{
+	std::function<void()> m_JobFunction;
+	void Run() override { m_JobFunction(); }
+
+public:
+	CTestJob(std::function<void()> &&JobFunction) :
+		m_JobFunction(std::move(JobFunction)) {}
+};
+
+static void WaitDecoded(const CSampleDecodeState &State, int NumFrames)
+{
+	while(State.m_NumDecodedFrames.load(std::memory_order_acquire) < NumFrames)
+		thread_yield();
+}
+
+static std::shared_ptr<CSampleDecodeState> CreateDecodeState(int NumFrames, int NumChannels)
+{
+	std::shared_ptr<CSampleDecodeState> pState = std::make_shared<CSampleDecodeState>();
+	pState->m_pData = (short *)calloc((size_t)NumFrames * NumChannels, sizeof(short));
+	return pState;
+}
+
+TEST(SoundDecode, BackgroundMatchesSync)
+{
+	std::unique_ptr<IEngine> pEngine(CreateTestEngine("test", 2));
+	// a minute of audio and a bit, so that the last chunk is not full
+	const int NumFrames = 60 * SOUND_DECODE_CHUNK_FRAMES + 123;
+	for(int NumChannels = 1; NumChannels <= 2; NumChannels++)
+	{
+		std::vector<short> vSync((size_t)NumFrames * NumChannels);
+		CTestDecoder Decoder(NumFrames, NumChannels);
+		EXPECT_EQ(SoundDecode(&Decoder, vSync.data(), NumFrames, NumChannels), NumFrames);
+		EXPECT_EQ(vSync.back(), TestSampleValue(NumFrames - 1, NumChannels - 1));
+
+		std::shared_ptr<CSampleDecodeState> pState = CreateDecodeState(NumFrames, NumChannels);
+		SoundDecodeInBackground(pEngine.get(), pState, std::make_unique<CTestDecoder>(NumFrames, NumChannels), NumFrames, NumChannels);
+		WaitDecoded(*pState, NumFrames);
+		EXPECT_EQ(mem_comp(pState->m_pData, vSync.data(), vSync.size() * sizeof(short)), 0);
+	}
+}
+
+TEST(SoundDecode, BackgroundError)
+{
+	std::unique_ptr<IEngine> pEngine(CreateTestEngine("test", 1));
+	const int NumFrames = 5 * SOUND_DECODE_CHUNK_FRAMES;
+	const int ErrorFrame = 2 * SOUND_DECODE_CHUNK_FRAMES + 960;
+
+	std::vector<short> vSync(NumFrames);
+	CTestDecoder Decoder(NumFrames, 1, ErrorFrame);
+	EXPECT_LT(SoundDecode(&Decoder, vSync.data(), NumFrames, 1), 0);
+
+	// the rest of the sample stays silent
+	std::shared_ptr<CSampleDecodeState> pState = CreateDecodeState(NumFrames, 1);
+	SoundDecodeInBackground(pEngine.get(), pState, std::make_unique<CTestDecoder>(NumFrames, 1, ErrorFrame), NumFrames, 1);
+	WaitDecoded(*pState, NumFrames);
+	EXPECT_EQ(pState->m_pData[ErrorFrame - 1], TestSampleValue(ErrorFrame - 1, 0));
+	for(int Frame = ErrorFrame; Frame < NumFrames; Frame++)
+	{
+		ASSERT_EQ(pState->m_pData[Frame], 0) << "frame " << Frame;
+	}
+}
+
+TEST(SoundDecode, BackgroundOneChunkPerJob)
+{
+	// with a single worker, a job that is added while the sample is decoded
+	// runs after the first chunk instead of after the whole sample
+	std::unique_ptr<IEngine> pEngine(CreateTestEngine("test", 1));
+	const int NumFrames = 10 * SOUND_DECODE_CHUNK_FRAMES;
+	SEMAPHORE Start;
+	sphore_init(&Start);
+
+	std::shared_ptr<CSampleDecodeState> pState = CreateDecodeState(NumFrames, 2);
+	SoundDecodeInBackground(pEngine.get(), pState, std::make_unique<CTestDecoder>(NumFrames, 2, -1, &Start), NumFrames, 2);
+	int DecodedFrames = -1;
+	std::shared_ptr<CTestJob> pJob = std::make_shared<CTestJob>([&]() {
+		DecodedFrames = pState->m_NumDecodedFrames.load(std::memory_order_acquire);
+	});
+	pEngine->AddJob(pJob);
+	sphore_signal(&Start);
+
+	while(!pJob->Done())
+		thread_yield();
+	EXPECT_EQ(DecodedFrames, SOUND_DECODE_CHUNK_FRAMES);
+
+	WaitDecoded(*pState, NumFrames);
+	sphore_destroy(&Start);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/client/sound_mix.h>
+
+#include <limits>
+#include <vector>
+
+static std::vector<short> RandomSamples(unsigned Count)
+{
+	std::vector<short> vSamples(Count);
+	for(short &Sample : vSamples)
+		Sample = (short)(rand() % 65536 - 32768);
+	// the extremes as well
+	if(Count >= 2)
+	{
+		vSamples[0] = std::numeric_limits<short>::min();
+		vSamples[1] = std::numeric_limits<short>::max();
+	}
+	return vSamples;
+}
+
+TEST(SoundMix, MixVoiceMatchesScalar)
+{
+	for(int Channels = 1; Channels <= 2; Channels++)
+	{
+		// frame counts that do and do not fill whole vectors
+		for(unsigned Frames : {0u, 1u, 3u, 8u, 17u, 1024u})
+		{
+			const std::vector<short> vIn = RandomSamples(Frames * Channels + 1);
+			std::vector<int> vExpected(Frames * 2 + 1, 12345);
+			std::vector<int> vActual = vExpected;
+			SoundMixVoiceScalar(vExpected.data(), vIn.data() + 1, Channels, Frames, 255, 17);
+			SoundMixVoice(vActual.data(), vIn.data() + 1, Channels, Frames, 255, 17);
+			EXPECT_EQ(vActual, vExpected) << "Channels=" << Channels << " Frames=" << Frames;
+		}
+	}
+}
+
+TEST(SoundMix, MixVoiceLargeVolume)
+{
+	const std::vector<short> vIn = RandomSamples(64);
+	std::vector<int> vExpected(64, 0);
+	std::vector<int> vActual = vExpected;
+	SoundMixVoiceScalar(vExpected.data(), vIn.data(), 2, 32, 40000, 0);
+	SoundMixVoice(vActual.data(), vIn.data(), 2, 32, 40000, 0);
+	EXPECT_EQ(vActual, vExpected);
+}
+
+TEST(SoundMix, ConvertMatchesScalar)
+{
+	std::vector<int> vIn(1027);
+	for(int &Value : vIn)
+		Value = rand() % 40000000 - 20000000;
+	vIn[0] = 0;
+	vIn[1] = -1;
+	vIn[2] = 101 * 256;
+	vIn[3] = -101 * 256;
+
+	for(int MasterVol : {0, 1, 50, 100})
+	{
+		std::vector<short> vExpected(vIn.size());
+		std::vector<short> vActual(vIn.size());
+		SoundConvertMixScalar(vExpected.data(), vIn.data(), vIn.size(), MasterVol);
+		SoundConvertMix(vActual.data(), vIn.data(), vIn.size(), MasterVol);
+		EXPECT_EQ(vActual, vExpected) << "MasterVol=" << MasterVol;
+	}
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/spsc_queue.h>
+
+TEST(SpscQueue, PushPop)
+{
+	CSpscQueue<int, 4> Queue;
+	int Item;
+	EXPECT_FALSE(Queue.Pop(&Item));
+
+	EXPECT_TRUE(Queue.Push(1));
+	EXPECT_TRUE(Queue.Push(2));
+	EXPECT_TRUE(Queue.Push(3));
+	EXPECT_FALSE(Queue.Push(4));
+
+	ASSERT_TRUE(Queue.Pop(&Item));
+	EXPECT_EQ(Item, 1);
+	EXPECT_TRUE(Queue.Push(4));
+	for(int Expected = 2; Expected <= 4; Expected++)
+	{
+		ASSERT_TRUE(Queue.Pop(&Item));
+		EXPECT_EQ(Item, Expected);
+	}
+	EXPECT_FALSE(Queue.Pop(&Item));
+}
+
+static constexpr int NUM_THREADED_ITEMS = 100000;
+
+static void ProduceItems(void *pUser)
+{
+	CSpscQueue<int, 64> *pQueue = static_cast<CSpscQueue<int, 64> *>(pUser);
+	for(int i = 0; i < NUM_THREADED_ITEMS; i++)
+	{
+		while(!pQueue->Push(i))
+			thread_yield();
+	}
+}
+
+TEST(SpscQueue, Threaded)
+{
+	CSpscQueue<int, 64> Queue;
+	void *pThread = thread_init(ProduceItems, &Queue, "spsc producer");
+
+	int Expected = 0;
+	while(Expected < NUM_THREADED_ITEMS)
+	{
+		int Item;
+		if(!Queue.Pop(&Item))
+		{
+			thread_yield();
+			continue;
+		}
+		ASSERT_EQ(Item, Expected);
+		Expected++;
+	}
+	thread_wait(pThread);
+}
@@ -1,14 +1,18 @@
 #include <gtest/gtest.h>
 
 #include <base/detect.h>
+#include <base/math.h>
 #include <engine/external/json-parser/json.h>
 #include <engine/server.h>
 #include <engine/shared/config.h>
 #include <game/gamecore.h>
 #include <game/server/teehistorian.h>
+#include <test/test.h>
 
 #include <vector>
 
+#include <zlib.h>
+
 void RegisterGameUuids(CUuidManager *pManager);
 
 class TeeHistorian : public ::testing::Test
@@ -138,6 +142,8 @@ protected:
 			::testing::UnitTest::GetInstance()->current_test_info();
 		const char *pTestName = pTestInfo->name();
 
+		m_TH.Flush();
+
 		if(m_vBuffer.size() != OutputSize || mem_comp(m_vBuffer.data(), pOutput, OutputSize) != 0)
 		{
 			char aFilename[IO_MAX_PATH_LENGTH];
@@ -904,3 +910,109 @@ TEST_F(TeeHistorian, PrevGameUuid)
 	EXPECT_STREQ(JsonPrevGameUuid, "fe19c218-f555-4002-a273-126c59ccc17a");
 	json_value_free(pJson);
 }
+
+static void RecordBusyTicks(CTeeHistorian *pTH, int NumTicks)
+{
+	for(int Tick = 1; Tick <= NumTicks; Tick++)
+	{
+		if(Tick > 1)
+		{
+			pTH->EndInputs();
+			pTH->EndTick();
+		}
+		pTH->BeginTick(Tick);
+		pTH->BeginPlayers();
+		for(int ClientId = 0; ClientId < 64; ClientId++)
+		{
+			CNetObj_CharacterCore Char;
+			mem_zero(&Char, sizeof(Char));
+			Char.m_X = ClientId * 32 + Tick;
+			Char.m_Y = 1000 - Tick * (ClientId % 3);
+			pTH->RecordPlayer(ClientId, &Char);
+		}
+		pTH->EndPlayers();
+		pTH->BeginInputs();
+		for(int ClientId = 0; ClientId < 64; ClientId++)
+		{
+			CNetObj_PlayerInput Input;
+			mem_zero(&Input, sizeof(Input));
+			Input.m_Direction = (Tick / 10 + ClientId) % 3 - 1;
+			Input.m_TargetX = Tick;
+			Input.m_TargetY = -ClientId;
+			Input.m_Jump = Tick % 7 == 0;
+			pTH->RecordPlayerInput(ClientId, ClientId + 1, &Input);
+		}
+	}
+	pTH->Finish();
+}
+
+static void WriteVector(const void *pData, int DataSize, void *pUser)
+{
+	std::vector<unsigned char> *pvBuffer = static_cast<std::vector<unsigned char> *>(pUser);
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	pvBuffer->insert(pvBuffer->end(), pBytes, pBytes + DataSize);
+}
+
+static std::vector<unsigned char> Decompress(const std::vector<unsigned char> &vCompressed, size_t MaxSize)
+{
+	std::vector<unsigned char> vDecompressed(MaxSize + 1);
+	z_stream Stream;
+	mem_zero(&Stream, sizeof(Stream));
+	EXPECT_EQ(inflateInit2(&Stream, 15 + 16), Z_OK);
+	Stream.next_in = (Bytef *)vCompressed.data();
+	Stream.avail_in = vCompressed.size();
+	Stream.next_out = vDecompressed.data();
+	Stream.avail_out = vDecompressed.size();
+	EXPECT_EQ(inflate(&Stream, Z_FINISH), Z_STREAM_END);
+	vDecompressed.resize(Stream.total_out);
+	inflateEnd(&Stream);
+	return vDecompressed;
+}
+
+TEST_F(TeeHistorian, CompressedRoundtrip)
+{
+	RecordBusyTicks(&m_TH, 200);
+
+	std::vector<unsigned char> vCompressed;
+	{
+		CTeeHistorianCompressor Compressor;
+		for(size_t Pos = 0; Pos < m_vBuffer.size(); Pos += 1000)
+			Compressor.Write(m_vBuffer.data() + Pos, minimum<size_t>(1000, m_vBuffer.size() - Pos), false, WriteVector, &vCompressed);
+		Compressor.Write(nullptr, 0, true, WriteVector, &vCompressed);
+	}
+	EXPECT_LT(vCompressed.size(), m_vBuffer.size());
+	EXPECT_EQ(Decompress(vCompressed, m_vBuffer.size()), m_vBuffer);
+}
+
+static void WriteAio(const void *pData, int DataSize, void *pUser)
+{
+	aio_write(static_cast<ASYNCIO *>(pUser), pData, DataSize);
+}
+
+TEST_F(TeeHistorian, CompressedFile)
+{
+	RecordBusyTicks(&m_TH, 200);
+
+	// the same setup as the server, compressed on the thread of the file writer
+	CTestInfo Info;
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	ASYNCIO *pAio = aio_new(File);
+	CTeeHistorianCompressor Compressor;
+	aio_set_filter(pAio, CTeeHistorianCompressor::AioFilter, &Compressor);
+	CTeeHistorian TH;
+	TH.Reset(&m_GameInfo, WriteAio, pAio);
+	RecordBusyTicks(&TH, 200);
+	aio_close(pAio);
+	aio_wait(pAio);
+	EXPECT_EQ(aio_error(pAio), 0);
+	aio_free(pAio);
+
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	std::vector<unsigned char> vCompressed(io_length(File));
+	ASSERT_EQ(io_read(File, vCompressed.data(), vCompressed.size()), vCompressed.size());
+	io_close(File);
+	EXPECT_EQ(Decompress(vCompressed, m_vBuffer.size()), m_vBuffer);
+	fs_remove(Info.m_aFilename);
+}
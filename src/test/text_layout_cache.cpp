@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <engine/client/text_layout_cache.h>
+
+static CTextLayoutCache::SKey MakeKey(const char *pText, float FontSize = 10.0f)
+{
+	return {pText, -1, FontSize, -1.0f, 0.0f, 0, 0, nullptr, 1.0f, 1.0f};
+}
+
+static CTextLayoutCache::SLayout MakeLayout(float Width)
+{
+	return {Width, 10.0f, 10.0f, 8.0f, 1};
+}
+
+TEST(TextLayoutCache, FindAdd)
+{
+	CTextLayoutCache Cache;
+	EXPECT_EQ(Cache.Find(MakeKey("abc")), nullptr);
+	Cache.Add(MakeKey("abc"), MakeLayout(30.0f));
+	Cache.Add(MakeKey("abc", 20.0f), MakeLayout(60.0f));
+	EXPECT_EQ(Cache.Size(), 2u);
+
+	const CTextLayoutCache::SLayout *pLayout = Cache.Find(MakeKey("abc"));
+	ASSERT_NE(pLayout, nullptr);
+	EXPECT_EQ(pLayout->m_LongestLineWidth, 30.0f);
+	pLayout = Cache.Find(MakeKey("abc", 20.0f));
+	ASSERT_NE(pLayout, nullptr);
+	EXPECT_EQ(pLayout->m_LongestLineWidth, 60.0f);
+
+	CTextLayoutCache::SKey Key = MakeKey("abc");
+	Key.m_Length = 2;
+	EXPECT_EQ(Cache.Find(Key), nullptr);
+	Key = MakeKey("abc");
+	Key.m_ScaleY = 2.0f;
+	EXPECT_EQ(Cache.Find(Key), nullptr);
+
+	EXPECT_EQ(Cache.Hits(), 2);
+	EXPECT_EQ(Cache.Misses(), 3);
+
+	Cache.Clear();
+	EXPECT_EQ(Cache.Size(), 0u);
+	EXPECT_EQ(Cache.Find(MakeKey("abc")), nullptr);
+}
+
+TEST(TextLayoutCache, EvictLeastRecentlyUsed)
+{
+	CTextLayoutCache Cache(2);
+	Cache.Add(MakeKey("a"), MakeLayout(1.0f));
+	Cache.Add(MakeKey("b"), MakeLayout(2.0f));
+	EXPECT_NE(Cache.Find(MakeKey("a")), nullptr);
+	Cache.Add(MakeKey("c"), MakeLayout(3.0f));
+	EXPECT_EQ(Cache.Size(), 2u);
+	EXPECT_EQ(Cache.Find(MakeKey("b")), nullptr);
+	EXPECT_NE(Cache.Find(MakeKey("a")), nullptr);
+	EXPECT_NE(Cache.Find(MakeKey("c")), nullptr);
+
+	// updating an entry does not evict another one
+	Cache.Add(MakeKey("a"), MakeLayout(4.0f));
+	EXPECT_EQ(Cache.Size(), 2u);
+	EXPECT_EQ(Cache.Find(MakeKey("a"))->m_LongestLineWidth, 4.0f);
+	EXPECT_NE(Cache.Find(MakeKey("c")), nullptr);
+}
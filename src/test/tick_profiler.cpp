@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <engine/external/json-parser/json.h>
+#include <engine/shared/jsonwriter.h>
+#include <engine/shared/tick_profiler.h>
+
+using namespace std::chrono_literals;
+
+TEST(TickProfiler, RegisterPhase)
+{
+	CTickProfiler Profiler;
+	int Network = Profiler.RegisterPhase("network");
+	int Game = Profiler.RegisterPhase("game");
+	EXPECT_NE(Network, Game);
+	EXPECT_EQ(Profiler.RegisterPhase("network"), Network);
+	EXPECT_EQ(Profiler.NumPhases(), 2);
+	EXPECT_STREQ(Profiler.PhaseName(Game), "game");
+}
+
+TEST(TickProfiler, Disabled)
+{
+	CTickProfiler Profiler;
+	int Phase = Profiler.RegisterPhase("game");
+	{
+		CTickProfiler::CScope Scope(&Profiler, Phase);
+	}
+	Profiler.EndTick();
+	EXPECT_EQ(Profiler.NumTicks(), 0);
+	EXPECT_EQ(Profiler.Stats(Phase).m_NumSamples, 0);
+}
+
+TEST(TickProfiler, Percentiles)
+{
+	CTickProfiler Profiler;
+	Profiler.SetEnabled(true);
+	int Phase = Profiler.RegisterPhase("game");
+	for(int i = 1; i <= 100; i++)
+	{
+		// summed up within a tick
+		Profiler.Add(Phase, std::chrono::microseconds(i) / 2);
+		Profiler.Add(Phase, std::chrono::microseconds(i) - std::chrono::microseconds(i) / 2);
+		Profiler.EndTick();
+	}
+	CTickProfiler::CStats Stats = Profiler.Stats(Phase);
+	EXPECT_EQ(Stats.m_NumSamples, 100);
+	EXPECT_EQ(Stats.m_P50, 50);
+	EXPECT_EQ(Stats.m_P99, 99);
+	EXPECT_EQ(Stats.m_Max, 100);
+
+	char aBuf[256];
+	Profiler.FormatStats(Phase, aBuf, sizeof(aBuf));
+	EXPECT_STREQ(aBuf, "phase=game samples=100 p50=50 p99=99 max=100");
+}
+
+TEST(TickProfiler, History)
+{
+	CTickProfiler Profiler;
+	Profiler.SetEnabled(true);
+	int Phase = Profiler.RegisterPhase("game");
+	for(int i = 0; i < CTickProfiler::HISTORY_SIZE; i++)
+	{
+		Profiler.Add(Phase, 1ms);
+		Profiler.EndTick();
+	}
+	// old ticks are dropped once the history is full
+	for(int i = 0; i < CTickProfiler::HISTORY_SIZE; i++)
+	{
+		Profiler.Add(Phase, 2ms);
+		Profiler.EndTick();
+	}
+	EXPECT_EQ(Profiler.NumTicks(), (int)CTickProfiler::HISTORY_SIZE);
+	EXPECT_EQ(Profiler.Stats(Phase).m_P50, 2000);
+
+	Profiler.SetEnabled(false);
+	EXPECT_EQ(Profiler.NumTicks(), 0);
+}
+
+TEST(TickProfiler, SkippedTicks)
+{
+	CTickProfiler Profiler;
+	Profiler.SetEnabled(true);
+	int Game = Profiler.RegisterPhase("game");
+	int Snap = Profiler.RegisterPhase("snap");
+	for(int i = 0; i < 100; i++)
+	{
+		Profiler.Add(Game, 1ms);
+		// like snapshots without sv_high_bandwidth, only every other tick
+		if(i % 2 == 0)
+			Profiler.Add(Snap, 3ms);
+		Profiler.EndTick();
+	}
+	EXPECT_EQ(Profiler.NumTicks(), 100);
+	EXPECT_EQ(Profiler.Stats(Game).m_NumSamples, 100);
+	EXPECT_EQ(Profiler.Stats(Game).m_P50, 1000);
+
+	CTickProfiler::CStats Stats = Profiler.Stats(Snap);
+	EXPECT_EQ(Stats.m_NumSamples, 50);
+	EXPECT_EQ(Stats.m_P50, 3000);
+	EXPECT_EQ(Stats.m_P99, 3000);
+	EXPECT_EQ(Stats.m_Max, 3000);
+
+	// a phase that never ran has no samples
+	int Unused = Profiler.RegisterPhase("unused");
+	Profiler.EndTick();
+	EXPECT_EQ(Profiler.Stats(Unused).m_NumSamples, 0);
+	EXPECT_EQ(Profiler.Stats(Unused).m_P50, 0);
+}
+
+TEST(TickProfiler, Trace)
+{
+	CTickProfiler Profiler;
+	Profiler.SetEnabled(true);
+	int Frame = Profiler.RegisterPhase("frame");
+	int Render = Profiler.RegisterPhase("render");
+
+	// not recorded without a trace
+	Profiler.Add(Render, 0ms, 1ms);
+	EXPECT_EQ(Profiler.NumTraceEvents(), 0);
+	EXPECT_FALSE(Profiler.TraceFinished());
+
+	Profiler.StartTrace(2);
+	for(int i = 0; i < 3; i++)
+	{
+		Profiler.Add(Render, std::chrono::milliseconds(10 * i + 1), 2ms);
+		Profiler.Add(Frame, std::chrono::milliseconds(10 * i), 5ms);
+		Profiler.EndTick();
+	}
+	EXPECT_TRUE(Profiler.TraceFinished());
+	EXPECT_EQ(Profiler.NumTraceEvents(), 4);
+	// the summed up times are collected as well
+	EXPECT_EQ(Profiler.Stats(Render).m_P50, 2000);
+
+	CJsonStringWriter Writer;
+	Profiler.WriteChromeTrace(&Writer);
+	json_value *pJson = json_parse(Writer.GetOutputString().c_str(), 100000);
+	ASSERT_TRUE(pJson);
+	const json_value &Events = (*pJson)["traceEvents"];
+	ASSERT_EQ(Events.type, json_array);
+	ASSERT_EQ(Events.u.array.length, 4u);
+	EXPECT_STREQ(Events[0]["name"].u.string.ptr, "render");
+	EXPECT_STREQ(Events[0]["ph"].u.string.ptr, "X");
+	EXPECT_EQ(Events[0]["ts"].u.integer, 1000);
+	EXPECT_EQ(Events[0]["dur"].u.integer, 2000);
+	EXPECT_STREQ(Events[3]["name"].u.string.ptr, "frame");
+	EXPECT_EQ(Events[3]["ts"].u.integer, 10000);
+	EXPECT_EQ(Events[3]["dur"].u.integer, 5000);
+	json_value_free(pJson);
+
+	Profiler.ClearTrace();
+	EXPECT_FALSE(Profiler.TraceFinished());
+	EXPECT_EQ(Profiler.NumTraceEvents(), 0);
+}